@@ -0,0 +1,223 @@
+/*
+ * binary_parser.cpp - binary framed motion commands
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2011 - 2019 Alden S. Hart, Jr.
+ * Copyright (c) 2016 - 2019 Rob Giseburt
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "binary_parser.h"
+#include "planner.h"
+#include "util.h"
+#include "xio.h"
+
+#ifdef __BINARY_MOTION
+
+/**** Local Structures ****/
+
+struct binaryReader {               // bounds-checked little-endian reader over a frame payload
+    const uint8_t *p;
+    const uint8_t *end;
+    bool overrun = false;
+
+    binaryReader(const uint8_t *start, const uint8_t length) : p{start}, end{start+length} {};
+
+    bool _have(const uint8_t n) {
+        if ((end - p) < n) {
+            overrun = true;
+            return (false);
+        }
+        return (true);
+    }
+
+    uint8_t get_u8() {
+        if (!_have(1)) { return (0); }
+        return (*p++);
+    }
+
+    uint16_t get_u16() {
+        if (!_have(2)) { return (0); }
+        uint16_t v = p[0] | (p[1] << 8);
+        p += 2;
+        return (v);
+    }
+
+    uint32_t get_u32() {
+        if (!_have(4)) { return (0); }
+        uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+        p += 4;
+        return (v);
+    }
+
+    float get_float() {
+        uint32_t bits = get_u32();
+        float v;
+        memcpy(&v, &bits, sizeof(float));
+        return (v);
+    }
+
+    bool isComplete() { return (!overrun && (p == end)); }
+};
+
+static stat_t _execute_binary_block(binaryReader &r);
+
+// plan values are velocities and lengths - finite and not negative ((v >= 0) is false for NaN)
+static bool _is_plan_value(const float v) { return ((v >= 0) && !isinf(v)); }
+
+/****************************************************************************************
+ * binary_parser() - validate and execute a binary motion frame
+ *
+ *  frame - points to the STX that starts the frame, as returned by xio_readline()
+ *  size  - size of the frame in bytes, as returned by xio_readline()
+ */
+
+stat_t binary_parser(const char *frame, const uint16_t size)
+{
+    const uint8_t *buf = (const uint8_t *)frame;
+
+    if ((size < BINARY_FRAME_OVERHEAD) || (buf[0] != STX)) {
+        return (STAT_INVALID_OR_MALFORMED_COMMAND);
+    }
+    uint8_t length = buf[1];
+    if (size != (length + BINARY_FRAME_OVERHEAD)) {
+        return (STAT_INVALID_OR_MALFORMED_COMMAND);
+    }
+
+    binaryReader crc_reader(&buf[2+length], BINARY_FRAME_CRC_LEN);
+    if (crc_reader.get_u32() != crc32(0, &buf[1], length+1)) {    // CRC covers LEN and the payload
+        return (STAT_CHECKSUM_MATCH_FAILED);
+    }
+
+    binaryReader r(&buf[2], length);
+    return (_execute_binary_block(r));
+}
+
+/****************************************************************************************
+ * _execute_binary_block() - decode the payload and run it through the canonical machine
+ *
+ *  The whole payload is decoded before anything is executed, so a malformed frame
+ *  never changes the model state. Frames are refused in alarm, shutdown or panic, as
+ *  Gcode blocks are. Binary frames carry only motion, so there is no M2/M30 to clear it.
+ */
+
+static stat_t _execute_binary_block(binaryReader &r)
+{
+    float target[AXES] = INIT_AXES_ZEROES;
+    bool target_f[AXES] = INIT_AXES_FALSE;
+    float offset[3] = {0,0,0};
+    bool offset_f[3] = {false, false, false};
+    float radius = 0;
+    uint32_t linenum = 0;
+    float feed_rate = 0;
+    mpStoredPlan_t plan;
+
+    uint8_t opcode = r.get_u8();
+    uint8_t flags = r.get_u8();
+    uint16_t axis_mask = r.get_u16();
+
+    if (opcode > BINARY_OP_G3) {
+        return (STAT_GCODE_COMMAND_UNSUPPORTED);
+    }
+    if (axis_mask >> AXES) {
+        return (STAT_AXIS_IS_INVALID);
+    }
+    if (flags & BINARY_HAS_LINENUM) {
+        linenum = r.get_u32();
+    }
+    if (flags & BINARY_HAS_FEED) {
+        feed_rate = r.get_float();
+    }
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
+        if (axis_mask & (1 << axis)) {
+            target[axis] = r.get_float();
+            target_f[axis] = true;
+        }
+    }
+    if (opcode >= BINARY_OP_G2) {
+        uint8_t offset_mask = r.get_u8();
+        for (uint8_t i=0; i<3; i++) {
+            if (offset_mask & (1 << i)) {
+                offset[i] = r.get_float();
+                offset_f[i] = true;
+            }
+        }
+        if (flags & BINARY_HAS_RADIUS) {
+            radius = r.get_float();
+        }
+    } else if (flags & BINARY_HAS_PLAN) {
+        plan.entry_velocity = r.get_float();
+        plan.exit_velocity = r.get_float();
+        plan.cruise_velocity = r.get_float();
+        plan.head_length = r.get_float();
+        plan.tail_length = r.get_float();
+    }
+    if (!r.isComplete()) {
+        return (STAT_INVALID_OR_MALFORMED_COMMAND);
+    }
+    if ((flags & BINARY_HAS_PLAN) &&
+        ((opcode >= BINARY_OP_G2) ||
+         !_is_plan_value(plan.entry_velocity) || !_is_plan_value(plan.exit_velocity) ||
+         !_is_plan_value(plan.cruise_velocity) ||
+         !_is_plan_value(plan.head_length) || !_is_plan_value(plan.tail_length))) {
+        return (STAT_INVALID_OR_MALFORMED_COMMAND);
+    }
+    ritorno(cm_is_alarmed());           // same as Gcode: no motion in alarm, shutdown or panic
+
+    // Same order of execution as the Gcode parser: line number, feed rate, then motion
+    if (flags & BINARY_HAS_LINENUM) {
+        cm_set_model_linenum(linenum);
+    }
+    if (flags & BINARY_HAS_FEED) {
+        ritorno(cm_set_feed_rate_mm(feed_rate));
+    }
+
+    stat_t status;
+    switch (opcode) {
+        case BINARY_OP_G0:
+        case BINARY_OP_G1: {
+            if (flags & BINARY_HAS_PLAN) {
+                mp_set_stored_plan(&plan);  // only for the line queued by this call
+            }
+            if (opcode == BINARY_OP_G0) {
+                status = cm_straight_traverse_mm(target, target_f, PROFILE_NORMAL);
+            } else {
+                status = cm_straight_feed_mm(target, target_f, PROFILE_NORMAL);
+            }
+            mp_set_stored_plan(nullptr);
+            return (status);
+        }
+        default: {
+            return (cm_arc_feed_mm(target, target_f,
+                                   offset, offset_f,
+                                   radius, (flags & BINARY_HAS_RADIUS),
+                                   0, false,                    // P word (turns) is not supported
+                                   true,                        // the frame always carries the motion mode
+                                   (opcode == BINARY_OP_G2) ? MOTION_MODE_CW_ARC : MOTION_MODE_CCW_ARC));
+        }
+    }
+}
+
+#endif // __BINARY_MOTION
@@ -0,0 +1,96 @@
+/*
+ * binary_parser.h - binary framed motion commands
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2011 - 2019 Alden S. Hart, Jr.
+ * Copyright (c) 2016 - 2019 Rob Giseburt
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Binary motion frames carry pre-parsed G0/G1/G2/G3 blocks on the same xio data
+ * channel as ASCII Gcode and JSON. They skip the Gcode normalizer, the number parsing
+ * and the word-by-word parser, and go straight to the canonical machine _mm functions.
+ *
+ * A frame starts with STX (0x02) at the start of a line. The xio line scanner treats
+ * everything up to the end of the CRC as opaque, so payload bytes may take any value.
+ * Frames are queued in order with the surrounding text lines, and the single-character
+ * controls (!, ~, %, ^D, ^X) and JSON control lines keep working between frames.
+ *
+ *    STX | LEN | PAYLOAD[LEN] | CRC32
+ *
+ *    LEN     uint8_t   payload length in bytes
+ *    CRC32   uint32_t  crc32() of LEN and PAYLOAD (see util.cpp)
+ *
+ * Payload - all multi-byte values are little-endian, floats are IEEE-754 float32:
+ *
+ *    uint8_t   opcode          BINARY_OP_G0, G1, G2 or G3
+ *    uint8_t   flags           BINARY_HAS_xxxx bits, below
+ *    uint16_t  axis_mask       bit N set if the target for axis N (AXIS_X = bit 0) follows
+ *    uint32_t  linenum         if BINARY_HAS_LINENUM
+ *    float     feed_rate       if BINARY_HAS_FEED - mm/min, or minutes in G93 inverse time
+ *    float     target[]        one per axis_mask bit, in axis order
+ *    uint8_t   offset_mask     G2/G3 only - bit 0 = I, bit 1 = J, bit 2 = K
+ *    float     offset[]        G2/G3 only - one per offset_mask bit
+ *    float     radius          G2/G3 only, if BINARY_HAS_RADIUS
+ *    float     plan[5]         G0/G1 only, if BINARY_HAS_PLAN - mpStoredPlan_t: entry, exit
+ *                              and cruise velocities in mm/min, head and tail lengths in mm
+ *
+ * Targets and offsets are in mm (degrees for rotary axes) and are applied using the
+ * current modal state - distance mode, coordinate system, plane, feed rate mode - just
+ * like the equivalent Gcode block. Each frame gets the same JSON response as a Gcode
+ * line, so existing line-counting flow control works unchanged.
+ *
+ * The plan is written by the SD job compiler (see sd_job.h) and is handed to the planner
+ * with the line (see mp_set_stored_plan()). It only ever lowers what the live planner would
+ * do, so a host may leave it out.
+ */
+
+#ifndef _BINARY_PARSER_H_ONCE
+#define _BINARY_PARSER_H_ONCE
+
+#ifdef __BINARY_MOTION
+
+/**** Configs, Definitions and Structures ****/
+
+#define BINARY_FRAME_CRC_LEN 4      // CRC32 trailer
+#define BINARY_FRAME_OVERHEAD (2 + BINARY_FRAME_CRC_LEN)    // STX, LEN and CRC
+
+typedef enum {                      // binary frame opcodes
+    BINARY_OP_G0 = 0,               // straight traverse
+    BINARY_OP_G1,                   // straight feed
+    BINARY_OP_G2,                   // clockwise arc
+    BINARY_OP_G3                    // counter-clockwise arc
+} binaryOpcode;
+
+#define BINARY_HAS_LINENUM  0x01    // flags
+#define BINARY_HAS_FEED     0x02
+#define BINARY_HAS_RADIUS   0x04
+#define BINARY_HAS_PLAN     0x08
+#define BINARY_PLAN_LEN     (5*4)   // bytes in the plan fields
+
+/**** Function Prototypes ****/
+
+stat_t binary_parser(const char *frame, const uint16_t size);
+
+#endif // __BINARY_MOTION
+
+#endif // _BINARY_PARSER_H_ONCE
@@ -39,6 +39,7 @@
 #include "MotatePower.h"
 #include "board_spi.h"
 #include "sd_persistence.h"
+#include "sd_job.h"
 
 #include "board_gpio.h"
 
@@ -115,6 +116,7 @@ void hardware_init()
 stat_t hardware_periodic()
 {
     sd_card.periodicCheck();
+    sd_job_periodic();
     return STAT_OK;
 }
 
@@ -47,6 +47,7 @@
 #define MOTORS 4                    // number of motors supported the hardware
 #define PWMS 2                      // number of PWM channels supported the hardware
 #define AXES 6                      // axes to support -- must be 6 or 9
+#define HAS_SD_JOBS 1               // compiled Gcode jobs can be run from the SD card
 
 /*************************
  * Global System Defines *
@@ -155,6 +155,7 @@ using Motate::OutputPin;
 #define MIN_SEGMENT_MS ((float)0.5)       // S70 can handle much much smaller segements
 
 // #define PLANNER_QUEUE_SIZE (60)
+// #define PLANNER_QUEUE_MEMORY (64*1024)  // ...or size the queue from a RAM budget in bytes (may exceed 255 buffers)
 
 /**** Motate Definitions ****/
 
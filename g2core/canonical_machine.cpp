@@ -119,6 +119,7 @@
 cmMachine_t *cm;            // pointer to active canonical machine
 cmMachine_t cm1;            // canonical machine primary machine
 cmMachine_t cm2;            // canonical machine secondary machine
+cmConfig_t cm_config;       // machine configuration shared by both machines
 cmToolTable_t tt;           // global tool table
 
 /****************************************************************************************
@@ -236,8 +237,11 @@ gpioDigitalInputHandler _reset_input_handler {
 
 void canonical_machine_inits()
 {
-    planner_init(&mp1, &mr1, mp1_queue, PLANNER_QUEUE_SIZE);
-    planner_init(&mp2, &mr2, mp2_queue, SECONDARY_QUEUE_SIZE);
+    planner_init(&mp1, &mr1, mp1_queue, mp1_arc_pool, PLANNER_QUEUE_SIZE, mp1_gm_pool, PLANNER_GM_POOL_SIZE);
+    planner_init(&mp2, &mr2, mp2_queue, mp2_arc_pool, SECONDARY_QUEUE_SIZE, mp2_gm_pool, SECONDARY_GM_POOL_SIZE);
+#ifdef __PLANNER_PROFILING
+    mp_profile_init();                  // once - profiling counts across both planners
+#endif
     canonical_machine_init(&cm1, &mp1); // primary canonical machine
     canonical_machine_init(&cm2, &mp2); // secondary canonical machine
     cm = &cm1;                          // set global canonical machine pointer to primary machine
@@ -258,6 +262,7 @@ void canonical_machine_init(cmMachine_t *_cm, void *_mp)
     // If you can assume all memory has been zeroed by a hard reset you don't need this code:
     memset(_cm, 0, sizeof(cmMachine_t));            // do not reset canonicalMachine once it's been initialized
     memset(&_cm->gm, 0, sizeof(GCodeState_t));      // clear all values, pointers and status
+    _cm->config = &cm_config;                       // both machines run on the same configuration
 
     canonical_machine_init_assertions(_cm);         // establish assertions
     cm_arc_init(_cm);                               // setup arcs. Note: spindle and coolant inits are independent
@@ -272,11 +277,11 @@ void canonical_machine_reset(cmMachine_t *_cm)
     canonical_machine_init_assertions(_cm);
 
     // set canonical machine gcode defaults
-    cm_set_units_mode(cm->default_units_mode);
-    cm_set_coord_system(cm->default_coord_system);   // NB: queues a block to the planner with the coordinates
-    cm_select_plane(cm->default_select_plane);
-    cm_set_path_control(MODEL, cm->default_path_control);
-    cm_set_distance_mode(cm->default_distance_mode);
+    cm_set_units_mode(cm->config->default_units_mode);
+    cm_set_coord_system(cm->config->default_coord_system);   // NB: queues a block to the planner with the coordinates
+    cm_select_plane(cm->config->default_select_plane);
+    cm_set_path_control(MODEL, cm->config->default_path_control, 0);
+    cm_set_distance_mode(cm->config->default_distance_mode);
     cm_set_arc_distance_mode(INCREMENTAL_DISTANCE_MODE); // always the default
     cm_set_feed_rate_mode(UNITS_PER_MINUTE_MODE);   // always the default
     cm_reset_overrides();                           // set overrides to initial conditions
@@ -353,6 +358,7 @@ void cm_set_motion_state(const cmMotionState motion_state)
 {
     cm->motion_state = motion_state;
     ACTIVE_MODEL = ((motion_state == MOTION_STOP) ? MODEL : RUNTIME);
+    sr_flag_change(SR_CHANGED_MODEL | SR_CHANGED_RUNTIME);  // reports switch models, vel drops to zero
 }
 
 /*
@@ -442,11 +448,13 @@ float cm_get_feed_rate(const GCodeState_t *gcode_state) { return gcode_state->fe
 void cm_set_motion_mode(GCodeState_t *gcode_state, const uint8_t motion_mode)
 {
     gcode_state->motion_mode = (cmMotionMode)motion_mode;
+    sr_flag_change(SR_CHANGED_MODEL);
 }
 
 void cm_set_tool_number(GCodeState_t *gcode_state, const uint8_t tool)
 {
     gcode_state->tool = tool;
+    sr_flag_change(SR_CHANGED_MODEL);
 }
 
 void cm_set_absolute_override(GCodeState_t *gcode_state, const uint8_t absolute_override)
@@ -462,6 +470,7 @@ void cm_set_model_linenum(int32_t linenum)
         rpt_exception(STAT_INPUT_VALUE_RANGE_ERROR, "line number > 2B or negative; set to zero");
     }
     cm->gm.linenum = linenum;           // you must first set the model line number,
+    sr_flag_change(SR_CHANGED_MODEL);
     nv_add_object((const char *)"n");   // then add the line number to the nv list
 }
 
@@ -509,7 +518,7 @@ stat_t cm_check_linenum() {
  *    - Probing also has a very short move that behaves this way
  *
  * The offsets themselves are "the truth". These are:
- *    - cm.coord_offset[coord][axis]  coordinate offsets for G53-G59, by axis - persistent
+ *    - cm_config.coord_offset[coord][axis]  coordinate offsets for G53-G59, by axis - persistent
  *    - cm.tool_offset[axis]          offsets for currently selected and active tool - persistent
  *    - cm.gmx.g92_offset[axis]       G92 origin offset. Not persistent
  *
@@ -541,7 +550,7 @@ float cm_get_combined_offset(const uint8_t axis)
     if (cm->gm.absolute_override >= ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS) {
         return (0);
     }
-    float offset = cm->coord_offset[cm->gm.coord_system][axis] + cm->tool_offset[axis];
+    float offset = cm->config->coord_offset[cm->gm.coord_system][axis] + cm->tool_offset[axis];
     if (cm->gmx.g92_offset_enable == true) {
         offset += cm->gmx.g92_offset[axis];
     }
@@ -564,13 +573,14 @@ void cm_set_display_offsets(GCodeState_t *gcode_state)
 
         // all other cases: position should be displayed with currently active offsets
         else {
-            gcode_state->display_offset[axis] = cm->coord_offset[cm->gm.coord_system][axis] +
+            gcode_state->display_offset[axis] = cm->config->coord_offset[cm->gm.coord_system][axis] +
                                                 cm->tool_offset[axis];
             if (cm->gmx.g92_offset_enable == true) {
                 gcode_state->display_offset[axis] += cm->gmx.g92_offset[axis];
             }
         }
     }
+    sr_flag_change(SR_CHANGED_MODEL);       // offsets, G92 enable, coordinate system or override changed
 
     // If we're not in cycle, then no moves are queued to update the runtime offsets
     // So let's do that
@@ -595,7 +605,7 @@ float cm_get_display_position(const GCodeState_t *gcode_state, const uint8_t axi
         position = mp_get_runtime_display_position(axis);
     }
 ////##A looking for special ABC flag for linears
-    if ((axis <= AXIS_Z) || (cm->a[axis].axis_mode == AXIS_INHIBITED)) {   // linears
+    if ((axis <= AXIS_Z) || (cm->config->a[axis].axis_mode == AXIS_INHIBITED)) {   // linears
         if (gcode_state->units_mode == INCHES) {
             position /= MM_PER_INCH;
         }
@@ -637,6 +647,7 @@ float cm_get_absolute_position(const GCodeState_t *gcode_state, const uint8_t ax
 void cm_update_model_position()
 {
     copy_vector(cm->gmx.position, cm->gm.target);   // would be mr->gm.target if from runtime
+    sr_flag_change(SR_CHANGED_MODEL);
 }
 
 /****************************************************************************************
@@ -659,7 +670,7 @@ stat_t cm_deferred_write_callback()
                 sprintf((char *)nv.token, "g%2d%c", 53+i, ("xyzabc")[j]);
 #endif
                 nv.index = nv_get_index((const char *)"", nv.token);
-                nv.value_flt = cm->coord_offset[i][j];
+                nv.value_flt = cm->config->coord_offset[i][j];
                 nv_persist(&nv);    // Note: nv_persist() only writes values that have changed
             }
         }
@@ -832,11 +843,11 @@ stat_t cm_get_nxln(nvObj_t *nv)
 
 static float _calc_ABC(const uint8_t axis, const float target[])
 {
-    if (cm->a[axis].axis_mode == AXIS_STANDARD) { ////##A we've already processed "INHIBITED"~LINEAR below
+    if (cm->config->a[axis].axis_mode == AXIS_STANDARD) { ////##A we've already processed "INHIBITED"~LINEAR below
         return(target[axis]);    // no mm conversion - it's in degrees
     }
     // radius mode
-    return ((target[axis]) * 360.0 / (2 * M_PI * cm->a[axis].radius));
+    return ((target[axis]) * 360.0 / (2 * M_PI * cm->config->a[axis].radius));
 }
 
 void cm_set_model_target(const float target[], const bool flags[])
@@ -849,9 +860,9 @@ void cm_set_model_target(const float target[], const bool flags[])
 
     // process regular linear axes (XYZ) first
     for (axis = AXIS_X; axis <= LAST_LINEAR_AXIS; axis++) {
-        if (!flags[axis] || cm->a[axis].axis_mode == AXIS_DISABLED) {
+        if (!flags[axis] || cm->config->a[axis].axis_mode == AXIS_DISABLED) {
             continue;        // skip axis if not flagged for update or its disabled
-        } else if (cm->a[axis].axis_mode == AXIS_STANDARD) {
+        } else if (cm->config->a[axis].axis_mode == AXIS_STANDARD) {
             if (cm->gm.distance_mode == ABSOLUTE_DISTANCE_MODE) {
                 cm->gm.target[axis] = cm_get_combined_offset(axis) + target[axis];
             } else {
@@ -863,9 +874,9 @@ void cm_set_model_target(const float target[], const bool flags[])
 
     // then process for ABC loop the special casesst
     for (axis = AXIS_A; axis <= AXIS_C; axis++) {
-        if (!flags[axis] || cm->a[axis].axis_mode == AXIS_DISABLED) {
+        if (!flags[axis] || cm->config->a[axis].axis_mode == AXIS_DISABLED) {
             continue;        // skip axis if not flagged for update or its disabled
-        } else if (cm->a[axis].axis_mode == AXIS_INHIBITED) {    ////##A special case axis_inhibited = flag means linear in ABC
+        } else if (cm->config->a[axis].axis_mode == AXIS_INHIBITED) {    ////##A special case axis_inhibited = flag means linear in ABC
             if (cm->gm.distance_mode == ABSOLUTE_DISTANCE_MODE) {
                 cm->gm.target[axis] = cm_get_combined_offset(axis) + target[axis];
             } else {
@@ -879,7 +890,7 @@ void cm_set_model_target(const float target[], const bool flags[])
 #if MARLIN_COMPAT_ENABLED == true
         // If we are in absolute mode (generally), but the extruder is relative,
         // then we adjust the extruder to a relative position
-        if (mst.marlin_flavor && (cm->a[axis].axis_mode == AXIS_RADIUS)) {
+        if (mst.marlin_flavor && (cm->config->a[axis].axis_mode == AXIS_RADIUS)) {
             if ((cm->gm.distance_mode == INCREMENTAL_DISTANCE_MODE) || (mst.extruder_mode == EXTRUDER_MOVES_RELATIVE)) {
                 cm->gm.target[axis] += tmp;
             }
@@ -918,29 +929,30 @@ void cm_set_model_target(const float target[], const bool flags[])
  *  This allows a single end to be tested w/the other disabled, should that requirement ever arise.
  */
 
-bool cm_get_soft_limits() { return (cm->soft_limit_enable); }
-void cm_set_soft_limits(bool enable) { cm->soft_limit_enable = enable; }
+bool cm_get_soft_limits() { return (cm->config->soft_limit_enable); }
+void cm_set_soft_limits(bool enable) { cm->config->soft_limit_enable = enable; }
 
 static stat_t _finalize_soft_limits(const stat_t status)
 {
     cm->gm.motion_mode = MOTION_MODE_CANCEL_MOTION_MODE;    // cancel motion
     copy_vector(cm->gm.target, cm->gmx.position);           // reset model target
+    sr_flag_change(SR_CHANGED_MODEL);
     return (cm_alarm(status, "soft_limits"));               // throw an alarm
 }
 
 stat_t cm_test_soft_limits(const float target[])
 {
-    if (cm->soft_limit_enable == true) {
+    if (cm->config->soft_limit_enable == true) {
         for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
             if (cm->homed[axis] != true) { continue; }                               // skip axis if not homed
-            if (fp_EQ(cm->a[axis].travel_min, cm->a[axis].travel_max)) { continue; } // skip axis if identical
-            if (fabs(cm->a[axis].travel_min) > DISABLE_SOFT_LIMIT) { continue; }     // skip min test if disabled
-            if (fabs(cm->a[axis].travel_max) > DISABLE_SOFT_LIMIT) { continue; }     // skip max test if disabled
+            if (fp_EQ(cm->config->a[axis].travel_min, cm->config->a[axis].travel_max)) { continue; } // skip axis if identical
+            if (fabs(cm->config->a[axis].travel_min) > DISABLE_SOFT_LIMIT) { continue; }     // skip min test if disabled
+            if (fabs(cm->config->a[axis].travel_max) > DISABLE_SOFT_LIMIT) { continue; }     // skip max test if disabled
 
-            if (target[axis] < cm->a[axis].travel_min) {
+            if (target[axis] < cm->config->a[axis].travel_min) {
                 return (_finalize_soft_limits(STAT_SOFT_LIMIT_EXCEEDED_XMIN + 2*axis));
             }
-            if (target[axis] > cm->a[axis].travel_max) {
+            if (target[axis] > cm->config->a[axis].travel_max) {
                 return (_finalize_soft_limits(STAT_SOFT_LIMIT_EXCEEDED_XMAX + 2*axis));
             }
         }
@@ -973,12 +985,14 @@ stat_t cm_test_soft_limits(const float target[])
 stat_t cm_select_plane(const uint8_t plane)
 {
     cm->gm.select_plane = (cmCanonicalPlane)plane;
+    sr_flag_change(SR_CHANGED_MODEL);
     return (STAT_OK);
 }
 
 stat_t cm_set_units_mode(const uint8_t mode)
 {
     cm->gm.units_mode = (cmUnitsMode)mode;               // 0 = inches, 1 = mm.
+    sr_flag_change(SR_CHANGED_MODEL);
     sr_request_status_report(SR_REQUEST_IMMEDIATE);      // Sends a SR when the units change
     return(STAT_OK);
 }
@@ -986,12 +1000,14 @@ stat_t cm_set_units_mode(const uint8_t mode)
 stat_t cm_set_distance_mode(const uint8_t mode)
 {
     cm->gm.distance_mode = (cmDistanceMode)mode;         // 0 = absolute mode, 1 = incremental
+    sr_flag_change(SR_CHANGED_MODEL);
     return (STAT_OK);
 }
 
 stat_t cm_set_arc_distance_mode(const uint8_t mode)
 {
     cm->gm.arc_distance_mode = (cmDistanceMode)mode;     // 0 = absolute mode, 1 = incremental
+    sr_flag_change(SR_CHANGED_MODEL);
     return (STAT_OK);
 }
 
@@ -1020,10 +1036,10 @@ stat_t cm_set_g10_data(const uint8_t P_word, const bool P_flag,
         for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
             if (flag[axis]) {
                 if (L_word == 2) {
-                    cm->coord_offset[P_word][axis] = _to_millimeters(offset[axis]);
+                    cm->config->coord_offset[P_word][axis] = _to_millimeters(offset[axis]);
                 } else {
                     // Should L20 take into account G92 offsets?
-                    cm->coord_offset[P_word][axis] = cm->gmx.position[axis] -
+                    cm->config->coord_offset[P_word][axis] = cm->gmx.position[axis] -
                         _to_millimeters(offset[axis]) -
                         cm->tool_offset[axis];
                 }
@@ -1042,7 +1058,7 @@ stat_t cm_set_g10_data(const uint8_t P_word, const bool P_flag,
                 } else {                                // L10 should also take into account G92 offset
                     tt.tt_offset[P_word][axis] =
                         cm->gmx.position[axis] - _to_millimeters(offset[axis]) -
-                        cm->coord_offset[cm->gm.coord_system][axis] -
+                        cm->config->coord_offset[cm->gm.coord_system][axis] -
                         (cm->gmx.g92_offset[axis] * cm->gmx.g92_offset_enable);
                 }
                 cm->deferred_write_flag = true;         // persist offsets once machining cycle is over
@@ -1134,6 +1150,7 @@ void cm_set_position_by_axis(const uint8_t axis, const float position)
 {
     cm->gmx.position[axis] = position;
     cm->gm.target[axis] = position;
+    sr_flag_change(SR_CHANGED_MODEL);
     mp_set_planner_position(axis, position);
     mp_set_runtime_position(axis, position);
     mp_set_steps_to_runtime_position();
@@ -1184,6 +1201,7 @@ stat_t cm_set_absolute_origin(const float origin[], bool flag[])
             mp_set_planner_position(axis, value[axis]);     // set mm position
         }
     }
+    sr_flag_change(SR_CHANGED_MODEL);
     mp_queue_command(_exec_absolute_origin, value, flag);
     return (STAT_OK);
 }
@@ -1205,7 +1223,7 @@ stat_t cm_set_g92_offsets(const float offset[], const bool flag[])
     for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
         if (flag[axis]) {
             cm->gmx.g92_offset[axis] = cm->gmx.position[axis] -
-                                       cm->coord_offset[cm->gm.coord_system][axis] -
+                                       cm->config->coord_offset[cm->gm.coord_system][axis] -
                                        cm->tool_offset[axis] -
                                        _to_millimeters(offset[axis]);
         }
@@ -1252,9 +1270,9 @@ stat_t cm_resume_g92_offsets()
 void cm_axes_to_mm(const float *target_global, float *target_mm, const bool *flags) // Assumes both target arrays are the same size
 {
     for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
-        if (!flags[axis] || cm->a[axis].axis_mode == AXIS_DISABLED) {
+        if (!flags[axis] || cm->config->a[axis].axis_mode == AXIS_DISABLED) {
             continue;                                                   // skip axis if not flagged for update or its disabled
-        } else if ((axis > AXIS_Z) && (cm->a[axis].axis_mode == AXIS_STANDARD)) { ////##A
+        } else if ((axis > AXIS_Z) && (cm->config->a[axis].axis_mode == AXIS_STANDARD)) { ////##A
             target_mm[axis] = target_global[axis];                      // pass through rotary axes (no unit conversion required)
         } else {
             target_mm[axis] = _to_millimeters(target_global[axis]);     // convert linear axes
@@ -1279,6 +1297,7 @@ stat_t cm_straight_traverse_mm(const float *target, const bool *flags, const cmM
 #else
     cm->gm.motion_profile = motion_profile;
 #endif
+    sr_flag_change(SR_CHANGED_MODEL);     // momo changes even if there are no axis words
 
     // it's legal for a G0 to have no axis words but we don't want to process it
     if (!(flags[AXIS_X] | flags[AXIS_Y] | flags[AXIS_Z] |
@@ -1425,6 +1444,7 @@ stat_t cm_set_feed_rate_mm(const float feed_rate)
     } else {
         cm->gm.feed_rate = feed_rate;
     }
+    sr_flag_change(SR_CHANGED_MODEL);
     return (STAT_OK);
 }
 
@@ -1439,16 +1459,25 @@ stat_t cm_set_feed_rate_mm(const float feed_rate)
 stat_t cm_set_feed_rate_mode(const uint8_t mode)
 {
     cm->gm.feed_rate_mode = (cmFeedRateMode)mode;
+    sr_flag_change(SR_CHANGED_MODEL);
     return (STAT_OK);
 }
 
 /****************************************************************************************
  * cm_set_path_control() - G61, G61.1, G64
+ *
+ *  tolerance is the G64 P value in mm - corners may be rounded by up to this much
+ *  (see _plan_blend() in plan_line.cpp). Zero turns blending off.
  */
 
-stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode)
+stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode, const float tolerance)
 {
+    if (tolerance < 0) {
+        return (STAT_INPUT_LESS_THAN_MIN_VALUE);
+    }
     gcode_state->path_control = (cmPathControl)mode;
+    gcode_state->path_tolerance = (mode == PATH_CONTINUOUS) ? tolerance : 0;
+    sr_flag_change(SR_CHANGED_MODEL);
     return (STAT_OK);
 }
 
@@ -1491,6 +1520,7 @@ stat_t cm_straight_feed_mm(const float *target, const bool *flags, const cmMotio
     }
     cm->gm.motion_mode = MOTION_MODE_STRAIGHT_FEED;
     cm->gm.motion_profile = motion_profile;
+    sr_flag_change(SR_CHANGED_MODEL);     // momo changes even if there are no axis words
 
     // it's legal for a G0 to have no axis words but we don't want to process it
     if (!(flags[AXIS_X] | flags[AXIS_Y] | flags[AXIS_Z] |
@@ -1539,6 +1569,7 @@ stat_t cm_straight_feed_mm(const float *target, const bool *flags, const cmMotio
 static void _exec_select_tool(float *value, bool *flag)
 {
     cm->gm.tool_select = (uint8_t)value[0];
+    sr_flag_change(SR_CHANGED_MODEL);
 }
 
 stat_t cm_select_tool(const uint8_t tool_select)
@@ -1554,6 +1585,7 @@ stat_t cm_select_tool(const uint8_t tool_select)
 static void _exec_change_tool(float *value, bool *flag)
 {
     cm->gm.tool = cm->gm.tool_select;
+    sr_flag_change(SR_CHANGED_MODEL);
 
     spindle_set_toolhead(toolhead_for_tool(cm->gm.tool));
     // TODO - change tool offsets and update display offsets
@@ -1689,7 +1721,7 @@ stat_t cm_fro_control(const float P_word, const bool P_flag) // M50
     }
     if (cm->gmx.m48_enable) {               // if master enable is ON
         if (new_enable && (new_override || !cm->gmx.mfo_enable)) {   // 3 cases to start a ramp
-            mp_start_feed_override(FEED_OVERRIDE_RAMP_TIME, cm->gmx.mfo_factor);
+            mp_start_feed_override(FEED_OVERRIDE_RAMP_TIME);
         } else if (cm->gmx.mfo_enable && !new_enable) {              // case to turn off the ramp
             mp_end_feed_override(FEED_OVERRIDE_RAMP_TIME);
         }
@@ -1808,14 +1840,14 @@ static void _exec_program_stop_end(cmMachineState machine_state)
     cm->hold_state = FEEDHOLD_OFF;
     // mp_zero_segment_velocity();                              //  for reporting purposes
 
-    bool flag = false;                                       //  M0/M2/M30 flag
+    bool flag[] = INIT_AXES_FALSE;                           //  M0/M2/M30 flag in flag[0] - mp_queue_command() copies AXES flags
     // perform the following resets if it's a program END
     if (machine_state == MACHINE_PROGRAM_END) {
-        flag = true;                                         //  M2/M30
+        flag[0] = true;                                      //  M2/M30
         cm_suspend_g92_offsets();                            //  G92.2 - as per NIST
-        cm_set_coord_system(cm->default_coord_system);       //  reset to default coordinate system
-        cm_select_plane(cm->default_select_plane);           //  reset to default arc plane
-        cm_set_distance_mode(cm->default_distance_mode);     //  reset to default distance mode
+        cm_set_coord_system(cm->config->default_coord_system);       //  reset to default coordinate system
+        cm_select_plane(cm->config->default_select_plane);           //  reset to default arc plane
+        cm_set_distance_mode(cm->config->default_distance_mode);     //  reset to default distance mode
         cm_set_arc_distance_mode(INCREMENTAL_DISTANCE_MODE); //  always the default
         cm_set_feed_rate_mode(UNITS_PER_MINUTE_MODE);        //  G94
         cm_set_motion_mode(MODEL, MOTION_MODE_CANCEL_MOTION_MODE); // NIST specifies G1 (MOTION_MODE_STRAIGHT_FEED), but we cancel motion mode. Safer.
@@ -1824,7 +1856,7 @@ static void _exec_program_stop_end(cmMachineState machine_state)
     }
     cm_set_motion_state(MOTION_STOP);                       // also changes active model back to MODEL
 
-    mp_queue_command(_exec_program_finalize, nullptr, &flag);
+    mp_queue_command(_exec_program_finalize, nullptr, flag);
 }
 
 // Will start a cycle regardless of whether the planner has moves or not
@@ -1834,6 +1866,7 @@ void cm_cycle_start()
         cm->cycle_type = CYCLE_MACHINING;
         cm->machine_state = MACHINE_CYCLE;
         qr_init_queue_report();                             // clear queue reporting buffer counts//
+        qs_init_starvation_report();                        // clear planner starvation counters
     }
 }
 
@@ -1876,9 +1909,9 @@ stat_t cm_is_in_program_end_state() {
        && fp_EQ(cm->gmx.mfo_factor, BASE_STATE_MFO_FACTOR) && fp_EQ(cm->gmx.mto_factor, BASE_STATE_MTO_FACTOR)
        && cm->gmx.mto_enable == true ))                                                                        { return 0; }
     if (!(cm->gmx.g92_offset_enable == false))                                                                 { return 0; }
-    if (!(cm->gm.coord_system == cm->default_coord_system))                                                    { return 0; }
-    if (!(cm->gm.select_plane == cm->default_select_plane))                                                    { return 0; }
-    if (!(cm->gm.distance_mode == cm->default_distance_mode))                                                  { return 0; }
+    if (!(cm->gm.coord_system == cm->config->default_coord_system))                                                    { return 0; }
+    if (!(cm->gm.select_plane == cm->config->default_select_plane))                                                    { return 0; }
+    if (!(cm->gm.distance_mode == cm->config->default_distance_mode))                                                  { return 0; }
     if (!(cm->gm.arc_distance_mode == INCREMENTAL_DISTANCE_MODE))                                              { return 0; }
     if (!(cm->gm.feed_rate_mode == UNITS_PER_MINUTE_MODE))                                                     { return 0; }
     if (!(cm->gm.motion_mode == MOTION_MODE_CANCEL_MOTION_MODE))                                               { return 0; }
@@ -2035,7 +2068,7 @@ cmAxisMode cm_get_axis_mode(const nvObj_t *nv)
     if (axis <= AXIS_DISABLED) {
         return ((cmAxisMode)axis);
     }
-    return ((cmAxisMode)cm->a[axis].axis_mode);
+    return ((cmAxisMode)cm->config->a[axis].axis_mode);
 }
 
 cmAxisType cm_get_axis_type(const nvObj_t *nv)
@@ -2044,7 +2077,7 @@ cmAxisType cm_get_axis_type(const nvObj_t *nv)
     if (axis <= AXIS_TYPE_UNDEFINED) {
         return ((cmAxisType)axis);
     }
-    if ((axis >= AXIS_A) && (cm->a[axis].axis_mode != AXIS_INHIBITED)) {
+    if ((axis >= AXIS_A) && (cm->config->a[axis].axis_mode != AXIS_INHIBITED)) {
         return (AXIS_TYPE_ROTARY);
     }
     return (AXIS_TYPE_LINEAR);
@@ -2303,8 +2336,8 @@ stat_t cm_get_prb(nvObj_t *nv)  { return (get_float(nv, cm->probe_results[0][_ax
 stat_t cm_get_probe_input(nvObj_t *nv) { return (get_integer(nv, cm->probe_input)); }
 stat_t cm_set_probe_input(nvObj_t *nv) { return (set_integer(nv, cm->probe_input, 0, D_IN_CHANNELS)); }
 
-stat_t cm_get_coord(nvObj_t *nv) { return (get_float(nv, cm->coord_offset[_coord(nv)][_axis(nv)])); }
-stat_t cm_set_coord(nvObj_t *nv) { return (set_float(nv, cm->coord_offset[_coord(nv)][_axis(nv)])); }
+stat_t cm_get_coord(nvObj_t *nv) { return (get_float(nv, cm->config->coord_offset[_coord(nv)][_axis(nv)])); }
+stat_t cm_set_coord(nvObj_t *nv) { return (set_float(nv, cm->config->coord_offset[_coord(nv)][_axis(nv)])); }
 
 stat_t cm_get_g92e(nvObj_t *nv)  { return (get_integer(nv, cm->gmx.g92_offset_enable)); }
 stat_t cm_get_g92(nvObj_t *nv)   { return (get_float(nv, cm->gmx.g92_offset[_axis(nv)])); }
@@ -2359,7 +2392,7 @@ stat_t cm_set_tt(nvObj_t *nv)
 stat_t cm_get_am(nvObj_t *nv)
 {
     int8_t axis = _axis(nv);
-    nv->value_int = cm->a[axis].axis_mode;
+    nv->value_int = cm->config->a[axis].axis_mode;
     return(_get_msg_helper(nv, msg_am, nv->value_int));
 }
 
@@ -2377,22 +2410,22 @@ stat_t cm_set_am(nvObj_t *nv)        // axis mode
         }
     }
     nv->valuetype = TYPE_INTEGER;
-    cm->a[_axis(nv)].axis_mode = (cmAxisMode)nv->value_int;
+    cm->config->a[_axis(nv)].axis_mode = (cmAxisMode)nv->value_int;
     return(STAT_OK);
 }
 
-stat_t cm_get_tn(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].travel_min)); }
-stat_t cm_set_tn(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].travel_min)); }
-stat_t cm_get_tm(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].travel_max)); }
-stat_t cm_set_tm(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].travel_max)); }
-stat_t cm_get_ra(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].radius)); }
-stat_t cm_set_ra(nvObj_t *nv) { return (set_float_range(nv, cm->a[_axis(nv)].radius, RADIUS_MIN, 1000000)); }
+stat_t cm_get_tn(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].travel_min)); }
+stat_t cm_set_tn(nvObj_t *nv) { return (set_float(nv, cm->config->a[_axis(nv)].travel_min)); }
+stat_t cm_get_tm(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].travel_max)); }
+stat_t cm_set_tm(nvObj_t *nv) { return (set_float(nv, cm->config->a[_axis(nv)].travel_max)); }
+stat_t cm_get_ra(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].radius)); }
+stat_t cm_set_ra(nvObj_t *nv) { return (set_float_range(nv, cm->config->a[_axis(nv)].radius, RADIUS_MIN, 1000000)); }
 
 /**** Axis Jerk Primitives
  * cm_get_axis_jerk() - returns max jerk for an axis
  * cm_set_axis_jerk() - sets the jerk for an axis, including reciprocal and cached values
  */
-float cm_get_axis_jerk(const uint8_t axis) { return (cm->a[axis].jerk_max); }
+float cm_get_axis_jerk(const uint8_t axis) { return (cm->config->a[axis].jerk_max); }
 
 // Precompute sqrt(3)/10 for the max_junction_accel.
 // See plan_line.cpp -> _calculate_junction_vmax() notes for details.
@@ -2401,21 +2434,21 @@ static const float _junction_accel_multiplier = sqrt(3.0)/10.0;
 // Important note: Actual jerk is stored jerk * JERK_MULTIPLIER, and
 // Time Quanta is junction_integration_time / 1000.
 void _cm_recalc_junction_accel(const uint8_t axis) {
-    float T = cm->junction_integration_time / 1000.0;
+    float T = cm->config->junction_integration_time / 1000.0;
     float T2 = T*T;
-    cm->a[axis].max_junction_accel = _junction_accel_multiplier * T2 * (cm->a[axis].jerk_max * JERK_MULTIPLIER);
-    cm->a[axis].high_junction_accel = _junction_accel_multiplier * T2 * (cm->a[axis].jerk_high * JERK_MULTIPLIER);
+    cm->config->a[axis].max_junction_accel = _junction_accel_multiplier * T2 * (cm->config->a[axis].jerk_max * JERK_MULTIPLIER);
+    cm->config->a[axis].high_junction_accel = _junction_accel_multiplier * T2 * (cm->config->a[axis].jerk_high * JERK_MULTIPLIER);
 }
 
 void cm_set_axis_max_jerk(const uint8_t axis, const float jerk)
 {
-    cm->a[axis].jerk_max = jerk;
+    cm->config->a[axis].jerk_max = jerk;
     _cm_recalc_junction_accel(axis);    // Must recalculate the max_junction_accel now that the jerk has changed.
 }
 
 void cm_set_axis_high_jerk(const uint8_t axis, const float jerk)
 {
-    cm->a[axis].jerk_high = jerk;
+    cm->config->a[axis].jerk_high = jerk;
     _cm_recalc_junction_accel(axis);    // Must recalculate the max_junction_accel now that the jerk has changed.
 }
 
@@ -2439,38 +2472,38 @@ void cm_set_axis_high_jerk(const uint8_t axis, const float jerk)
  *  This is corrected to mm/min^3 by the internals of the code.
  */
 
-stat_t cm_get_vm(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].velocity_max)); }
+stat_t cm_get_vm(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].velocity_max)); }
 stat_t cm_set_vm(nvObj_t *nv)
 {
     uint8_t axis = _axis(nv);
-    ritorno(set_float_range(nv, cm->a[axis].velocity_max, 0, MAX_LONG));
-    cm->a[axis].recip_velocity_max = 1/nv->value_flt;
+    ritorno(set_float_range(nv, cm->config->a[axis].velocity_max, 0, MAX_LONG));
+    cm->config->a[axis].recip_velocity_max = 1/nv->value_flt;
     return(STAT_OK);
 }
 
-stat_t cm_get_fr(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].feedrate_max)); }
+stat_t cm_get_fr(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].feedrate_max)); }
 stat_t cm_set_fr(nvObj_t *nv)
 {
     uint8_t axis = _axis(nv);
-    ritorno(set_float_range(nv, cm->a[axis].feedrate_max, 0, MAX_LONG));
-    cm->a[axis].recip_feedrate_max = 1/nv->value_flt;
+    ritorno(set_float_range(nv, cm->config->a[axis].feedrate_max, 0, MAX_LONG));
+    cm->config->a[axis].recip_feedrate_max = 1/nv->value_flt;
     return(STAT_OK);
 }
 
-stat_t cm_get_jm(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].jerk_max)); }
+stat_t cm_get_jm(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].jerk_max)); }
 stat_t cm_set_jm(nvObj_t *nv)
 {
     uint8_t axis = _axis(nv);
-    ritorno(set_float_range(nv, cm->a[axis].jerk_max, JERK_INPUT_MIN, JERK_INPUT_MAX));
+    ritorno(set_float_range(nv, cm->config->a[axis].jerk_max, JERK_INPUT_MIN, JERK_INPUT_MAX));
     cm_set_axis_max_jerk(axis, nv->value_flt);
     return(STAT_OK);
 }
 
-stat_t cm_get_jh(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].jerk_high)); }
+stat_t cm_get_jh(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].jerk_high)); }
 stat_t cm_set_jh(nvObj_t *nv)
 {
     uint8_t axis = _axis(nv);
-    ritorno(set_float_range(nv, cm->a[axis].jerk_high, JERK_INPUT_MIN, JERK_INPUT_MAX));
+    ritorno(set_float_range(nv, cm->config->a[axis].jerk_high, JERK_INPUT_MIN, JERK_INPUT_MAX));
     cm_set_axis_high_jerk(axis, nv->value_flt);
     return(STAT_OK);
 }
@@ -2490,18 +2523,18 @@ stat_t cm_set_jh(nvObj_t *nv)
  * cm_set_zb() - set homing zero backoff
  */
 
-stat_t cm_get_hi(nvObj_t *nv) { return (get_integer(nv, cm->a[_axis(nv)].homing_input)); }
-stat_t cm_set_hi(nvObj_t *nv) { return (set_integer(nv, cm->a[_axis(nv)].homing_input, 0, D_IN_CHANNELS)); }
-stat_t cm_get_hd(nvObj_t *nv) { return (get_integer(nv, cm->a[_axis(nv)].homing_dir)); }
-stat_t cm_set_hd(nvObj_t *nv) { return (set_integer(nv, cm->a[_axis(nv)].homing_dir, 0, 1)); }
-stat_t cm_get_sv(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].search_velocity)); }
-stat_t cm_set_sv(nvObj_t *nv) { return (set_float_range(nv, cm->a[_axis(nv)].search_velocity, 0, MAX_LONG)); }
-stat_t cm_get_lv(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].latch_velocity)); }
-stat_t cm_set_lv(nvObj_t *nv) { return (set_float_range(nv, cm->a[_axis(nv)].latch_velocity, 0, MAX_LONG)); }
-stat_t cm_get_lb(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].latch_backoff)); }
-stat_t cm_set_lb(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].latch_backoff)); }
-stat_t cm_get_zb(nvObj_t *nv) { return (get_float(nv, cm->a[_axis(nv)].zero_backoff)); }
-stat_t cm_set_zb(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].zero_backoff)); }
+stat_t cm_get_hi(nvObj_t *nv) { return (get_integer(nv, cm->config->a[_axis(nv)].homing_input)); }
+stat_t cm_set_hi(nvObj_t *nv) { return (set_integer(nv, cm->config->a[_axis(nv)].homing_input, 0, D_IN_CHANNELS)); }
+stat_t cm_get_hd(nvObj_t *nv) { return (get_integer(nv, cm->config->a[_axis(nv)].homing_dir)); }
+stat_t cm_set_hd(nvObj_t *nv) { return (set_integer(nv, cm->config->a[_axis(nv)].homing_dir, 0, 1)); }
+stat_t cm_get_sv(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].search_velocity)); }
+stat_t cm_set_sv(nvObj_t *nv) { return (set_float_range(nv, cm->config->a[_axis(nv)].search_velocity, 0, MAX_LONG)); }
+stat_t cm_get_lv(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].latch_velocity)); }
+stat_t cm_set_lv(nvObj_t *nv) { return (set_float_range(nv, cm->config->a[_axis(nv)].latch_velocity, 0, MAX_LONG)); }
+stat_t cm_get_lb(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].latch_backoff)); }
+stat_t cm_set_lb(nvObj_t *nv) { return (set_float(nv, cm->config->a[_axis(nv)].latch_backoff)); }
+stat_t cm_get_zb(nvObj_t *nv) { return (get_float(nv, cm->config->a[_axis(nv)].zero_backoff)); }
+stat_t cm_set_zb(nvObj_t *nv) { return (set_float(nv, cm->config->a[_axis(nv)].zero_backoff)); }
 
 /*** Canonical Machine Global Settings ***/
 /*
@@ -2509,6 +2542,8 @@ stat_t cm_set_zb(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].zero_back
  * cm_set_jt()  - set junction integration time
  * cm_get_ct()  - get chordal tolerance
  * cm_set_ct()  - set chordal tolerance
+ * cm_get_lmt() - get line merge tolerance
+ * cm_set_lmt() - set line merge tolerance
  * cm_get_sl()  - get soft limit enable
  * cm_set_sl()  - set soft limit enable
  * cm_get_lim() - get hard limit enable
@@ -2519,27 +2554,30 @@ stat_t cm_set_zb(nvObj_t *nv) { return (set_float(nv, cm->a[_axis(nv)].zero_back
  * cm_set_mto() - set manual traverse override factor
  */
 
-stat_t cm_get_jt(nvObj_t *nv) { return(get_float(nv, cm->junction_integration_time)); }
+stat_t cm_get_jt(nvObj_t *nv) { return(get_float(nv, cm->config->junction_integration_time)); }
 stat_t cm_set_jt(nvObj_t *nv)
 {
-    ritorno(set_float_range(nv, cm->junction_integration_time, JUNCTION_INTEGRATION_MIN, JUNCTION_INTEGRATION_MAX));
+    ritorno(set_float_range(nv, cm->config->junction_integration_time, JUNCTION_INTEGRATION_MIN, JUNCTION_INTEGRATION_MAX));
     for (uint8_t axis=0; axis<AXES; axis++) { // recalculate max_junction_accel now that time quanta has changed.
         _cm_recalc_junction_accel(axis);
     }
     return(STAT_OK);
 }
 
-stat_t cm_get_ct(nvObj_t *nv) { return(get_float(nv, cm->chordal_tolerance)); }
-stat_t cm_set_ct(nvObj_t *nv) { return(set_float_range(nv, cm->chordal_tolerance, CHORDAL_TOLERANCE_MIN, 10000000)); }
+stat_t cm_get_ct(nvObj_t *nv) { return(get_float(nv, cm->config->chordal_tolerance)); }
+stat_t cm_set_ct(nvObj_t *nv) { return(set_float_range(nv, cm->config->chordal_tolerance, CHORDAL_TOLERANCE_MIN, 10000000)); }
+
+stat_t cm_get_lmt(nvObj_t *nv) { return(get_float(nv, cm->config->merge_tolerance)); }
+stat_t cm_set_lmt(nvObj_t *nv) { return(set_float_range(nv, cm->config->merge_tolerance, 0, 10)); }
 
-stat_t cm_get_zl(nvObj_t *nv) { return(get_float(nv, cm->feedhold_z_lift)); }
-stat_t cm_set_zl(nvObj_t *nv) { return(set_float(nv, cm->feedhold_z_lift)); }
+stat_t cm_get_zl(nvObj_t *nv) { return(get_float(nv, cm->config->feedhold_z_lift)); }
+stat_t cm_set_zl(nvObj_t *nv) { return(set_float(nv, cm->config->feedhold_z_lift)); }
 
-stat_t cm_get_sl(nvObj_t *nv) { return(get_integer(nv, cm->soft_limit_enable)); }
-stat_t cm_set_sl(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->soft_limit_enable, 0, 1)); }
+stat_t cm_get_sl(nvObj_t *nv) { return(get_integer(nv, cm->config->soft_limit_enable)); }
+stat_t cm_set_sl(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->config->soft_limit_enable, 0, 1)); }
 
-stat_t cm_get_lim(nvObj_t *nv) { return(get_integer(nv, cm->limit_enable)); }
-stat_t cm_set_lim(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->limit_enable, 0, 1)); }
+stat_t cm_get_lim(nvObj_t *nv) { return(get_integer(nv, cm->config->limit_enable)); }
+stat_t cm_set_lim(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->config->limit_enable, 0, 1)); }
 
 stat_t cm_get_m48(nvObj_t *nv) { return(get_integer(nv, cm->gmx.m48_enable)); }
 stat_t cm_set_m48(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->gmx.m48_enable, 0, 1)); }
@@ -2558,24 +2596,24 @@ stat_t cm_set_tro(nvObj_t *nv)  { return(set_float_range(nv, cm->gmx.mto_factor,
 stat_t cm_get_plmo(nvObj_t *nv) { return(get_integer(nv, cm->gmx.planning_mode)); }
 stat_t cm_set_plmo(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->gmx.planning_mode, 2, 4)); }
 
-stat_t cm_get_gpl(nvObj_t *nv) { return(get_integer(nv, cm->default_select_plane)); }
-stat_t cm_set_gpl(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->default_select_plane, CANON_PLANE_XY, CANON_PLANE_YZ)); }
+stat_t cm_get_gpl(nvObj_t *nv) { return(get_integer(nv, cm->config->default_select_plane)); }
+stat_t cm_set_gpl(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->config->default_select_plane, CANON_PLANE_XY, CANON_PLANE_YZ)); }
 
-stat_t cm_get_gun(nvObj_t *nv) { return(get_integer(nv, cm->default_units_mode)); }
-////##stat_t cm_set_gun(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->default_units_mode, INCHES, MILLIMETERS)); }
+stat_t cm_get_gun(nvObj_t *nv) { return(get_integer(nv, cm->config->default_units_mode)); }
+////##stat_t cm_set_gun(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->config->default_units_mode, INCHES, MILLIMETERS)); }
 // stat_t cm_set_gun(nvObj_t *nv) {
 //     stat_t status;
-//     status = set_integer(nv, (uint8_t &)cm->default_units_mode, INCHES, MILLIMETERS);
-//     return status == STAT_OK ? cm_set_units_mode(cm->default_units_mode) : status;
+//     status = set_integer(nv, (uint8_t &)cm->config->default_units_mode, INCHES, MILLIMETERS);
+//     return status == STAT_OK ? cm_set_units_mode(cm->config->default_units_mode) : status;
 // }
 
 ////##A attempt here to get an updated SR, but no evidence this does anything and does not trigger update; MODEL?
 //// TODO - for moment this is just kludged in FabMo
 stat_t cm_set_gun(nvObj_t *nv) {
     stat_t status;
-    status = set_integer(nv, (uint8_t &)cm->default_units_mode, INCHES, MILLIMETERS);
+    status = set_integer(nv, (uint8_t &)cm->config->default_units_mode, INCHES, MILLIMETERS);
     if (status == STAT_OK) {
-        cm_set_units_mode(cm->default_units_mode);
+        cm_set_units_mode(cm->config->default_units_mode);
         cm_reset_position_to_absolute_position(cm);
         cm_set_display_offsets(MODEL);
         sr_request_status_report(SR_REQUEST_IMMEDIATE);
@@ -2584,14 +2622,14 @@ stat_t cm_set_gun(nvObj_t *nv) {
 }
 
 
-stat_t cm_get_gco(nvObj_t *nv) { return(get_integer(nv, cm->default_coord_system)); }
-stat_t cm_set_gco(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->default_coord_system, G54, G59)); }
+stat_t cm_get_gco(nvObj_t *nv) { return(get_integer(nv, cm->config->default_coord_system)); }
+stat_t cm_set_gco(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->config->default_coord_system, G54, G59)); }
 
-stat_t cm_get_gpa(nvObj_t *nv) { return(get_integer(nv, cm->default_path_control)); }
-stat_t cm_set_gpa(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->default_path_control, PATH_EXACT_PATH, PATH_CONTINUOUS)); }
+stat_t cm_get_gpa(nvObj_t *nv) { return(get_integer(nv, cm->config->default_path_control)); }
+stat_t cm_set_gpa(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->config->default_path_control, PATH_EXACT_PATH, PATH_CONTINUOUS)); }
 
-stat_t cm_get_gdi(nvObj_t *nv) { return(get_integer(nv, cm->default_distance_mode)); }
-stat_t cm_set_gdi(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->default_distance_mode, ABSOLUTE_DISTANCE_MODE, INCREMENTAL_DISTANCE_MODE)); }
+stat_t cm_get_gdi(nvObj_t *nv) { return(get_integer(nv, cm->config->default_distance_mode)); }
+stat_t cm_set_gdi(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)cm->config->default_distance_mode, ABSOLUTE_DISTANCE_MODE, INCREMENTAL_DISTANCE_MODE)); }
 
 /*** Canonical Machine Global Settings Table Additions ***/
 /*
@@ -3071,6 +3109,7 @@ void cm_print_gdi(nvObj_t *nv) { text_print(nv, fmt_gdi);}  // TYPE_INT
 
 static const char fmt_jt[] = "[jt]  junction integration time%7.2f\n";
 static const char fmt_ct[] = "[ct]  chordal tolerance%17.4f%s\n";
+static const char fmt_lmt[] ="[lmt] line merge tolerance%15.4f%s\n";
 static const char fmt_zl[] = "[zl]  Z lift on feedhold%16.3f%s\n";
 static const char fmt_sl[] = "[sl]  soft limit enable%12d [0=disable,1=enable]\n";
 static const char fmt_lim[] ="[lim] limit switch enable%10d [0=disable,1=enable]\n";
@@ -3078,6 +3117,7 @@ static const char fmt_saf[] ="[saf] safety interlock enable%6d [0=disable,1=enab
 
 void cm_print_jt(nvObj_t *nv) { text_print(nv, fmt_jt);}        // TYPE FLOAT
 void cm_print_ct(nvObj_t *nv) { text_print_flt_units(nv, fmt_ct, GET_UNITS(ACTIVE_MODEL));}
+void cm_print_lmt(nvObj_t *nv){ text_print_flt_units(nv, fmt_lmt, GET_UNITS(ACTIVE_MODEL));}
 void cm_print_zl(nvObj_t *nv) { text_print_flt_units(nv, fmt_zl, GET_UNITS(ACTIVE_MODEL));}
 void cm_print_sl(nvObj_t *nv) { text_print(nv, fmt_sl);}        // TYPE_INT
 void cm_print_lim(nvObj_t *nv){ text_print(nv, fmt_lim);}       // TYPE_INT
@@ -248,21 +248,17 @@ typedef struct cmArc {                      // planner and runtime variables for
     magic_t magic_end;
 } cmArc_t;
 
-typedef struct cmMachine {                  // struct to manage canonical machine globals and state
-    magic_t magic_start;                    // magic number to test memory integrity
-
-    /**** Config variables (PUBLIC) ****/
-
+typedef struct cmConfig {                   // machine configuration - one copy, shared by cm1 and cm2
     // System group settings
     float junction_integration_time;        // how aggressively will the machine corner? 1.6 or so is about the upper limit
     float chordal_tolerance;                // arc chordal accuracy setting in mm
+    float merge_tolerance;                  // G1 line merging deviation limit in mm, 0 = off
     float feedhold_z_lift;                  // mm to move Z axis on feedhold, or 0 to disable
     bool soft_limit_enable;                 // true to enable soft limit testing on Gcode inputs
     bool limit_enable;                      // true to enable limit switches (disabled is same as override)
 
-    // Coordinate systems and offsets
+    // Coordinate systems
     float coord_offset[COORDS+1][AXES];     // persistent coordinate offsets: absolute (G53) + G54,G55,G56,G57,G58,G59
-    float tool_offset[AXES];                // current tool offset
 
     // Axis settings
     cfgAxis_t a[AXES];
@@ -273,6 +269,15 @@ typedef struct cmMachine {                  // struct to manage canonical machin
     cmUnitsMode      default_units_mode;    // G20,G21 reset default
     cmPathControl    default_path_control;  // G61,G61.1,G64 reset default
     cmDistanceMode   default_distance_mode; // G90,G91 reset default
+} cmConfig_t;
+
+typedef struct cmMachine {                  // struct to manage canonical machine globals and state
+    magic_t magic_start;                    // magic number to test memory integrity
+
+    /**** Config variables (PUBLIC) ****/
+
+    cmConfig_t *config;                     // shared machine configuration (cm_config) - settings made in p2 hold for p1
+    float tool_offset[AXES];                // current tool offset
 
   /**** Runtime variables (PRIVATE) ****/
 
@@ -324,12 +329,24 @@ typedef struct cmToolTable {                // struct to keep a global tool tabl
     float tt_offset[TOOLS+1][AXES];         // persistent tool table offsets
 } cmToolTable_t;
 
+typedef struct cmFeedholdLatency {          // feedhold entry and exit timing (cycle_feedhold.cpp)
+    uint32_t entry_tick;                    // SysTick time the hold in progress was requested
+    uint32_t exit_tick;                     // SysTick time the cycle start from the hold was requested
+    uint32_t entry_ms;                      // last hold entry: request to HOLD, in ms
+    uint32_t entry_max_ms;                  // longest hold entry, in ms
+    uint32_t exit_ms;                       // last hold exit: cycle start to p1 back in control, in ms
+    uint32_t exit_max_ms;                   // longest hold exit, in ms
+    uint32_t p2_cycles;                     // CPU cycles in the last p1 to p2 state transfer (profiling builds)
+} cmFeedholdLatency_t;
+
 /**** Externs - See canonical_machine.cpp for allocation ****/
 
 extern cmMachine_t *cm;                     // pointer to active canonical machine
 extern cmMachine_t cm1;                     // canonical machine primary machine
 extern cmMachine_t cm2;                     // canonical machine secondary machine
+extern cmConfig_t cm_config;                // machine configuration shared by both machines
 extern cmToolTable_t tt;
+extern cmFeedholdLatency_t fhl;
 
 /*****************************************************************************
  * FUNCTION PROTOTYPES
@@ -435,7 +452,7 @@ stat_t cm_goto_g30_position_mm(const float target[], const bool flags[]);     //
 stat_t cm_set_feed_rate_global(const float feed_rate);                      // F parameter, global (Gcode) units - for external use
 stat_t cm_set_feed_rate_mm(const float feed_rate);                          // F parameter, mm units - for internal use
 stat_t cm_set_feed_rate_mode(const uint8_t mode);                           // G93, G94, (G95 unimplemented)
-stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode);  // G61, G61.1, G64
+stat_t cm_set_path_control(GCodeState_t *gcode_state, const uint8_t mode, const float tolerance);  // G61, G61.1, G64 P
 
 // Machining Functions (4.3.6)
 stat_t cm_straight_feed_global(const float *target, const bool *flags, const cmMotionProfile motion_profile); // G1, global (Gcode) units - for external use
@@ -500,6 +517,7 @@ void cm_request_feedhold(cmFeedholdType type, cmFeedholdExit exit);
 void cm_request_queue_flush();
 stat_t cm_feedhold_sequencing_callback(void);                   // process feedhold, cycle start and queue flush requests
 stat_t cm_feedhold_command_blocker(void);
+stat_t cm_set_fhc(nvObj_t *nv);                                 // clear feedhold latency figures
 
 bool cm_has_hold(void);                                         // has hold in primary planner
 
@@ -553,14 +571,14 @@ const configSubtable * const getPrbConfig_1();
 const configSubtable * const getJogConfig_1();
 const configSubtable *const getAxisConfig_1();
 
-// stat_t cm_get_mline(nvObj_t *nv);       // get model line number
-// stat_t cm_get_line(nvObj_t *nv);        // get active (model or runtime) line number
-// stat_t cm_get_stat(nvObj_t *nv);        // get combined machine state as value and string
-// stat_t cm_get_stat2(nvObj_t *nv);       // get combined machine state as value and string
-// stat_t cm_get_macs(nvObj_t *nv);        // get raw machine state as value and string
-// stat_t cm_get_cycs(nvObj_t *nv);        // get raw cycle state
-// stat_t cm_get_mots(nvObj_t *nv);        // get raw motion state
-// stat_t cm_get_hold(nvObj_t *nv);        // get raw hold state
+stat_t cm_get_mline(nvObj_t *nv);       // get model line number
+stat_t cm_get_line(nvObj_t *nv);        // get active (model or runtime) line number
+stat_t cm_get_stat(nvObj_t *nv);        // get combined machine state as value and string
+stat_t cm_get_stat2(nvObj_t *nv);       // get combined machine state as value and string
+stat_t cm_get_macs(nvObj_t *nv);        // get raw machine state as value and string
+stat_t cm_get_cycs(nvObj_t *nv);        // get raw cycle state
+stat_t cm_get_mots(nvObj_t *nv);        // get raw motion state
+stat_t cm_get_hold(nvObj_t *nv);        // get raw hold state
 
 stat_t cm_get_home(nvObj_t *nv);        // get machine homing state
 stat_t cm_set_home(nvObj_t *nv);        // set machine homing state
@@ -644,6 +662,8 @@ stat_t cm_get_jt(nvObj_t *nv);          // get junction integration time constan
 stat_t cm_set_jt(nvObj_t *nv);          // set junction integration time constant
 stat_t cm_get_ct(nvObj_t *nv);          // get chordal tolerance
 stat_t cm_set_ct(nvObj_t *nv);          // set chordal tolerance
+stat_t cm_get_lmt(nvObj_t *nv);         // get line merge tolerance
+stat_t cm_set_lmt(nvObj_t *nv);         // set line merge tolerance
 stat_t cm_get_zl(nvObj_t *nv);          // get feedhold Z lift
 stat_t cm_set_zl(nvObj_t *nv);          // set feedhold Z lift
 stat_t cm_get_sl(nvObj_t *nv);          // get soft limit enable
@@ -726,6 +746,7 @@ stat_t cm_set_gdi(nvObj_t *nv);         // set gcode default distance mode
 
     void cm_print_jt(nvObj_t *nv);          // global CM settings
     void cm_print_ct(nvObj_t *nv);
+    void cm_print_lmt(nvObj_t *nv);
     void cm_print_zl(nvObj_t *nv);
     void cm_print_sl(nvObj_t *nv);
     void cm_print_lim(nvObj_t *nv);
@@ -797,6 +818,7 @@ stat_t cm_set_gdi(nvObj_t *nv);         // set gcode default distance mode
 
     #define cm_print_jt tx_print_stub       // global CM settings
     #define cm_print_ct tx_print_stub
+    #define cm_print_lmt tx_print_stub
     #define cm_print_zl tx_print_stub
     #define cm_print_sl tx_print_stub
     #define cm_print_lim tx_print_stub
@@ -67,6 +67,7 @@ stat_t nv_set(nvObj_t *nv)
     if (nv->index >= nv_index_max()) {
         return(STAT_INTERNAL_RANGE_ERROR);
     }
+    sr_flag_change(SR_CHANGED_ALL);             // sets can change or run anything
     return (((fptrCmd)cfgArray[nv->index].set)(nv));
 }
 
@@ -400,9 +401,8 @@ stat_t set_grp(nvObj_t *nv)
 
 /* nv_get_index() - get index from mnenonic token + group
  *
- * nv_get_index() is the most expensive routine in the whole config. It does a
- * linear table scan of the strings, which of course could be further
- * optimized with indexes or hashing.
+ * Lookups go through the token hash index in config_app.cpp, which replaced a
+ * linear scan of every token string. Read _ixh and _ixl to compare the two.
  */
 index_t nv_get_index(const char *group, const char *token)
 {
@@ -492,6 +492,7 @@ void nv_coerce_types(nvObj_t *nv)
  * nv_reset_nv()        - quick clear for a new nv object
  * nv_reset_nv_list()   - clear entire header, body and footer for a new use
  * nv_copy_string()     - used to write a string to shared string storage and link it
+ *                        (give the length if it's known, to save a strlen() of the string)
  * nv_add_object()      - write contents of parameter to  first free object in the body
  * nv_add_integer()     - add an integer value to end of nv body (Note 1)
  * nv_add_float()       - add a floating point value to end of nv body
@@ -572,6 +573,7 @@ void _nv_reset_a_list(nvObj_t *nv, uint8_t length) // clear some nv list (called
 
 nvObj_t *nv_reset_nv_list()                     // clear the header and response body
 {
+    json_print_finish();                        // a response may still be streaming from the list
     nvStr.wp = 0;                               // reset the shared string
     nvObj_t *nv = nvl.list;                     // set up linked list and initialize elements
 
@@ -598,13 +600,18 @@ nvObj_t *nv_reset_exec_nv_list()                // clear the exec body
 
 stat_t nv_copy_string(nvObj_t *nv, const char *src)
 {
-    if ((nvStr.wp + strlen(src)) > NV_SHARED_STRING_LEN) {
+    return (nv_copy_string(nv, src, strlen(src)));
+}
+
+stat_t nv_copy_string(nvObj_t *nv, const char *src, uint16_t length)
+{
+    if ((nvStr.wp + length) > NV_SHARED_STRING_LEN) {
         return (STAT_BUFFER_FULL);
     }
     char *dst = &nvStr.string[nvStr.wp];
-    strcpy(dst, src);                           // copy string to current head position
-                                                // string has already been tested for overflow, above
-    nvStr.wp += strlen(src)+1;                  // advance head for next string
+    memcpy(dst, src, length);                   // copy string to current head position
+    dst[length] = NUL;                          // string has already been tested for overflow, above
+    nvStr.wp += length+1;                       // advance head for next string
     nv->stringp = (char (*)[])dst;
     return (STAT_OK);
 }
@@ -743,7 +750,7 @@ void nv_print_list(stat_t status, uint8_t text_flags, uint8_t json_flags)
 
 void nv_dump_nv(nvObj_t *nv)
 {
-    sprintf (cs.out_buf, "i:%ld, d:%d, t:%d, p:%d, v:%f, g:%s, t:%s, s:%s\n",
+    snprintf(cs.out_buf, sizeof(cs.out_buf), "i:%ld, d:%d, t:%d, p:%d, v:%f, g:%s, t:%s, s:%s\n",
             nv->index,
             nv->depth,
             nv->valuetype,
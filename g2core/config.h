@@ -436,6 +436,7 @@ nvObj_t *nv_reset_nv(nvObj_t *nv);
 nvObj_t *nv_reset_nv_list(void);
 nvObj_t *nv_reset_exec_nv_list();
 stat_t nv_copy_string(nvObj_t *nv, const char *src);
+stat_t nv_copy_string(nvObj_t *nv, const char *src, uint16_t length);
 nvObj_t *nv_add_object(const char *token);
 nvObj_t *nv_add_integer(const char *token, const uint32_t value);
 nvObj_t *nv_add_float(const char *token, const float value);
@@ -43,12 +43,16 @@
 #include "coolant.h"
 #include "pwm.h"
 #include "report.h"
+#include "telemetry.h"
 #include "hardware.h"
 #include "util.h"
 #include "help.h"
 #include "xio.h"
 #include "kinematics.h"
 #include "safety_manager.h"
+#if HAS_SD_JOBS
+#include "sd_job.h"
+#endif
 
 /*** structures ***/
 
@@ -74,6 +78,11 @@ static stat_t _do_all(nvObj_t *nv);         // print all parameters
 static stat_t get_rx(nvObj_t *nv);          // get bytes in RX buffer
 static stat_t get_tick(nvObj_t *nv);        // get system tick count
 
+#ifdef __DIAGNOSTIC_PARAMETERS
+static stat_t get_ixh(nvObj_t *nv);         // benchmark token lookup using the hash index
+static stat_t get_ixl(nvObj_t *nv);         // benchmark token lookup using the linear scan
+#endif
+
 /***********************************************************************************
  **** CONFIG TABLE  ****************************************************************
  ***********************************************************************************
@@ -1001,6 +1010,7 @@ constexpr cfgItem_t sys_config_items_2[] = {
     // General system parameters
     { "sys","jt",  _fipn, 2, cm_print_jt,  cm_get_jt,  cm_set_jt,  nullptr, JUNCTION_INTEGRATION_TIME },
     { "sys","ct",  _fipnc,4, cm_print_ct,  cm_get_ct,  cm_set_ct,  nullptr, CHORDAL_TOLERANCE },
+    { "sys","lmt", _fipnc,4, cm_print_lmt, cm_get_lmt, cm_set_lmt, nullptr, LINE_MERGE_TOLERANCE },
     { "sys","zl",  _fipnc,3, cm_print_zl,  cm_get_zl,  cm_set_zl,  nullptr, FEEDHOLD_Z_LIFT },
     { "sys","sl",  _bipn, 0, cm_print_sl,  cm_get_sl,  cm_set_sl,  nullptr, SOFT_LIMIT_ENABLE },
     { "sys","lim", _bipn, 0, cm_print_lim, cm_get_lim, cm_set_lim, nullptr, HARD_LIMIT_ENABLE },
@@ -1063,6 +1073,9 @@ constexpr cfgItem_t sys_config_items_2[] = {
     { "sys","qv", _iipn, 0, qr_print_qv,  qr_get_qv, qr_set_qv, nullptr, QUEUE_REPORT_VERBOSITY },
     { "sys","sv", _iipn, 0, sr_print_sv,  sr_get_sv, sr_set_sv, nullptr, STATUS_REPORT_VERBOSITY },
     { "sys","si", _iipn, 0, sr_print_si,  sr_get_si, sr_set_si, nullptr, STATUS_REPORT_INTERVAL_MS },
+#ifdef __TELEMETRY
+    { "sys","tmr",_iipn, 0, tm_print_tmr, tm_get_tmr, tm_set_tmr, nullptr, TELEMETRY_RATE },
+#endif
 
     // Gcode defaults
     // NOTE: The ordering within the gcode defaults is important for token resolution. gc must follow gco
@@ -1079,10 +1092,21 @@ constexpr cfgItem_t sys_config_items_2[] = {
     { "", "qr",   _n0, 0, qr_print_qr,   qr_get,    set_nul,   nullptr, 0 },    // get queue value - planner buffers available
     { "", "qi",   _n0, 0, qr_print_qi,   qi_get,    set_nul,   nullptr, 0 },    // get queue value - buffers added to queue
     { "", "qo",   _n0, 0, qr_print_qo,   qo_get,    set_nul,   nullptr, 0 },    // get queue value - buffers removed from queue
+    { "qs","qss", _n0, 0, qs_print_qss,  qs_get_qss,set_nul,   nullptr, 0 },    // get planner starvations this cycle
+    { "qs","qsv", _n0, 0, qs_print_qsv,  qs_get_qsv,set_nul,   nullptr, 0 },    // get moves limited by queue depth this cycle
+    { "qs","qsm", _n0, 1, qs_print_qsm,  qs_get_qsm,set_nul,   nullptr, 0 },    // get minimum time in planner this cycle (ms)
+    { "qs","qsh", _n0, 0, qs_print_qsh,  qs_get_qsh,set_nul,   nullptr, 0 },    // get moves started with a short horizon this cycle
+    { "", "hzl",  _f0, 3, qs_print_hzl,  qs_get_hzl,set_ro,    nullptr, 0 },    // get look-ahead horizon (mm)
+    { "", "hzt",  _f0, 1, qs_print_hzt,  qs_get_hzt,set_ro,    nullptr, 0 },    // get look-ahead horizon (ms)
     { "", "er",   _n0, 0, tx_print_nul,  rpt_er,    set_nul,   nullptr, 0 },    // get bogus exception report for testing
     { "", "rx",   _n0, 0, tx_print_int,  get_rx,    set_nul,   nullptr, 0 },    // get RX buffer bytes or packets
     { "", "dw",   _i0, 0, tx_print_int,  st_get_dw, set_noop,  nullptr, 0 },    // get dwell time remaining
     { "", "msg",  _s0, 0, tx_print_str,  get_nul,   set_noop,  nullptr, 0 },    // no operation on messages
+#if HAS_SD_JOBS
+    { "", "job",  _i0, 0, tx_print_int,  sd_job_get_state, set_ro, nullptr, 0 },   // get SD card job state
+    { "", "jobc", _s0, 0, tx_print_nul,  get_nul, sd_job_compile,  nullptr, 0 },   // compile an SD card Gcode file to a job
+    { "", "jobr", _s0, 0, tx_print_nul,  get_nul, sd_job_run,      nullptr, 0 },   // validate and run a compiled job
+#endif
     { "", "alarm",_n0, 0, tx_print_nul,  cm_alrm,   cm_alrm,   nullptr, 0 },    // trigger alarm
     { "", "panic",_n0, 0, tx_print_nul,  cm_pnic,   cm_pnic,   nullptr, 0 },    // trigger panic
     { "", "shutd",_n0, 0, tx_print_nul,  cm_shutd,  cm_shutd,  nullptr, 0 },    // trigger shutdown
@@ -1551,6 +1575,38 @@ constexpr cfgItem_t diagnostic_config_items_1[] = {
     { "_tr","_tra",_f0, 2, tx_print_flt, get_flt, set_nul, &mr1.gm.target[AXIS_A], 0 },
     { "_tr","_trb",_f0, 2, tx_print_flt, get_flt, set_nul, &mr1.gm.target[AXIS_B], 0 },
     { "_tr","_trc",_f0, 2, tx_print_flt, get_flt, set_nul, &mr1.gm.target[AXIS_C], 0 },
+
+    { "","_ixh",_f0, 1, tx_print_flt, get_ixh, set_nul, nullptr, 0 },  // mean cycles per token lookup - hash index
+    { "","_ixl",_f0, 1, tx_print_flt, get_ixl, set_nul, nullptr, 0 },  // mean cycles per token lookup - linear scan
+    { "","_gcn",_f0, 0, tx_print_flt, gc_get_gcn, set_nul, nullptr, 0 },  // mean Gcode normalizer throughput in bytes/sec of CPU time
+    { "","_jsb",_f0, 0, tx_print_int, get_int32, set_nul, &js.print_block_max_ms, 0 },  // longest main loop hold printing a JSON response in ms
+    { "","_jsl",_f0, 0, tx_print_int, get_int32, set_nul, &js.print_len_max, 0 },       // longest JSON response in bytes
+
+    { "_fh","_fhe",_f0, 0, tx_print_int, get_int32, set_nul, &fhl.entry_ms, 0 },     // last feedhold entry (request to HOLD) in ms
+    { "_fh","_fhf",_f0, 0, tx_print_int, get_int32, set_nul, &fhl.entry_max_ms, 0 }, // longest feedhold entry in ms
+    { "_fh","_fhx",_f0, 0, tx_print_int, get_int32, set_nul, &fhl.exit_ms, 0 },      // last feedhold exit (cycle start to p1 resumed) in ms
+    { "_fh","_fhy",_f0, 0, tx_print_int, get_int32, set_nul, &fhl.exit_max_ms, 0 },  // longest feedhold exit in ms
+    { "_fh","_fhp",_f0, 0, tx_print_int, get_int32, set_nul, &fhl.p2_cycles, 0 },    // CPU cycles in the last p1 to p2 state transfer (profiling builds)
+    { "_fh","_fhc",_f0, 0, tx_print_nul, get_nul, cm_set_fhc, nullptr, 0 },          // clear feedhold latency figures
+
+#ifdef __PLANNER_PROFILING
+    { "_pf","_pfb",_f0, 1, tx_print_flt, mp_get_pfb, set_nul, nullptr, 0 },   // planner blocks per second
+    { "_pf","_pfs",_f0, 1, tx_print_flt, mp_get_pfs, set_nul, nullptr, 0 },   // exec segments per second
+    { "_pf","_pfm",_f0, 1, tx_print_flt, mp_get_pfm, set_nul, nullptr, 0 },   // worst-case _plan_block() time in uSec
+    { "_pf","_pfa",_f0, 1, tx_print_flt, mp_get_pfa, set_nul, nullptr, 0 },   // mean _plan_block() time in uSec
+    { "_pf","_pfl",_f0, 1, tx_print_flt, mp_get_pfl, set_nul, nullptr, 0 },   // mean mp_aline()/mp_arc() block setup time in uSec
+    { "_pf","_pfv",_f0, 1, tx_print_flt, mp_get_pfv, set_nul, nullptr, 0 },   // mean blocks visited per back-planning pass
+    { "_pf","_pfw",_f0, 0, tx_print_int, mp_get_pfw, set_nul, nullptr, 0 },   // most blocks visited by one back-planning pass
+    { "_pf","_pfe",_f0, 2, tx_print_flt, mp_get_pfe, set_nul, nullptr, 0 },   // mean exec interrupt load in percent
+    { "_pf","_pft",_f0, 3, tx_print_flt, get_flt, set_nul, &mpf.velocity_error_max, 0 }, // worst segment velocity error in mm/min
+    { "_pf","_pf0",_f0, 0, tx_print_int, get_int32, set_nul, &mpf.meet_iterations[0], 0 }, // meet velocity solved with no refinement
+    { "_pf","_pf1",_f0, 0, tx_print_int, get_int32, set_nul, &mpf.meet_iterations[1], 0 }, // ...with 1 Newton refinement
+    { "_pf","_pf2",_f0, 0, tx_print_int, get_int32, set_nul, &mpf.meet_iterations[2], 0 },
+    { "_pf","_pf3",_f0, 0, tx_print_int, get_int32, set_nul, &mpf.meet_iterations[3], 0 },
+    { "_pf","_pf4",_f0, 0, tx_print_int, get_int32, set_nul, &mpf.meet_iterations[4], 0 }, // ...with 4 or more
+    { "_pf","_pfr",_f0, 0, tx_print_int, get_int32, set_nul, &mpf.stored_fits, 0 },        // ramps taken from a stored plan
+    { "_pf","_pfc",_f0, 0, tx_print_nul, get_nul, mp_set_pfc, nullptr, 0 },   // clear planner profiling counters
+#endif
 };
 constexpr cfgSubtableFromStaticArray diagnostic_config_1 {diagnostic_config_items_1};
 constexpr const configSubtable * const getDiagnosticConfig_1() { return &diagnostic_config_1; }
@@ -1663,11 +1719,12 @@ constexpr const configSubtable * const getSrPersistenceConfig_1() { return &sr_p
     // *** COUNT STARTS FROM HERE ***
 
 constexpr cfgItem_t groups_config_items_1[] = {
-#define FIXED_GROUPS 4
+#define FIXED_GROUPS 5
     { "","sys",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // system group
     { "","p1", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // PWM 1 group
     { "","sp", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // Spindle group
     { "","co", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // Coolant group
+    { "","qs", _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // planner starvation group
 
 #define AXIS_GROUPS AXES
     { "","x",  _f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // axis groups
@@ -1854,7 +1911,11 @@ constexpr cfgItem_t groups_config_items_1[] = {
 #endif
 
 #ifdef __DIAGNOSTIC_PARAMETERS
-#define DIAGNOSTIC_GROUPS 8
+#ifdef __PLANNER_PROFILING
+#define DIAGNOSTIC_GROUPS 10
+#else
+#define DIAGNOSTIC_GROUPS 9
+#endif
     { "","_te",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // target axis endpoint group
     { "","_tr",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // target axis runtime group
     { "","_ts",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // target motor steps group
@@ -1863,6 +1924,10 @@ constexpr cfgItem_t groups_config_items_1[] = {
     { "","_es",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // encoder steps group
     { "","_xs",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // correction steps group
     { "","_fe",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // following error group
+    { "","_fh",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // feedhold latency group
+#ifdef __PLANNER_PROFILING
+    { "","_pf",_f0, 0, tx_print_nul, get_grp, set_grp, nullptr, 0 },    // planner profiling group
+#endif
 #endif
 };
 constexpr cfgSubtableFromStaticArray groups_config_1 {groups_config_items_1};
@@ -1914,6 +1979,70 @@ const cfgItem_t &cfgArraySynthesizer::operator[](std::size_t idx) const {
     return *c;
 }
 
+/*
+ * Token hash index
+ *
+ *  Looking up a token used to walk every subtable in turn and strcmp() each entry - well
+ *  over a thousand of them. The hash index maps a token to its cfgArray index using an
+ *  open-addressed, linearly probed table of 16 bit indexes. It's built from the subtables
+ *  on the first lookup. Items are inserted in index order, so if a token were ever defined
+ *  twice the first one wins, just as it did with the linear scan.
+ *
+ *  If the table is too small to hold every item getIndex() falls back to the linear scan.
+ */
+
+#ifndef NV_HASH_TABLE_SIZE
+#define NV_HASH_TABLE_SIZE 2048                 // must be a power of 2, and should be > 1.5x NV_INDEX_MAX
+#endif
+#define NV_HASH_MASK (NV_HASH_TABLE_SIZE-1)
+#define NV_HASH_EMPTY 0xFFFF
+
+static uint16_t nv_hash_table[NV_HASH_TABLE_SIZE];
+static bool nv_hash_ready = false;              // set true once the table is built
+static bool nv_hash_overflow = false;           // set true if the table can't hold the cfgArray
+
+static uint16_t _hash_token(const char *token)  // FNV-1a, folded down to the table size
+{
+    uint32_t h = 2166136261;
+    while (*token) {
+        h ^= (uint8_t)*token++;
+        h *= 16777619;
+    }
+    return ((h ^ (h >> 16)) & NV_HASH_MASK);
+}
+
+static void _build_hash_index()
+{
+    index_t index_max = nodes.this_node.length;
+
+    memset(nv_hash_table, 0xFF, sizeof(nv_hash_table));
+    nv_hash_overflow = (index_max >= NV_HASH_EMPTY) || (index_max >= NV_HASH_TABLE_SIZE);
+    if (!nv_hash_overflow) {
+        for (index_t i=0; i < index_max; i++) {
+            uint16_t slot = _hash_token(cfgArray[i].token);
+            while (nv_hash_table[slot] != NV_HASH_EMPTY) {
+                slot = (slot+1) & NV_HASH_MASK;
+            }
+            nv_hash_table[slot] = i;
+        }
+    }
+    nv_hash_ready = true;
+}
+
+static index_t _find_hashed(const char *str)
+{
+    uint16_t slot = _hash_token(str);
+    uint16_t idx;
+
+    while ((idx = nv_hash_table[slot]) != NV_HASH_EMPTY) {
+        if (strcmp(str, cfgArray[idx].token) == 0) {
+            return (idx);
+        }
+        slot = (slot+1) & NV_HASH_MASK;
+    }
+    return (NO_MATCH);
+}
+
 index_t cfgArraySynthesizer::getIndex(const char *group, const char *token)
 {
     if (!configSubtableHead) {
@@ -1922,33 +2051,14 @@ index_t cfgArraySynthesizer::getIndex(const char *group, const char *token)
     char str[TOKEN_LEN + GROUP_LEN+1];    // should actually never be more than TOKEN_LEN+1
     strncpy(str, group, GROUP_LEN+1);
     strncat(str, token, TOKEN_LEN+1);
-    return configSubtableHead->find(str);
-
-    // index_t i;
-    // index_t index_max = nv_index_max();
-
-    // for (i=0; i < index_max; i++) {
-    //     auto config = cfgArray[i];
-    //     if ((c = config.token[0]) != str[0]) { continue; }                  // 1st character mismatch
-    //     if ((c = config.token[1]) == NUL) { if (str[1] == NUL) return(i); } // one character match
-    //     if (c != str[1]) continue;                                          // 2nd character mismatch
-    //     if ((c = config.token[2]) == NUL) { if (str[2] == NUL) return(i); } // two character match
-    //     if (c != str[2]) continue;                                          // 3rd character mismatch
-    //     if ((c = config.token[3]) == NUL) { if (str[3] == NUL) return(i); } // three character match
-    //     if (c != str[3]) continue;                                          // 4th character mismatch
-    //     if ((c = config.token[4]) == NUL) { if (str[4] == NUL) return(i); } // four character match
-    //     if (c != str[4]) continue;                                          // 5th character mismatch
-    //     if ((c = config.token[5]) == NUL) { if (str[5] == NUL) return(i); } // four character match
-    //     if (c != str[5]) continue;                                          // 6th character mismatch
-    //     if ((c = config.token[6]) == NUL) { if (str[6] == NUL) return(i); } // four character match
-    //     if (c != str[6]) continue;                                          // 7th character mismatch
-    //     if ((c = config.token[7]) == NUL) { if (str[7] == NUL) return(i); } // four character match
-    //     if (c != str[7]) continue;                                          // 8th character mismatch
-    //     if ((c = config.token[8]) == NUL) { if (str[8] == NUL) return(i); } // four character match
-    //     if (c != str[8]) continue;                                          // 9th character mismatch
-    //     return (i);                                                         // five character match
-    // }
-    // return (NO_MATCH);
+
+    if (!nv_hash_ready) {
+        _build_hash_index();
+    }
+    if (nv_hash_overflow) {
+        return configSubtableHead->find(str);
+    }
+    return (_find_hashed(str));
 }
 
 cfgArraySynthesizer cfgArray {};
@@ -2013,7 +2123,7 @@ static void _convert(nvObj_t *nv, float conversion_factor)
         cmAxisType axis_type = cm_get_axis_type(nv);
         int8_t axis_index = _axis(nv);
         if (axis_index <= AXES) { 
-            cmAxisMode axis_mode = cm->a[axis_index].axis_mode; 
+            cmAxisMode axis_mode = cm->config->a[axis_index].axis_mode; 
             if ((axis_type == AXIS_TYPE_LINEAR) || (axis_type == AXIS_TYPE_SYSTEM) || (axis_mode == AXIS_INHIBITED)) {
                 if (cfgArray[nv->index].flags & F_CONVERT) { // standard units conversion
                     nv->value_flt *= conversion_factor;
@@ -2311,6 +2421,52 @@ static stat_t get_tick(nvObj_t *nv)
     return (STAT_OK);
 }
 
+#ifdef __DIAGNOSTIC_PARAMETERS
+/**** TOKEN LOOKUP BENCHMARK ********************************************************
+ * get_ixh() - mean CPU cycles per token lookup using the hash index
+ * get_ixl() - mean CPU cycles per token lookup using the linear subtable scan
+ *
+ *  Both look up every token in the cfgArray and time each lookup with the DWT cycle
+ *  counter. get_ixh() also checks that the hash index finds the same index as the
+ *  linear scan for every token, and fails with STAT_CONFIG_ASSERTION_FAILURE if not.
+ *  The linear pass takes tens of milliseconds, so don't run it while cutting.
+ */
+
+static stat_t _benchmark_lookup(nvObj_t *nv, bool hashed)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // make sure the cycle counter is running
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    index_t index_max = nv_index_max();
+    uint64_t cycles = 0;
+
+    for (index_t i=0; i < index_max; i++) {
+        const char *token = cfgArray[i].token;
+        index_t found;
+
+        uint32_t start = DWT->CYCCNT;
+        if (hashed) {
+            found = cfgArray.getIndex("", token);
+        } else {
+            found = configSubtableHead->find(token);
+        }
+        cycles += DWT->CYCCNT - start;
+
+        if (hashed && (found != configSubtableHead->find(token))) {
+            nv->valuetype = TYPE_NULL;
+            return (STAT_CONFIG_ASSERTION_FAILURE);
+        }
+    }
+    nv->value_flt = (float)cycles / index_max;
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+static stat_t get_ixh(nvObj_t *nv) { return (_benchmark_lookup(nv, true)); }
+static stat_t get_ixl(nvObj_t *nv) { return (_benchmark_lookup(nv, false)); }
+#endif // __DIAGNOSTIC_PARAMETERS
+
 /***********************************************************************************
  * TEXT MODE SUPPORT
  * Functions to print variables from the cfgArray table
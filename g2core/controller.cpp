@@ -47,6 +47,8 @@
 #include "settings.h"
 #include "persistence.h"
 #include "safety_manager.h"
+#include "binary_parser.h"
+#include "telemetry.h"
 
 #include "MotatePower.h"
 
@@ -78,6 +80,8 @@ static stat_t _sync_to_tx_buffer(void);
 static stat_t _dispatch_command(void);
 static stat_t _dispatch_control(void);
 static void _dispatch_kernel(const devflags_t flags);
+static bool _dispatch_gcode_line(const devflags_t flags);
+static void _dispatch_gcode(const xioLineView &line, const uint16_t saved_len);
 static stat_t _controller_state(void);          // manage controller state transitions
 
 static Motate::OutputPin<Motate::kOutputSAFE_PinNumber> safe_pin;
@@ -181,6 +185,9 @@ static void _controller_HSM()
     DISPATCH(st_motor_power_callback());        // stepper motor power sequencing
     DISPATCH(sr_status_report_callback());      // conditionally send status report
     DISPATCH(qr_queue_report_callback());       // conditionally send queue report
+#ifdef __TELEMETRY
+    DISPATCH(telemetry_callback());             // send position telemetry records
+#endif
 
     // these 3 must be in this exact order:
     DISPATCH(mp_planner_callback());            // motion planner
@@ -232,13 +239,67 @@ static stat_t _dispatch_command()
 {
     if (cs.controller_state == CONTROLLER_READY) {
         devflags_t flags = DEV_IS_BOTH | DEV_IS_MUTED; // expressly state we'll handle muted devices
-        if ((!mp_planner_is_full(mp)) && (cs.bufp = xio_readline(flags, cs.linelen)) != NULL) {
-            _dispatch_kernel(flags);
+        if ((!mp_planner_is_full(mp)) && (cs.linelen = xio_readline_view(flags, cs.line)) != 0) {
+            if (!_dispatch_gcode_line(flags)) {
+                cs.bufp = xio_line_string(cs.line); // anything but plain Gcode is handled as a string
+                _dispatch_kernel(flags);
+            }
         }
     }
     return (STAT_OK);
 }
 
+/*
+ * _dispatch_gcode_line() - parse a Gcode line in place, without copying it first
+ *
+ *  Handles the common case - a Gcode block in JSON mode - straight from the line view.
+ *  Returns false for anything else, which must go through _dispatch_kernel().
+ */
+static bool _dispatch_gcode_line(const devflags_t flags)
+{
+    char c = cs.line[0];
+    if ((flags & DEV_IS_MUTED) || (js.json_mode != JSON_MODE) ||
+        !isalpha(c) || (c == 'H') || (c == 'h')) {          // H is text mode help
+        return (false);
+    }
+    uint16_t saved_len = cs.line.copy(cs.saved_buf, SAVED_BUFFER_LEN); // save input line for reporting
+    _dispatch_gcode(cs.line, saved_len);
+    return (true);
+}
+
+/*
+ * _dispatch_gcode() - parse a Gcode line and send the JSON response
+ *
+ *  line      - the Gcode block
+ *  saved_len - length of the copy of the line in cs.saved_buf, echoed in the response
+ */
+static void _dispatch_gcode(const xioLineView &line, const uint16_t saved_len)
+{
+    stat_t status;
+    cs.comm_request_mode = JSON_MODE;                       // mode of this command
+
+    // this optimization bypasses the standard JSON parser and does what it needs directly
+    nvObj_t *nv = nv_reset_nv_list();                       // get a fresh nvObj list
+    strcpy(nv->token, "gc");                                // label is as a Gcode block (do not get an index - not necessary)
+    nv_copy_string(nv, cs.saved_buf, saved_len);            // copy the Gcode line
+    nv->valuetype = TYPE_STRING;
+    status = gcode_parser_line(line);
+
+#if MARLIN_COMPAT_ENABLED == true
+    if (js.json_mode == MARLIN_COMM_MODE) {                 // in case a marlin-specific M-code was found
+        cs.comm_request_mode = MARLIN_COMM_MODE;            // mode of this command
+        // We are switching to marlin_comm_mode, kill status reports and queue reports
+        sr.status_report_verbosity = SR_OFF;
+        qr.queue_report_verbosity = QR_OFF;
+        marlin_response(status, cs.saved_buf);
+        return;
+    }
+#endif
+
+    nv_print_list(status, TEXT_NO_PRINT, JSON_RESPONSE_FORMAT);
+    sr_request_status_report(SR_REQUEST_TIMED);             // generate incremental status report to show any changes
+}
+
 static void _dispatch_kernel(const devflags_t flags)
 {
     stat_t status;
@@ -290,6 +351,15 @@ static void _dispatch_kernel(const devflags_t flags)
         cs.comm_request_mode = JSON_MODE;                   // mode of this command
         json_parser(cs.bufp);
     }
+#ifdef __BINARY_MOTION
+    else if (*cs.bufp == STX) {                             // process as a binary motion frame
+        cs.comm_request_mode = JSON_MODE;                   // responses to binary frames are always JSON
+        nv_reset_nv_list();                                 // get a fresh nvObj list
+        status = binary_parser(cs.bufp, cs.linelen);
+        nv_print_list(status, TEXT_NO_PRINT, JSON_RESPONSE_FORMAT);
+        sr_request_status_report(SR_REQUEST_TIMED);         // generate incremental status report to show any changes
+    }
+#endif
 #ifdef __TEXT_MODE
     else if (strchr("$?Hh", *cs.bufp) != NULL) {            // process as text mode
         if (cs.comm_mode == AUTO_MODE) { js.json_mode = TEXT_MODE; } // switch to text mode
@@ -312,28 +382,8 @@ static void _dispatch_kernel(const devflags_t flags)
     }
 #endif
     else {  // anything else is interpreted as Gcode
-        cs.comm_request_mode = JSON_MODE;                   // mode of this command
-
-        // this optimization bypasses the standard JSON parser and does what it needs directly
-        nvObj_t *nv = nv_reset_nv_list();                   // get a fresh nvObj list
-        strcpy(nv->token, "gc");                            // label is as a Gcode block (do not get an index - not necessary)
-        nv_copy_string(nv, cs.bufp);                        // copy the Gcode line
-        nv->valuetype = TYPE_STRING;
-        status = gcode_parser(cs.bufp);
-
-#if MARLIN_COMPAT_ENABLED == true
-        if (js.json_mode == MARLIN_COMM_MODE) {             // in case a marlin-specific M-code was found
-            cs.comm_request_mode = MARLIN_COMM_MODE;        // mode of this command
-            // We are switching to marlin_comm_mode, kill status reports and queue reports
-            sr.status_report_verbosity = SR_OFF;
-            qr.queue_report_verbosity = QR_OFF;
-            marlin_response(status, cs.saved_buf);
-            return;
-        }
-#endif
-
-        nv_print_list(status, TEXT_NO_PRINT, JSON_RESPONSE_FORMAT);
-        sr_request_status_report(SR_REQUEST_TIMED);         // generate incremental status report to show any changes
+        xioLineView line = { cs.bufp, (uint16_t)strlen(cs.bufp), nullptr, 0 };
+        _dispatch_gcode(line, line.size());                 // cs.saved_buf holds all of the line
     }
 }
 
@@ -473,7 +523,7 @@ static stat_t _led_indicator()
  */
 static stat_t _sync_to_tx_buffer()
 {
-    return (STAT_OK);
+    return (json_print_callback());         // eagain until the last response is out
 }
 
 static stat_t _sync_to_planner()
@@ -511,7 +561,7 @@ static stat_t _limit_switch_handler(void)
         (machine_state != MACHINE_SHUTDOWN)) {
         safe_pin.toggle();
     }
-    if ((cm->limit_enable == true) && (cm->limit_requested != 0)) {
+    if ((cm->config->limit_enable == true) && (cm->limit_requested != 0)) {
         char msg[10];
         sprintf(msg, "input %d", (int)cm->limit_requested);
         cm->limit_requested = false; // clear limit request used here ^
@@ -32,7 +32,7 @@
 
 // see also: g2core.h MESSAGE_LEN and config.h NV_ lengths
 #define SAVED_BUFFER_LEN RX_BUFFER_SIZE // saved buffer size (for reporting only)
-#define OUTPUT_BUFFER_LEN 512           // text buffer size
+#define OUTPUT_BUFFER_LEN 256           // text mode lines - JSON responses are streamed (see js.stream_chunk)
 
 #define LED_NORMAL_BLINK_RATE 3000      // blink rate for normal operation (in ms)
 #define LED_ALARM_BLINK_RATE 750        // blink rate for alarm state (in ms)
@@ -70,6 +70,7 @@ typedef struct controllerSingleton {    // main TG controller struct
     bool responses_suppressed;          // if true, responses are to be suppressed (for internal-file delivery)
     
     // controller serial buffers
+    xioLineView line;                   // line being processed, in place in the device's buffer
     char *bufp;                         // pointer to primary or secondary in buffer
     uint16_t linelen;                   // length of currently processing line
     char out_buf[OUTPUT_BUFFER_LEN];    // output buffer
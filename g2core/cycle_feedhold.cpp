@@ -36,6 +36,7 @@
 #include "stepper.h"
 #include "spindle.h"
 #include "coolant.h"
+#include "report.h"
 #include "util.h"
 #include "xio.h"
 
@@ -62,6 +63,31 @@ stat_t _run_interlock_started(void);
 stat_t _run_interlock_ended(void);
 stat_t _run_reset_position(void);
 
+cmFeedholdLatency_t fhl;                    // feedhold entry and exit timing
+
+/*
+ * _record_latency() - record time since start_tick as the last and longest latency
+ * cm_set_fhc()      - clear feedhold latency figures
+ */
+
+static void _record_latency(const uint32_t start_tick, uint32_t *last_ms, uint32_t *max_ms)
+{
+    *last_ms = SysTickTimer.getValue() - start_tick;
+    if (*last_ms > *max_ms) {
+        *max_ms = *last_ms;
+    }
+}
+
+stat_t cm_set_fhc(nvObj_t *nv)
+{
+    fhl.entry_ms = 0;
+    fhl.entry_max_ms = 0;
+    fhl.exit_ms = 0;
+    fhl.exit_max_ms = 0;
+    fhl.p2_cycles = 0;
+    return (STAT_OK);
+}
+
 /****************************************************************************************
  * OPERATIONS AND ACTIONS
  *
@@ -434,6 +460,7 @@ void _start_cycle_restart()
     // Feedhold cycle restart builds an operation to complete multiple actions
     if (cm1.hold_state == FEEDHOLD_HOLD) {
         cm1.cycle_start_state = CYCLE_START_OFF;
+        fhl.exit_tick = SysTickTimer.getValue();
         switch (cm1.hold_type) {
             case FEEDHOLD_TYPE_HOLD:    { op.add_action(_feedhold_restart_no_actions); break; }
             case FEEDHOLD_TYPE_ACTIONS: { op.add_action(_feedhold_restart_with_actions); break; }
@@ -476,6 +503,7 @@ void _start_queue_flush()
     // Don't initiate the queue until in HOLD state (this also means that runtime is idle)
     if ((cm1.queue_flush_state == QUEUE_FLUSH_REQUESTED) && (cm1.hold_state == FEEDHOLD_HOLD)) {
         xio_flush_device(flags);
+        fhl.exit_tick = SysTickTimer.getValue();
         if (cm1.hold_type == FEEDHOLD_TYPE_ACTIONS) {
             op.add_action(_feedhold_restart_with_actions);
         } else {
@@ -541,6 +569,8 @@ stat_t _run_job_kill()
         cm = &cm1;                                      // return to primary planner (p1)
         mp = (mpPlanner_t *)cm->mp;                     // cm->mp is a void pointer
         mr = mp->mr;
+        mp_clear_merge();                               // the merge state may point into p2
+        sr_flag_change(SR_CHANGED_ALL);
 
         copy_vector(cm1.gmx.position, mr2.position);    // transfer actual position back to p1
         copy_vector(cm1.gm.target, mr2.position);
@@ -635,6 +665,7 @@ void cm_request_feedhold(cmFeedholdType type, cmFeedholdExit exit)
 		if (cm1.hold_state == FEEDHOLD_EXIT_ACTIONS_PENDING) {
 			// re-load a hold
 			cm1.hold_type = type;
+			fhl.entry_tick = SysTickTimer.getValue();
 			switch (cm1.hold_type) {
 				case FEEDHOLD_TYPE_HOLD:     { op.add_action(_feedhold_no_actions, true); break; }
 				case FEEDHOLD_TYPE_ACTIONS:  { op.add_action(_feedhold_with_actions, true); break; }
@@ -650,34 +681,67 @@ void cm_request_feedhold(cmFeedholdType type, cmFeedholdExit exit)
  * _exit_p2()   - reenter p1 planner with proper state transfer from p2
  *
  * Encapsulate entering and exiting p2, as this is tricky and must be done exactly right
+ *
+ * cm2 runs on the same configuration as cm1 (cm_config, via cm->config), so settings
+ * made while in the hold are in effect when p1 resumes, and nothing needs to be copied
+ * for them. Only the dynamic model state is transferred into cm2 - the machine, homing
+ * and probe state, the rotation, tool offset and the Gcode model. cm2's planner links
+ * (mp, am) are left as canonical_machine_init() set them.
  */
 
-
 ////##ted, note this is entry into P2 !!!
 void _enter_p2()
 {
-    // Copy the primary canonical machine to the secondary. Here it's OK to co a memcpy.
-    // Set parameters in cm, gm and gmx so you can actually use it
-    memcpy(&cm2, &cm1, sizeof(cmMachine_t));
+#ifdef __PLANNER_PROFILING
+    uint32_t start_cycles = PROFILE_CYCLES;
+#endif
+    // Transfer the dynamic model state from the primary canonical machine to the secondary
+    cm2.machine_state = cm1.machine_state;
+    cm2.cycle_type = cm1.cycle_type;
+    cm2.motion_state = cm1.motion_state;
+    cm2.hold_type = cm1.hold_type;
+    cm2.hold_exit = cm1.hold_exit;
     cm2.hold_state = FEEDHOLD_OFF;
+    cm2.queue_flush_state = QUEUE_FLUSH_OFF;
+    cm2.cycle_start_state = cm1.cycle_start_state;
+    cm2.job_kill_state = cm1.job_kill_state;
+    cm2.mfo_state = cm1.mfo_state;
+    cm2.limit_requested = cm1.limit_requested;
+    cm2.deferred_write_flag = cm1.deferred_write_flag;
+    cm2.homing_state = cm1.homing_state;
+    memcpy(cm2.homed, cm1.homed, sizeof(cm2.homed));
+    cm2.probe_report_enable = cm1.probe_report_enable;
+    memcpy(cm2.probe_state, cm1.probe_state, sizeof(cm2.probe_state));
+    cm2.probe_input = cm1.probe_input;
+    memcpy(cm2.probe_results, cm1.probe_results, sizeof(cm2.probe_results));
+    memcpy(cm2.rotation_matrix, cm1.rotation_matrix, sizeof(cm2.rotation_matrix));
+    cm2.rotation_z_offset = cm1.rotation_z_offset;
+    cm2.jogging_dest = cm1.jogging_dest;
+    copy_vector(cm2.tool_offset, cm1.tool_offset);
+
+    // Set parameters in gm and gmx so you can actually use it
     mpBuf_t *bf = mp_get_run_buffer();      // Get the current valid run buffer
-    if (bf) { 
-        cm2.gm = bf->gm;                    // Set gm to a copy of the current run buffer's gm
+    if ((bf != nullptr) && (bf->gm != nullptr)) {
+        mp_get_block_gm(bf, &cm2.gm);       // Set gm to a copy of the current run buffer's gm
+    } else {
+        cm2.gm = cm1.gm;
     }
+    cm2.gmx = cm1.gmx;
     cm2.gm.motion_mode = MOTION_MODE_CANCEL_MOTION_MODE;
+    if (cm2.gm.feed_rate_mode == INVERSE_TIME_MODE) {
+        cm2.gm.feed_rate_mode = UNITS_PER_MINUTE_MODE;  // there is no inverse time feed to carry into p2
+    }
     cm2.gm.absolute_override = ABSOLUTE_OVERRIDE_OFF;
-    cm2.queue_flush_state = QUEUE_FLUSH_OFF;
     cm2.gm.feed_rate = 0;
     cm2.arc.run_state = BLOCK_INACTIVE;     // Stop a running p1 arc from continuing to execute in p2
+    cm2.am = &cm2.gm;                       // active model is the p2 model until motion starts in p2
 
-    // Set mp planner to p2 and reset it
-    cm2.mp = &mp2;
+    // Reset the p2 planner
     planner_reset((mpPlanner_t *)cm2.mp);   // mp is a void pointer
 
     // Clear the target and set the positions to the current hold position
     memset(&(cm2.return_flags), 0, sizeof(cm2.return_flags));
     memset(&(cm2.gm.target), 0, sizeof(cm2.gm.target));
-    memset(&(cm2.gm.target_comp), 0, sizeof(cm2.gm.target_comp)); // zero Kahan compensation
 
     copy_vector(cm2.gmx.position, mr1.position);
     copy_vector(mp2.position, mr1.position);
@@ -694,6 +758,11 @@ void _enter_p2()
     cm = &cm2;
     mp = (mpPlanner_t *)cm2.mp;     // mp is a void pointer
     mr = mp2.mr;
+    mp_clear_merge();               // the merge state points into p1
+    sr_flag_change(SR_CHANGED_ALL); // reports now read p2
+#ifdef __PLANNER_PROFILING
+    fhl.p2_cycles = PROFILE_CYCLES - start_cycles;
+#endif
 }
 
 void _exit_p2()
@@ -701,6 +770,9 @@ void _exit_p2()
     cm = &cm1;                          // return to primary planner (p1)
     mp = (mpPlanner_t *)cm1.mp;         // cm->mp is a void pointer
     mr = mp1.mr;
+    mp_clear_merge();                   // the merge state may point into p2
+    sr_flag_change(SR_CHANGED_ALL);
+    _record_latency(fhl.exit_tick, &fhl.exit_ms, &fhl.exit_max_ms);
 }
 
 void _check_motion_stopped()
@@ -755,6 +827,7 @@ stat_t _feedhold_no_actions()
     // initiate the feedhold
     if (cm1.hold_state == FEEDHOLD_OFF) {       // start a feedhold
         cm1.hold_type = FEEDHOLD_TYPE_HOLD;
+        fhl.entry_tick = SysTickTimer.getValue();
 //      cm1.hold_exit = FEEDHOLD_EXIT_STOP;     // default exit for NO_ACTIONS is STOP...
 
         if (cm1.motion_state == MOTION_STOP) {  // if motion has already stopped declare that you are in a feedhold
@@ -774,6 +847,7 @@ stat_t _feedhold_no_actions()
     mp_replan_queue(mp_get_r());                // unplan current forward plan (bf head block), and reset all blocks
     st_request_forward_plan();                  // replan from the new bf buffer
     cm1.hold_state = FEEDHOLD_HOLD;
+    _record_latency(fhl.entry_tick, &fhl.entry_ms, &fhl.entry_max_ms);
     return (STAT_OK);
 }
 
@@ -788,6 +862,7 @@ stat_t _feedhold_with_actions()          // Execute Case (5)
     // if entered while OFF start a feedhold
     if (cm1.hold_state == FEEDHOLD_OFF) {
         cm1.hold_state = FEEDHOLD_SYNC;     // ... STOP can be overridden by setting hold_exit after this function
+        fhl.entry_tick = SysTickTimer.getValue();
         return (STAT_EAGAIN);
     }
 
@@ -802,15 +877,15 @@ stat_t _feedhold_with_actions()          // Execute Case (5)
         }
 
         // execute feedhold actions
-        if (fp_NOT_ZERO(cm->feedhold_z_lift)) { // Optional Z lift
+        if (fp_NOT_ZERO(cm->config->feedhold_z_lift)) { // Optional Z lift
             bool flags[] = { 0,0,1,0,0,0 };
             float target[] = { 0,0,0,0,0,0 };
             bool skip_move = false;
-            if (cm->feedhold_z_lift < 0) {      // If the value is negative, we want to go to Z-max position with G53
+            if (cm->config->feedhold_z_lift < 0) {      // If the value is negative, we want to go to Z-max position with G53
                 if (cmHomingState::HOMING_HOMED == cm->homed[AXIS_Z]) {    // ONLY IF HOMED
                     cm_set_absolute_override(MODEL, ABSOLUTE_OVERRIDE_ON_DISPLAY_WITH_OFFSETS);  // Position stored in abs coords
                     cm_set_distance_mode(ABSOLUTE_DISTANCE_MODE);          // Must run in absolute distance mode
-                    target[AXIS_Z] = cm->a[AXIS_Z].travel_max;
+                    target[AXIS_Z] = cm->config->a[AXIS_Z].travel_max;
                 } else {
                     skip_move = true;
                 }
@@ -821,8 +896,8 @@ stat_t _feedhold_with_actions()          // Execute Case (5)
                 ////## Need Z to pull to fixed location; 
                 ////##  and, BETTER pull to fixed location if not above
                 cm_set_distance_mode(ABSOLUTE_DISTANCE_MODE);
-                if (cm->gmx.position[AXIS_Z] - cm_get_combined_offset(AXIS_Z) < cm->feedhold_z_lift && is_spindle_on_or_paused()) {
-                    target[AXIS_Z] = cm->feedhold_z_lift;
+                if (cm->gmx.position[AXIS_Z] - cm_get_combined_offset(AXIS_Z) < cm->config->feedhold_z_lift && is_spindle_on_or_paused()) {
+                    target[AXIS_Z] = cm->config->feedhold_z_lift;
                 } else {
                     skip_move = true;
                 }
@@ -847,6 +922,7 @@ stat_t _feedhold_with_actions()          // Execute Case (5)
     if ((cm1.hold_state == FEEDHOLD_HOLD_ACTIONS_COMPLETE) || (cm1.hold_state == FEEDHOLD_HOLD)) {
         cm1.hold_state = FEEDHOLD_HOLD;
         spindle_pause();                    // optional spindle pause
+        _record_latency(fhl.entry_tick, &fhl.entry_ms, &fhl.entry_max_ms);
         
         return (STAT_OK);
     }
@@ -874,6 +950,9 @@ stat_t _feedhold_restart_no_actions()
     cm = &cm1;                                  // return to primary planner (p1)
     mp = (mpPlanner_t *)cm->mp;                 // cm->mp is a void pointer
     mr = mp->mr;
+    mp_clear_merge();                           // the merge state may point into p2
+    sr_flag_change(SR_CHANGED_ALL);
+    _record_latency(fhl.exit_tick, &fhl.exit_ms, &fhl.exit_max_ms);
     return (STAT_OK);
 }
 
@@ -272,24 +272,24 @@ static stat_t _homing_axis_start(int8_t axis) {
     cm->homed[axis] = false;
 
     // trap axis mis-configurations
-    if (fp_ZERO(cm->a[axis].homing_input)) {
+    if (fp_ZERO(cm->config->a[axis].homing_input)) {
         return (_homing_error_exit(axis, STAT_HOMING_ERROR_HOMING_INPUT_MISCONFIGURED));
     }
-    if (fp_ZERO(cm->a[axis].search_velocity)) {
+    if (fp_ZERO(cm->config->a[axis].search_velocity)) {
         return (_homing_error_exit(axis, STAT_HOMING_ERROR_ZERO_SEARCH_VELOCITY));
     }
-    if (fp_ZERO(cm->a[axis].latch_velocity)) {
+    if (fp_ZERO(cm->config->a[axis].latch_velocity)) {
         return (_homing_error_exit(axis, STAT_HOMING_ERROR_ZERO_LATCH_VELOCITY));
     }
 
     // Calculate and test travel distance
     float travel_distance;
-    if ((fabs(cm->a[axis].travel_max - cm->a[axis].travel_min) < EPSILON) && (cm->a[axis].axis_mode == AXIS_RADIUS)) {
+    if ((fabs(cm->config->a[axis].travel_max - cm->config->a[axis].travel_min) < EPSILON) && (cm->config->a[axis].axis_mode == AXIS_RADIUS)) {
         // For cyclic rotary axes, we set the travel distance to one full rotation
         travel_distance = 360.0;
     } else {
         // All other axes use a calculated value
-        travel_distance = std::abs(cm->a[axis].travel_max - cm->a[axis].travel_min) + cm->a[axis].latch_backoff;
+        travel_distance = std::abs(cm->config->a[axis].travel_max - cm->config->a[axis].travel_min) + cm->config->a[axis].latch_backoff;
     }
     if (fp_ZERO(travel_distance)) {
         return (_homing_error_exit(axis, STAT_HOMING_ERROR_TRAVEL_MIN_MAX_IDENTICAL));
@@ -297,30 +297,30 @@ static stat_t _homing_axis_start(int8_t axis) {
 
     // Nothing to do about direction now that direction is explicit
     // However, here's a good place to stash the homing_switch:
-    hm.homing_input = cm->a[axis].homing_input;
+    hm.homing_input = cm->config->a[axis].homing_input;
     din_handlers[INPUT_ACTION_INTERNAL].registerHandler(&_homing_handler);
 
     hm.axis            = axis;                                  // persist the axis
-    hm.search_velocity = std::abs(cm->a[axis].search_velocity);     // search velocity is always positive
-    hm.latch_velocity  = std::abs(cm->a[axis].latch_velocity);      // latch velocity is always positive
+    hm.search_velocity = std::abs(cm->config->a[axis].search_velocity);     // search velocity is always positive
+    hm.latch_velocity  = std::abs(cm->config->a[axis].latch_velocity);      // latch velocity is always positive
 
-    bool homing_to_max = cm->a[axis].homing_dir;
+    bool homing_to_max = cm->config->a[axis].homing_dir;
 
     // setup parameters for positive or negative travel (homing to the max or min switch)
     if (homing_to_max) {
         hm.search_travel = travel_distance;                     // search travels in positive direction
-        hm.latch_backoff = std::abs(cm->a[axis].latch_backoff);     // latch travels in positive direction
-        hm.zero_backoff  = -std::max(0.0f, cm->a[axis].zero_backoff);// zero backoff is negative direction (or zero)
+        hm.latch_backoff = std::abs(cm->config->a[axis].latch_backoff);     // latch travels in positive direction
+        hm.zero_backoff  = -std::max(0.0f, cm->config->a[axis].zero_backoff);// zero backoff is negative direction (or zero)
                                                                 // will set the maximum position
                                                                 //     (plus any negative backoff)
-        hm.setpoint = cm->a[axis].travel_max + (std::max(0.0f, -cm->a[axis].zero_backoff));
+        hm.setpoint = cm->config->a[axis].travel_max + (std::max(0.0f, -cm->config->a[axis].zero_backoff));
     } else {
         hm.search_travel = -travel_distance;                    // search travels in negative direction
-        hm.latch_backoff = -std::abs(cm->a[axis].latch_backoff);    // latch travels in negative direction
-        hm.zero_backoff  = std::max(0.0f, cm->a[axis].zero_backoff); // zero backoff is positive direction (or zero)
+        hm.latch_backoff = -std::abs(cm->config->a[axis].latch_backoff);    // latch travels in negative direction
+        hm.zero_backoff  = std::max(0.0f, cm->config->a[axis].zero_backoff); // zero backoff is positive direction (or zero)
                                                                 // will set the minimum position
                                                                 //     (minus any negative backoff)
-        hm.setpoint = cm->a[axis].travel_min + (std::max(0.0f, -cm->a[axis].zero_backoff));
+        hm.setpoint = cm->config->a[axis].travel_min + (std::max(0.0f, -cm->config->a[axis].zero_backoff));
     }
 
     // if homing is disabled for the axis then skip to the next axis
@@ -339,7 +339,7 @@ static stat_t _homing_axis_clear_init(int8_t axis)  // first clear move
 
         // determine if the input switch for this axis is shared w/other axes
         for (uint8_t check_axis = AXIS_X; check_axis < AXES; check_axis++) {
-            if (axis != check_axis && cm->a[check_axis].homing_input == hm.homing_input) {
+            if (axis != check_axis && cm->config->a[check_axis].homing_input == hm.homing_input) {
                 return (_homing_error_exit(
                     axis, STAT_HOMING_ERROR_MUST_CLEAR_SWITCHES_BEFORE_HOMING));  // axis cannot be homed
             }
@@ -0,0 +1,926 @@
+/*
+ * sd_job.cpp - compiled Gcode jobs run from the SD card
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2019 Robert Giseburt
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "binary_parser.h"
+#include "planner.h"
+#include "report.h"
+#include "util.h"
+#include "xio.h"
+#include "ff.h"
+
+#include "sd_persistence.h"
+#include "sd_job.h"
+
+#include <stddef.h>   // offsetof
+
+#define JOB_BUFFER_SIZE (2*RX_BUFFER_SIZE)  // holds at least one whole line or frame past the read point
+#define JOB_MAX_FRAME (255 + BINARY_FRAME_OVERHEAD)
+#define JOB_CHAINED 0x80000000              // sdJobMove link: the frame follows the linked one
+
+// Analogous to ritorno(a), but for the FatFS return codes
+#define fs_ritorno(a) if ((a) != FR_OK) { return (STAT_SD_CARD_ERROR); }
+
+#if (AXES == 9)
+static const char _axis_letters[] = "XYZUVWABC";    // in cmAxes order
+#else
+static const char _axis_letters[] = "XYZABC";
+#endif
+
+/***********************************************************************************
+ **** STRUCTURE ALLOCATIONS ********************************************************
+ ***********************************************************************************/
+
+struct sdJobHeader {                // job file header - written little-endian, as on the ARM
+    char magic[4];                  // SD_JOB_MAGIC
+    uint16_t version;               // SD_JOB_VERSION
+    uint16_t header_size;           // sizeof(sdJobHeader) when written
+    uint32_t config_hash;           // _config_hash() of the machine it was compiled for
+    uint32_t body_size;             // bytes following the header
+    uint32_t body_crc;              // crc32() of the body
+};
+
+// Plan fields of a frame while the job is being planned - see "Planning", below
+struct sdJobMove {
+    float length;                   // line length in mm
+    float jerk;                     // bf->jerk of the line
+    float cruise;                   // fastest cruise at 100% override - min(absolute_vmax, cruise_vset)
+    float exit;                     // compiled: the entry limit at the junction with the linked frame
+                                    // back-planned: the exit velocity
+    uint32_t link;                  // file offset of the previous planned frame's fields, 0 if none,
+                                    //   or'd with JOB_CHAINED if this frame follows it
+};
+
+struct sdJob : xio_line_source {
+    sdJobState state = SD_JOB_IDLE;
+    FIL in;                         // Gcode being compiled, or the job being planned, validated or run
+    FIL out;                        // job being compiled
+    sdJobHeader header;
+    char job_path[sizeof(SD_JOB_DIR "/12345678" SD_JOB_EXTENSION)];
+
+    uint32_t size;                  // body bytes written or validated so far
+    uint32_t crc;                   // crc32() of those bytes
+
+    bool metric;                    // compiler: G21 is known to be in effect
+    int8_t motion;                  // compiler: modal motion mode 0-3, or -1 if not known
+    bool absolute;                  // compiler: G90 is known to be in effect
+    bool inverse_time;              // compiler: G93 is in effect
+    float feed_rate;                // compiler: modal F in mm/min, or 0 if not known
+    uint16_t known;                 // compiler: axes whose position is known
+    float position[AXES];           // compiler: position at the end of the last line
+    bool chained;                   // compiler: the last line was a planned frame
+
+    mpBuf_t move[2];                // planner scratch blocks - the last planned frame and the next
+    uint8_t last;                   // move[] index of the last planned frame
+    uint32_t last_plan;             // compiler: file offset of the last planned frame's fields, or 0
+                                    // back-planning: the next frame to plan, or 0 when done
+    float exit_limit;               // planning: limit on the exit of the frame being planned
+    bool limited;                   // planning: exit_limit applies (the frames are chained)
+
+    char buf[JOB_BUFFER_SIZE+1];    // read buffer - lines are returned in place (+1 to terminate the last)
+    uint16_t head;                  // next unread byte
+    uint16_t tail;                  // end of the bytes read
+    bool eof;                       // nothing left to read from the file
+
+    const char *readline(bool control_only, uint16_t &line_size) override;
+    bool isDone() override { return (state != SD_JOB_RUNNING); };
+    void close() override;
+};
+
+static sdJob job;
+
+static stat_t _end_job(const stat_t status);
+static stat_t _fill_buffer();
+static const char *_next_text_line(uint16_t &line_size);
+static stat_t _compile_lines();
+static stat_t _compile_line(char *line, uint16_t line_size);
+static void _track_modal_state(const char *line);
+static stat_t _write_body(const void *data, const uint16_t size);
+static stat_t _back_plan_moves();
+static stat_t _forward_plan_moves();
+static stat_t _finish_job();
+static stat_t _validate_sectors();
+static uint32_t _config_hash();
+static stat_t _make_job_path(const char *name);
+static bool _read_number(const char *&p, float &value, int32_t &int_part);
+#ifdef __BINARY_MOTION
+static uint16_t _compile_frame(const char *line, uint8_t *frame);
+static bool _plan_frame(const uint8_t opcode, const uint16_t axis_mask, const float target[], sdJobMove &move);
+static stat_t _fit_frame(uint8_t *frame);
+#endif
+static GCodeState_t _plan_gm;       // modal state of the planner scratch blocks
+
+/***********************************************************************************
+ **** CODE *************************************************************************
+ ***********************************************************************************/
+
+/*
+ * sd_job_compile() - start compiling a Gcode file into a job       {jobc:"PART.NC"}
+ * sd_job_run()     - start validating and running a compiled job   {jobr:"PART.NC"}
+ * sd_job_get_state()                                               {job:n}
+ */
+
+stat_t sd_job_compile(nvObj_t *nv)
+{
+    if ((job.state != SD_JOB_IDLE) || (cm->cycle_type != CYCLE_NONE)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    ritorno(_make_job_path(*nv->stringp));
+    ritorno(sd_mount_volume());
+    fs_ritorno(f_open(&job.in, *nv->stringp, FA_READ | FA_OPEN_EXISTING));
+    f_mkdir(SD_JOB_DIR);
+    if (f_open(&job.out, job.job_path, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        f_close(&job.in);
+        return (STAT_SD_CARD_ERROR);
+    }
+
+    memset(&job.header, 0, sizeof(job.header));     // placeholder - rewritten when done
+    UINT bw;
+    if ((f_write(&job.out, &job.header, sizeof(job.header), &bw) != FR_OK) || (bw != sizeof(job.header))) {
+        return (_end_job(STAT_SD_CARD_ERROR));
+    }
+    job.size = 0;
+    job.crc = 0;
+    job.metric = false;                             // nothing is assumed about the modal state...
+    job.motion = -1;
+    job.absolute = false;
+    job.inverse_time = false;                       // ...but G94 (see _plan_frame())
+    job.feed_rate = 0;
+    job.known = 0;
+    memset(job.position, 0, sizeof(job.position));
+    job.chained = false;
+    job.last_plan = 0;
+    job.head = job.tail = 0;
+    job.eof = false;
+    job.state = SD_JOB_COMPILING;
+    return (STAT_OK);
+}
+
+stat_t sd_job_run(nvObj_t *nv)
+{
+    if ((job.state != SD_JOB_IDLE) || (cm->cycle_type != CYCLE_NONE)) {
+        return (STAT_COMMAND_NOT_ACCEPTED);
+    }
+    ritorno(_make_job_path(*nv->stringp));
+    ritorno(sd_mount_volume());
+    fs_ritorno(f_open(&job.in, job.job_path, FA_READ | FA_OPEN_EXISTING));
+
+    UINT br;
+    if ((f_read(&job.in, &job.header, sizeof(job.header), &br) != FR_OK) || (br != sizeof(job.header))) {
+        f_close(&job.in);
+        return (STAT_JOB_FILE_INVALID);
+    }
+    if ((strncmp(job.header.magic, SD_JOB_MAGIC, sizeof(job.header.magic)) != 0) ||
+        (job.header.version != SD_JOB_VERSION) ||
+        (job.header.header_size != sizeof(job.header)) ||
+        (job.header.config_hash != _config_hash()) ||
+        (job.header.body_size != f_size(&job.in) - sizeof(job.header))) {
+        f_close(&job.in);
+        return (STAT_JOB_FILE_INVALID);
+    }
+    job.size = 0;
+    job.crc = 0;
+    job.state = SD_JOB_VALIDATING;
+    return (STAT_OK);
+}
+
+stat_t sd_job_get_state(nvObj_t *nv)
+{
+    nv->value_int = job.state;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+/*
+ * sd_job_periodic() - compile or validate a little more - called from hardware_periodic()
+ *
+ *  Running needs no help from here - the controller pulls lines through xio.
+ */
+
+stat_t sd_job_periodic()
+{
+    switch (job.state) {
+        case SD_JOB_COMPILING:          { return (_compile_lines()); }
+        case SD_JOB_BACK_PLANNING:      { return (_back_plan_moves()); }
+        case SD_JOB_FORWARD_PLANNING:   { return (_forward_plan_moves()); }
+        case SD_JOB_VALIDATING:         { return (_validate_sectors()); }
+        default:                        { return (STAT_NOOP); }
+    }
+}
+
+/*
+ * _end_job() - close the files and go idle, reporting status if it's an error
+ *
+ *  A compile that fails leaves no job file behind.
+ */
+
+static stat_t _end_job(const stat_t status)
+{
+    bool compiling = (job.state != SD_JOB_VALIDATING) && (job.state != SD_JOB_RUNNING);
+
+    if (f_is_open(&job.in)) {
+        f_close(&job.in);
+    }
+    if (f_is_open(&job.out)) {
+        f_close(&job.out);
+    }
+    if (compiling && (status != STAT_OK)) {
+        f_unlink(job.job_path);
+    }
+    job.state = SD_JOB_IDLE;
+    return (rpt_exception(status, job.job_path));
+}
+
+/*
+ * _make_job_path() - "PART.NC" -> "jobs/PART.G2J"
+ */
+
+static stat_t _make_job_path(const char *name)
+{
+    if (strlen(name) > SD_JOB_NAME_LEN) {
+        return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
+    }
+    const char *base = strrchr(name, '/');          // drop any directory
+    base = (base == nullptr) ? name : base+1;
+    uint8_t len = 0;
+    while ((base[len] != NUL) && (base[len] != '.') && (len < 8)) {
+        len++;
+    }
+    if (len == 0) {
+        return (STAT_INPUT_VALUE_RANGE_ERROR);
+    }
+    strcpy(job.job_path, SD_JOB_DIR "/");
+    strncat(job.job_path, base, len);
+    strcat(job.job_path, SD_JOB_EXTENSION);
+    return (STAT_OK);
+}
+
+/*
+ * _config_hash() - hash of the machine configuration that compiled jobs depend on
+ *
+ *  Frames carry an axis mask, and axis values are interpreted according to the axis
+ *  modes, so a job only runs on a machine with the same axes set up the same way. The
+ *  stored plans follow from the velocity, jerk and cornering limits and the planning mode,
+ *  so changing any of those means recompiling too.
+ */
+
+static uint32_t _config_hash()
+{
+    uint32_t hash = crc32(0, _axis_letters, AXES);
+    for (uint8_t axis=0; axis<AXES; axis++) {
+        const cfgAxis_t *a = &cm->config->a[axis];
+        uint8_t mode = a->axis_mode;
+        hash = crc32(hash, &mode, sizeof(mode));
+        const float limits[] = { a->velocity_max, a->feedrate_max, a->jerk_max, a->jerk_high, a->max_junction_accel };
+        hash = crc32(hash, limits, sizeof(limits));
+    }
+    const float multiplier = JERK_MULTIPLIER;
+    hash = crc32(hash, &multiplier, sizeof(multiplier));
+    hash = crc32(hash, &cm->gmx.planning_mode, sizeof(cm->gmx.planning_mode));
+    return (hash);
+}
+
+/***********************************************************************************
+ * Reading
+ *
+ *  The file is read into job.buf a sector or so at a time. Lines (and frames) are
+ *  returned in place, so each one must fit in the buffer past the read point.
+ */
+
+static stat_t _fill_buffer()
+{
+    if (job.eof || ((job.tail - job.head) >= (JOB_BUFFER_SIZE / 2))) {
+        return (STAT_OK);
+    }
+    memmove(job.buf, job.buf + job.head, job.tail - job.head);
+    job.tail -= job.head;
+    job.head = 0;
+
+    UINT br;
+    fs_ritorno(f_read(&job.in, job.buf + job.tail, JOB_BUFFER_SIZE - job.tail, &br));
+    job.tail += br;
+    job.eof = f_eof(&job.in);
+    return (STAT_OK);
+}
+
+// returns the next LF terminated line (without the LF), nullptr at end of file or on error
+static const char *_next_text_line(uint16_t &line_size)
+{
+    line_size = 0;
+    if (_fill_buffer() != STAT_OK) {
+        return (nullptr);
+    }
+    const char *line = job.buf + job.head;
+    uint16_t available = job.tail - job.head;
+    const char *lf = (const char *)memchr(line, LF, available);
+
+    if (lf != nullptr) {
+        line_size = lf - line;
+        job.head += line_size + 1;
+    } else if (job.eof && (available > 0)) {        // last line has no LF
+        line_size = available;
+        job.head = job.tail;
+    } else {
+        return (nullptr);                           // end of file, or a line too long to buffer
+    }
+    return (line);
+}
+
+/*
+ * readline() - next line or frame of a running job, for xio
+ *
+ *  Jobs carry no control characters, so control-only reads get nothing. Any read
+ *  error or malformed body ends the job. Motion already queued runs out and stops,
+ *  just as if the host had stopped sending.
+ */
+
+const char *sdJob::readline(bool control_only, uint16_t &line_size)
+{
+    line_size = 0;
+    if (control_only || (state != SD_JOB_RUNNING)) {
+        return (nullptr);
+    }
+    if (_fill_buffer() != STAT_OK) {
+        _end_job(STAT_SD_CARD_ERROR);
+        return (nullptr);
+    }
+    if (head == tail) {
+        if (eof) {
+            _end_job(STAT_OK);                      // all done
+        }
+        return (nullptr);
+    }
+
+    const char *line = buf + head;
+    if (*line == STX) {                             // frames are sized, not terminated
+        uint16_t frame_size = ((tail - head) >= 2) ? (uint8_t)line[1] + BINARY_FRAME_OVERHEAD : JOB_MAX_FRAME+1;
+        if (frame_size > (tail - head)) {
+            _end_job(STAT_JOB_FILE_INVALID);        // truncated - the buffer always holds a whole frame
+            return (nullptr);
+        }
+        line_size = frame_size;
+        head += frame_size;
+        return (line);
+    }
+    if ((line = _next_text_line(line_size)) == nullptr) {
+        _end_job(STAT_JOB_FILE_INVALID);
+    }
+    return (line);
+}
+
+void sdJob::close()
+{
+    if (state == SD_JOB_RUNNING) {                  // flushed or killed before the end
+        _end_job(STAT_OK);
+    }
+}
+
+/***********************************************************************************
+ * Validating
+ */
+
+static stat_t _validate_sectors()
+{
+    UINT br;
+    for (uint8_t i=0; i<SD_JOB_SECTORS_PER_PASS; i++) {
+        if (f_read(&job.in, job.buf, JOB_BUFFER_SIZE, &br) != FR_OK) {
+            return (_end_job(STAT_SD_CARD_ERROR));
+        }
+        job.crc = crc32(job.crc, job.buf, br);
+        job.size += br;
+        if (br < JOB_BUFFER_SIZE) {
+            break;
+        }
+    }
+    if (!f_eof(&job.in)) {
+        return (STAT_EAGAIN);
+    }
+    if ((job.size != job.header.body_size) || (job.crc != job.header.body_crc)) {
+        return (_end_job(STAT_JOB_FILE_INVALID));
+    }
+    if (f_lseek(&job.in, sizeof(job.header)) != FR_OK) {
+        return (_end_job(STAT_SD_CARD_ERROR));
+    }
+    job.head = job.tail = 0;
+    job.eof = false;
+    job.state = SD_JOB_RUNNING;
+    xio_send_source(job);
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * Compiling
+ */
+
+static stat_t _compile_lines()
+{
+    uint16_t line_size;
+    char *line;
+
+    for (uint8_t i=0; i<SD_JOB_LINES_PER_PASS; i++) {
+        if ((line = (char *)_next_text_line(line_size)) == nullptr) {
+            if (!job.eof || (job.head != job.tail)) {
+                return (_end_job(STAT_INPUT_EXCEEDS_MAX_LENGTH));    // a line didn't fit the buffer
+            }
+            break;
+        }
+        ritorno(_compile_line(line, line_size));
+    }
+    if (!job.eof || (job.head != job.tail)) {
+        return (STAT_EAGAIN);
+    }
+
+    // done - reopen the job to plan it in place
+    job.header.body_size = job.size;
+    f_close(&job.in);
+    if ((f_close(&job.out) != FR_OK) ||
+        (f_open(&job.in, job.job_path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)) {
+        return (_end_job(STAT_SD_CARD_ERROR));
+    }
+    job.limited = false;
+    job.state = SD_JOB_BACK_PLANNING;
+    return (STAT_EAGAIN);
+}
+
+static stat_t _write_body(const void *data, const uint16_t size)
+{
+    UINT bw;
+    if ((f_write(&job.out, data, size, &bw) != FR_OK) || (bw != size)) {
+        return (_end_job(STAT_SD_CARD_ERROR));
+    }
+    job.crc = crc32(job.crc, data, size);
+    job.size += size;
+    return (STAT_OK);
+}
+
+static stat_t _compile_line(char *line, uint16_t line_size)
+{
+    while ((line_size > 0) && ((line[line_size-1] == CR) || (line[line_size-1] == SPC) || (line[line_size-1] == TAB))) {
+        line_size--;
+    }
+    while ((line_size > 0) && ((*line == SPC) || (*line == TAB))) {
+        line++;
+        line_size--;
+    }
+    if (line_size == 0) {
+        return (STAT_OK);
+    }
+    if (line_size > RX_BUFFER_SIZE-2) {
+        return (_end_job(STAT_INPUT_EXCEEDS_MAX_LENGTH));
+    }
+    if (strchr("!~%", *line) || (*line == EOT) || (*line == ENQ) || (*line == CAN) || (*line == STX)) {
+        return (STAT_OK);                           // controls don't belong in a job
+    }
+    char saved = line[line_size];                   // terminate in place for parsing (the LF or the buffer end)
+    line[line_size] = NUL;
+
+#ifdef __BINARY_MOTION
+    uint8_t frame[JOB_MAX_FRAME];
+    uint16_t frame_size = _compile_frame(line, frame);
+    if (frame_size > 0) {
+        line[line_size] = saved;
+        return (_write_body(frame, frame_size));
+    }
+#endif
+    _track_modal_state(line);
+    line[line_size] = LF;
+    stat_t status = _write_body(line, line_size+1);
+    line[line_size] = saved;
+    return (status);
+}
+
+/*
+ * _read_number() - read a Gcode word value the way the Gcode parser does (no hex, no exponents)
+ *
+ *  int_part is the integer part, exact where the float is not (line numbers above 8,388,608)
+ */
+
+static bool _read_number(const char *&p, float &value, int32_t &int_part)
+{
+    char *end = (char *)p;
+    value = atonum(end, int_part);
+    if (end == p) {
+        return (false);
+    }
+    p = end;
+    return (true);
+}
+
+/*
+ * _track_modal_state() - follow the modal state through lines copied as text
+ *
+ *  Only what decides whether later lines can become frames, and whether those can be
+ *  planned: G20/G21, the motion mode, G90/G91, G93/G94, the feed rate, and M2/M30, which
+ *  reset them all. Any axis word, or any G code that might move or shift the coordinates,
+ *  loses the position. Comments are skipped.
+ */
+
+static bool _keeps_position(const float g)
+{
+    static const float harmless[] = { 4, 17, 18, 19, 20, 21, 40, 61, 61.1, 64, 80, 90, 91, 93, 94 };
+    for (float h : harmless) {
+        if (g == h) {
+            return (true);
+        }
+    }
+    return (false);
+}
+
+static void _track_modal_state(const char *line)
+{
+    job.chained = false;                            // the planner plans across text lines on its own
+    while (*line != NUL) {
+        char c = toupper(*line++);
+        if (c == '(') {
+            while ((*line != NUL) && (*line++ != ')'));
+            continue;
+        }
+        if (c == ';') {
+            return;
+        }
+        if (strchr(_axis_letters, c) != nullptr) {
+            job.known = 0;
+            continue;
+        }
+        if ((c != 'G') && (c != 'M') && (c != 'F')) {
+            continue;
+        }
+        float value;
+        int32_t int_part;
+        if (!_read_number(line, value, int_part)) {
+            continue;
+        }
+        if (c == 'F') {
+            job.feed_rate = (job.metric && !job.inverse_time) ? value : 0;
+        } else if (c == 'M') {
+            if ((value == 2) || (value == 30)) {
+                job.metric = false;
+                job.motion = -1;
+                job.absolute = false;
+                job.inverse_time = false;
+                job.feed_rate = 0;
+                job.known = 0;
+            }
+        } else {
+            if (!_keeps_position(value)) {
+                job.known = 0;
+            }
+            if (value == 21) {
+                job.metric = true;
+            } else if (value == 20) {
+                job.metric = false;
+                job.feed_rate = 0;
+            } else if (value == 90) {
+                job.absolute = true;
+            } else if (value == 91) {
+                job.absolute = false;
+            } else if ((value == 93) || (value == 94)) {
+                job.inverse_time = (value == 93);
+                job.feed_rate = 0;
+            } else if ((value == 0) || (value == 1) || (value == 2) || (value == 3)) {
+                job.motion = (int8_t)value;
+            } else if (((value >= 38) && (value < 39)) || ((value >= 80) && (value < 90))) {
+                job.motion = -1;                    // probing and canned cycles are motion modes too
+            }
+        }
+    }
+}
+
+#ifdef __BINARY_MOTION
+/*
+ * _compile_frame() - convert a simple G0-G3 block to a binary motion frame
+ *
+ *  Returns the frame size, or 0 if the line has to stay text. G0/G1 frames that can be
+ *  planned carry sdJobMove fields in their plan slots until the job is planned.
+ */
+
+static uint16_t _compile_frame(const char *line, uint8_t *frame)
+{
+    float target[AXES];
+    float offset[3];
+    uint16_t axis_mask = 0;
+    uint8_t offset_mask = 0;
+    uint8_t flags = 0;
+    int8_t opcode = -1;
+    uint32_t linenum = 0;
+    float feed_rate = 0;
+    float radius = 0;
+
+    if (!job.metric) {
+        return (0);
+    }
+    while (*line != NUL) {
+        char c = toupper(*line++);
+        if ((c == SPC) || (c == TAB)) {
+            continue;
+        }
+        float value;
+        int32_t int_part;
+        if (!_read_number(line, value, int_part)) {           // comments, block deletes and anything else
+            return (0);
+        }
+
+        const char *axis = strchr(_axis_letters, c);
+        if (axis != nullptr) {
+            uint8_t a = axis - _axis_letters;
+            if (axis_mask & (1 << a)) { return (0); }
+            axis_mask |= (1 << a);
+            target[a] = value;
+        } else if ((c >= 'I') && (c <= 'K')) {
+            uint8_t i = c - 'I';
+            if (offset_mask & (1 << i)) { return (0); }
+            offset_mask |= (1 << i);
+            offset[i] = value;
+        } else if ((c == 'G') && (opcode < 0) && ((value == 0) || (value == 1) || (value == 2) || (value == 3))) {
+            opcode = (int8_t)value;
+        } else if ((c == 'N') && !(flags & BINARY_HAS_LINENUM) && (value >= 0)) {
+            linenum = int_part;                     // floats lose line numbers above 8,388,608
+            flags |= BINARY_HAS_LINENUM;
+        } else if ((c == 'F') && !(flags & BINARY_HAS_FEED)) {
+            feed_rate = value;
+            flags |= BINARY_HAS_FEED;
+        } else if ((c == 'R') && !(flags & BINARY_HAS_RADIUS)) {
+            radius = value;
+            flags |= BINARY_HAS_RADIUS;
+        } else {
+            return (0);
+        }
+    }
+    if (opcode < 0) {
+        opcode = job.motion;                        // modal motion
+    }
+    if ((opcode < 0) || (axis_mask == 0)) {
+        return (0);
+    }
+    bool arc = (opcode >= BINARY_OP_G2);
+    if (!arc && (offset_mask || (flags & BINARY_HAS_RADIUS))) {
+        return (0);
+    }
+    if (arc && !offset_mask && !(flags & BINARY_HAS_RADIUS)) {
+        return (0);
+    }
+    job.motion = opcode;
+    if ((flags & BINARY_HAS_FEED) && !job.inverse_time) {
+        job.feed_rate = feed_rate;
+    }
+    sdJobMove move;
+    if (_plan_frame(opcode, axis_mask, target, move)) {
+        flags |= BINARY_HAS_PLAN;
+    }
+
+    // assemble the frame - see binary_parser.h
+    uint8_t *p = frame + 2;
+    *p++ = opcode;
+    *p++ = flags;
+    *p++ = axis_mask & 0xFF;
+    *p++ = axis_mask >> 8;
+    if (flags & BINARY_HAS_LINENUM) { memcpy(p, &linenum, 4); p += 4; }
+    if (flags & BINARY_HAS_FEED)    { memcpy(p, &feed_rate, 4); p += 4; }
+    for (uint8_t a=0; a<AXES; a++) {
+        if (axis_mask & (1 << a)) { memcpy(p, &target[a], 4); p += 4; }
+    }
+    if (arc) {
+        *p++ = offset_mask;
+        for (uint8_t i=0; i<3; i++) {
+            if (offset_mask & (1 << i)) { memcpy(p, &offset[i], 4); p += 4; }
+        }
+        if (flags & BINARY_HAS_RADIUS) { memcpy(p, &radius, 4); p += 4; }
+    } else if (flags & BINARY_HAS_PLAN) {
+        job.last_plan = sizeof(job.header) + job.size + (p - frame);    // where the frame will be written
+        memcpy(p, &move, BINARY_PLAN_LEN);
+        p += BINARY_PLAN_LEN;
+    }
+    uint8_t length = p - (frame + 2);
+    frame[0] = STX;
+    frame[1] = length;
+    uint32_t crc = crc32(0, &frame[1], length+1);
+    memcpy(p, &crc, BINARY_FRAME_CRC_LEN);
+    return (length + BINARY_FRAME_OVERHEAD);
+}
+
+/*
+ * _plan_frame() - follow the position through a frame, and set up its plan fields if it can be planned
+ *
+ *  A G0/G1 frame can be planned if its start point is known, it is not inverse time, and
+ *  for G1 the feed rate is known. It is chained to the frame before if that was planned
+ *  too and nothing came between them. The planner scratch blocks use GCodeState_t defaults
+ *  but for the feed rate mode and path control, which the frames are known to run with.
+ */
+
+static bool _plan_frame(const uint8_t opcode, const uint16_t axis_mask, const float target[], sdJobMove &move)
+{
+    bool known = job.absolute && ((job.known & axis_mask) == axis_mask);
+    bool chained = job.chained;
+    float start[AXES];
+
+    copy_vector(start, job.position);
+    for (uint8_t a=0; a<AXES; a++) {
+        if (axis_mask & (1 << a)) {
+            job.position[a] = target[a];
+        }
+    }
+    job.known = job.absolute ? (job.known | axis_mask) : 0;
+    job.chained = false;
+
+    if (!known || (opcode >= BINARY_OP_G2) || job.inverse_time ||
+        ((opcode == BINARY_OP_G1) && (job.feed_rate <= 0))) {
+        return (false);
+    }
+    _plan_gm.reset();
+    _plan_gm.feed_rate_mode = UNITS_PER_MINUTE_MODE;
+    _plan_gm.path_control = PATH_CONTINUOUS;
+
+    mpBuf_t *bf = &job.move[job.last ^ 1];
+    bf->reset();
+    bf->gm = &_plan_gm;
+    bf->motion_mode = (opcode == BINARY_OP_G0) ? MOTION_MODE_STRAIGHT_TRAVERSE : MOTION_MODE_STRAIGHT_FEED;
+    bf->feed_rate = job.feed_rate;
+    if (!mp_calculate_line(bf, start, job.position)) {
+        return (false);                             // too short to queue
+    }
+    move.length = bf->length;
+    move.jerk = bf->jerk;
+    move.cruise = std::min(bf->absolute_vmax, bf->cruise_vset);
+    move.exit = move.cruise;
+    move.link = job.last_plan;
+    if (chained) {
+        mpBuf_t *pv = &job.move[job.last];
+        pv->nx = bf;
+        mp_calculate_junction(pv);
+        move.exit = std::min(pv->exit_vmax, std::min(std::min(pv->absolute_vmax, pv->cruise_vset), move.cruise));
+        move.link |= JOB_CHAINED;
+    }
+    job.last ^= 1;
+    job.chained = true;
+    return (true);
+}
+#endif // __BINARY_MOTION
+
+/***********************************************************************************
+ * Planning
+ *
+ *  The compiler leaves sdJobMove fields in the plan slots of the frames it can plan, each
+ *  linked to the planned frame before it. Back-planning follows the links from the last
+ *  one, as _plan_block() would with the whole job queued, and leaves each frame's exit
+ *  velocity in place of its entry limit. Forward planning then reads the body from the
+ *  start, as mp_calculate_ramps() would run it, fits the ramps with mp_fit_ramps(), and
+ *  replaces the fields with the mpStoredPlan_t. The body CRC covers the finished frames,
+ *  so the header is written last.
+ */
+
+static stat_t _back_plan_moves()
+{
+    mpBuf_t *bf = &job.move[0];
+    sdJobMove move;
+    UINT bx;
+
+    for (uint8_t i=0; i<SD_JOB_MOVES_PER_PASS; i++) {
+        if (job.last_plan == 0) {                   // done - plan forward from the start
+            if (f_lseek(&job.in, sizeof(job.header)) != FR_OK) {
+                return (_end_job(STAT_SD_CARD_ERROR));
+            }
+            job.size = 0;
+            job.crc = 0;
+            job.head = job.tail = 0;
+            job.eof = false;
+            job.state = SD_JOB_FORWARD_PLANNING;
+            return (STAT_EAGAIN);
+        }
+        if ((f_lseek(&job.in, job.last_plan) != FR_OK) ||
+            (f_read(&job.in, &move, sizeof(move), &bx) != FR_OK) || (bx != sizeof(move))) {
+            return (_end_job(STAT_SD_CARD_ERROR));
+        }
+        float exit_velocity = job.limited ? job.exit_limit : move.cruise;  // the end of a chain is left to the planner
+        bf->length = move.length;
+        mp_set_jerk(bf, move.jerk);
+        job.exit_limit = std::min(move.exit, mp_get_target_velocity(exit_velocity, move.length, bf));
+        job.limited = (move.link & JOB_CHAINED);
+
+        if ((f_lseek(&job.in, job.last_plan + offsetof(sdJobMove, exit)) != FR_OK) ||
+            (f_write(&job.in, &exit_velocity, sizeof(exit_velocity), &bx) != FR_OK) || (bx != sizeof(exit_velocity))) {
+            return (_end_job(STAT_SD_CARD_ERROR));
+        }
+        job.last_plan = move.link & ~JOB_CHAINED;
+    }
+    return (STAT_EAGAIN);
+}
+
+static stat_t _forward_plan_moves()
+{
+    for (uint8_t i=0; i<SD_JOB_LINES_PER_PASS; i++) {
+        if (_fill_buffer() != STAT_OK) {
+            return (_end_job(STAT_SD_CARD_ERROR));
+        }
+        uint16_t available = job.tail - job.head;
+        if (available == 0) {
+            return (_finish_job());
+        }
+        char *item = job.buf + job.head;
+        uint16_t size;
+        if (*item == STX) {
+            size = (available >= 2) ? (uint8_t)item[1] + BINARY_FRAME_OVERHEAD : JOB_MAX_FRAME+1;
+            if (size > available) {
+                return (_end_job(STAT_JOB_FILE_INVALID));
+            }
+#ifdef __BINARY_MOTION
+            if ((item[3] & BINARY_HAS_PLAN) && (_fit_frame((uint8_t *)item) != STAT_OK)) {
+                return (_end_job(STAT_SD_CARD_ERROR));
+            }
+#endif
+        } else {
+            const char *lf = (const char *)memchr(item, LF, available);
+            if (lf == nullptr) {
+                return (_end_job(STAT_JOB_FILE_INVALID));
+            }
+            size = lf - item + 1;
+        }
+        job.crc = crc32(job.crc, item, size);
+        job.size += size;
+        job.head += size;
+    }
+    return (STAT_EAGAIN);
+}
+
+#ifdef __BINARY_MOTION
+// Replaces the plan fields of a frame in the buffer and in the file - job.size is the frame's body offset
+static stat_t _fit_frame(uint8_t *frame)
+{
+    static_assert(sizeof(sdJobMove) == BINARY_PLAN_LEN, "sdJobMove must fill the plan slots");
+    static_assert(sizeof(mpStoredPlan_t) == BINARY_PLAN_LEN, "mpStoredPlan_t must fill the plan slots");
+
+    uint8_t length = frame[1];
+    uint8_t *fields = frame + 2 + length - BINARY_PLAN_LEN;
+    mpBuf_t *bf = &job.move[0];
+    mpBlockRuntimeBuf_t block = {};
+    sdJobMove move;
+
+    memcpy(&move, fields, sizeof(move));
+    float entry_velocity = (move.link & JOB_CHAINED) ? job.exit_limit : move.cruise;
+    bf->length = move.length;
+    mp_set_jerk(bf, move.jerk);
+    block.cruise_velocity = move.cruise;
+    block.exit_velocity = std::min(move.exit, mp_get_target_velocity(entry_velocity, move.length, bf));
+    ritorno(mp_fit_ramps(&block, bf, entry_velocity));
+    job.exit_limit = block.exit_velocity;
+
+    mpStoredPlan_t plan = { entry_velocity, block.exit_velocity, block.cruise_velocity, block.head_length, block.tail_length };
+    memcpy(fields, &plan, sizeof(plan));
+    uint32_t crc = crc32(0, &frame[1], length+1);
+    memcpy(frame + 2 + length, &crc, BINARY_FRAME_CRC_LEN);
+
+    UINT bw;
+    uint32_t read_point = f_tell(&job.in);
+    fs_ritorno(f_lseek(&job.in, sizeof(job.header) + job.size + (fields - frame)));
+    fs_ritorno(f_write(&job.in, fields, BINARY_PLAN_LEN + BINARY_FRAME_CRC_LEN, &bw));
+    if (bw != BINARY_PLAN_LEN + BINARY_FRAME_CRC_LEN) {
+        return (STAT_SD_CARD_ERROR);
+    }
+    fs_ritorno(f_lseek(&job.in, read_point));
+    return (STAT_OK);
+}
+#endif // __BINARY_MOTION
+
+// all planned - write the real header and close
+static stat_t _finish_job()
+{
+    if (job.size != job.header.body_size) {
+        return (_end_job(STAT_JOB_FILE_INVALID));
+    }
+    memcpy(job.header.magic, SD_JOB_MAGIC, sizeof(job.header.magic));
+    job.header.version = SD_JOB_VERSION;
+    job.header.header_size = sizeof(job.header);
+    job.header.config_hash = _config_hash();
+    job.header.body_crc = job.crc;
+    UINT bw;
+    if ((f_lseek(&job.in, 0) != FR_OK) ||
+        (f_write(&job.in, &job.header, sizeof(job.header), &bw) != FR_OK) || (bw != sizeof(job.header))) {
+        return (_end_job(STAT_SD_CARD_ERROR));
+    }
+    return (_end_job(STAT_OK));
+}
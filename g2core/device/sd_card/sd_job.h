@@ -0,0 +1,82 @@
+/*
+ * sd_job.h - compiled Gcode jobs run from the SD card
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2019 Robert Giseburt
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A Gcode file uploaded to the SD card can be compiled once into a job file, then run
+ * from the card any number of times without the host link:
+ *
+ *    {jobc:"PART.NC"}    compile PART.NC into jobs/PART.G2J
+ *    {jobr:"PART.NC"}    validate jobs/PART.G2J and run it
+ *    {job:n}             0=idle, 1=compiling, 2=validating, 3=running, 4-5=planning
+ *
+ * Compiling converts every G0/G1/G2/G3 block that is known to be in G21 (mm) and has
+ * nothing but N, G, F, axis, IJK and R words into a binary motion frame (binary_parser.h),
+ * so runs skip the Gcode parser for the bulk of the file. All other lines are copied as
+ * text. Compiling and validating run a few lines or sectors per controller pass, so the
+ * controller keeps responding. Lines from a job get no responses, like flash files.
+ *
+ * The job file is a header (sdJobHeader) followed by the body - text lines ending in LF
+ * and frames, in file order. The header carries a format version, a hash of the machine
+ * configuration the frames and their plans depend on, and the size and crc32() of the
+ * body. A job that fails any of these checks is not run - recompile it from the Gcode.
+ *
+ * Once the body is written the whole file is planned, the way the planner would plan it
+ * at 100% override with every block queued at once: backward from the end of the file,
+ * then forward from the start. Each G0/G1 frame in a run of lines whose start points are
+ * known gets the velocities and ramp lengths of that plan (BINARY_HAS_PLAN). The planner
+ * can only brake within the blocks it has queued, so it still plans the job as it streams
+ * in, but it takes the stored velocities as upper bounds, which lets back-planning stop
+ * early, and reuses the stored ramps when its own velocities come out the same. Text lines
+ * and arcs break the runs - the planner plans across those on its own.
+ */
+
+#ifndef SD_JOB_H_ONCE
+#define SD_JOB_H_ONCE
+
+#define SD_JOB_DIR "jobs"
+#define SD_JOB_EXTENSION ".G2J"
+#define SD_JOB_MAGIC "G2J"          // including the NUL
+#define SD_JOB_VERSION 2            // bump when the body or header format changes
+#define SD_JOB_NAME_LEN 32          // longest Gcode file path accepted
+#define SD_JOB_LINES_PER_PASS 8     // Gcode lines compiled per controller pass
+#define SD_JOB_SECTORS_PER_PASS 4   // sectors validated per controller pass
+#define SD_JOB_MOVES_PER_PASS 8     // frames back-planned per controller pass
+
+typedef enum {
+    SD_JOB_IDLE = 0,
+    SD_JOB_COMPILING,               // reading Gcode, writing the job file
+    SD_JOB_VALIDATING,              // checking the body CRC before running
+    SD_JOB_RUNNING,                 // streaming the body to the controller
+    SD_JOB_BACK_PLANNING,           // planning the job file from the end...
+    SD_JOB_FORWARD_PLANNING         // ...and from the start, storing the plans and the header
+} sdJobState;
+
+stat_t sd_job_periodic();
+stat_t sd_job_get_state(nvObj_t *nv);
+stat_t sd_job_compile(nvObj_t *nv);
+stat_t sd_job_run(nvObj_t *nv);
+
+#endif  // End of include guard: SD_JOB_H_ONCE
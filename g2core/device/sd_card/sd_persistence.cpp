@@ -212,6 +212,20 @@ stat_t SD_Persistence::periodic()
    return STAT_NOOP;
 }
 
+/*
+ * sd_mount_volume()
+ *
+ * Mounts the card if it isn't already. The FATFS work area is shared by everything
+ *  on the card (persistence and SD jobs) - mounting again would invalidate open files.
+ */
+stat_t sd_mount_volume()
+{
+   if (!nvm.fat_fs.fs_type) {
+       fs_ritorno(f_mount(&nvm.fat_fs, "", 1), "mount");       /* Give a work area to the default drive */
+   }
+   return STAT_OK;
+}
+
 /*
  * active_file_index()
  *
@@ -249,10 +263,7 @@ stat_t prepare_persistence_file()
    // every use to ensure that the card status hasn't changed.
    if (f_is_open(&nvm.file) && validate(&nvm.file) == FR_OK) return STAT_OK;
 
-   // mount volume if necessary
-   if (!nvm.fat_fs.fs_type) {
-       fs_ritorno(f_mount(&nvm.fat_fs, "", 1), "mount");       /* Give a work area to the default drive */
-   }
+   ritorno(sd_mount_volume());
    f_mkdir(PERSISTENCE_DIR);
    uint8_t index = active_file_index();
    fs_ritorno(f_open(&nvm.file, filenames[index], FA_READ | FA_OPEN_EXISTING), "open input");
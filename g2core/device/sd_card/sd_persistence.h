@@ -30,5 +30,6 @@
 #define SD_PERSISTENCE_H_ONCE
 
 void setup_sd_persistence();
+stat_t sd_mount_volume();
 
 #endif  // End of include guard: SD_PERSISTENCE_H_ONCE
@@ -114,6 +114,11 @@ void en_take_encoder_snapshot() {
     */
 }
 
+// take a snapshot into the caller's vector (integer steps), leaving the shared snapshot alone
+void en_take_encoder_snapshot(int32_t snapshot[]) {
+    for (uint8_t m = 0; m < MOTORS; m++) { snapshot[m] = en.en[m].encoder_steps + en.en[m].steps_run; }
+}
+
 float en_get_encoder_snapshot_steps(uint8_t motor) { return (en.snapshot[motor]); }
 
 float* en_get_encoder_snapshot_vector() { return (en.snapshot); }
@@ -131,6 +131,7 @@ void en_set_encoder_steps(uint8_t motor, float steps);
 float en_read_encoder(uint8_t motor);
 
 void en_take_encoder_snapshot();
+void en_take_encoder_snapshot(int32_t snapshot[]);
 float en_get_encoder_snapshot_steps(uint8_t motor);
 float* en_get_encoder_snapshot_vector();
 
@@ -107,8 +107,8 @@ char *get_status_message(stat_t status);
 #define STAT_FAILED_GET_PLANNER_BUFFER 36
 
 #define STAT_ERROR_37 37
-#define STAT_ERROR_38 38
-#define STAT_ERROR_39 39
+#define STAT_JOB_FILE_INVALID 38
+#define STAT_SD_CARD_ERROR 39
 
 #define STAT_ERROR_40 40
 #define STAT_ERROR_41 41
@@ -417,8 +417,8 @@ static const char stat_35[] = "Bad status report setting";
 static const char stat_36[] = "Failed to get planner buffer";
 
 static const char stat_37[] = "Backplan hit running buffer";
-static const char stat_38[] = "38";
-static const char stat_39[] = "39";
+static const char stat_38[] = "Job file is invalid or was compiled for another configuration";
+static const char stat_39[] = "SD card read or write failed";
 
 static const char stat_40[] = "40";
 static const char stat_41[] = "41";
@@ -43,6 +43,9 @@
 #define __HELP_SCREENS              // enable help screens      (~3.5Kb)
 #define __USER_DATA                 // enable user defined data groups
 #define __STEP_CORRECTION           // enable virtual encoder step correction
+#define __BINARY_MOTION             // enable binary framed motion commands on xio (see binary_parser.h)
+#define __TELEMETRY                 // enable binary position telemetry on the secondary xio channel (see telemetry.h)
+#define __NATIVE_ARCS               // queue arcs as single arc blocks instead of chords (see mp_arc())
 
 /****** DEVELOPMENT SETTINGS ******/
 
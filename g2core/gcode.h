@@ -165,13 +165,13 @@ typedef enum {              // axis modes (ordered: see _cm_get_feed_time())
  *   (which may have changed).
  */
 
+// NB: queued blocks split this into per-move and shared modal fields. See mp_attach_gm()
 struct GCodeState_t {             // Gcode model state - used by model, planning and runtime
     int32_t linenum;                    // Gcode block line number
     cmMotionMode motion_mode;           // Group1: G0, G1, G2, G3, G38.2, G80, G81, G82
                                         //         G83, G84, G85, G86, G87, G88, G89
 
     float target[AXES];                 // XYZABC target where the move should go
-    float target_comp[AXES];            // summation compensation (Kahan) overflow value
     float display_offset[AXES];         // work offsets from the machine coordinate system (for reporting only)
 
     float feed_rate;                    // F - normalized to millimeters/minute or in inverse time mode
@@ -181,6 +181,7 @@ struct GCodeState_t {             // Gcode model state - used by model, planning
     cmCanonicalPlane select_plane;      // G17,G18,G19 - values to set plane to
     cmUnitsMode units_mode;             // G20,G21 - 0=inches (G20), 1 = mm (G21)
     cmPathControl path_control;         // G61... EXACT_PATH, EXACT_STOP, CONTINUOUS
+    float path_tolerance;               // G64 P - corner blending tolerance in mm, 0 = no blending
     cmDistanceMode distance_mode;       // G90=use absolute coords, G91=incremental movement
     cmDistanceMode arc_distance_mode;   // G90.1=use absolute IJK offsets, G91.1=incremental IJK offsets
     cmAbsoluteOverride absolute_override;// G53 TRUE = move using machine coordinates - this block only
@@ -208,6 +209,7 @@ struct GCodeState_t {             // Gcode model state - used by model, planning
         select_plane = CANON_PLANE_XY;
         units_mode = INCHES;
         path_control = PATH_EXACT_PATH;
+        path_tolerance = 0.0;
         distance_mode = ABSOLUTE_DISTANCE_MODE;
         arc_distance_mode = ABSOLUTE_DISTANCE_MODE;
         absolute_override = ABSOLUTE_OVERRIDE_OFF;
@@ -247,9 +249,13 @@ typedef struct GCodeStateExtended {     // Gcode dynamic state extensions - used
 /*
  * Global Scope Functions
  */
+struct xioLineView;                     // see xio.h
+
 void gcode_parser_init(void);
 stat_t gcode_parser(char* block);
+stat_t gcode_parser_line(const xioLineView &line);
 stat_t gc_get_gc(nvObj_t* nv);
+stat_t gc_get_gcn(nvObj_t* nv);
 stat_t gc_run_gc(nvObj_t* nv);
 
 #endif  // End of include guard: GCODE_H_ONCE
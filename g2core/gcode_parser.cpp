@@ -28,6 +28,7 @@
 #include "util.h"
 #include "xio.h"                    // for char definitions
 #include "json_parser.h"
+#include "report.h"
 
 #if MARLIN_COMPAT_ENABLED == true
 #include "marlin_compatibility.h"
@@ -217,11 +218,54 @@ GCodeParser_t gp;   // main parser struct
 GCodeValue_t gv;    // gcode input values
 GCodeFlag_t gf;     // gcode input flags
 
+/*
+ * gcLineReader - reads a Gcode block one character at a time from a line view
+ *
+ *  next() returns NUL at the end of the block or at a '*' that starts a checksum,
+ *  and keeps the checksum (XOR) of the characters it has returned.
+ */
+typedef struct gcLineReader {
+    const xioLineView &line;
+    uint16_t pos;                   // next character to read
+    uint16_t end;                   // end of the block - the size of the line, or where the '*' is
+    char checksum;                  // XOR of the characters read
+    bool has_checksum;              // true if the block ended at a '*'
+
+    gcLineReader(const xioLineView &_line) : line(_line), pos(0), end(_line.size()), checksum(0), has_checksum(false) {};
+
+    char peek(const uint16_t ahead = 0) const {
+        return (((pos + ahead) < end) ? line[pos + ahead] : NUL);
+    };
+
+    char next() {
+        if (pos >= end) {
+            return (NUL);
+        }
+        char c = line[pos];
+        if ((c == '*') || (c == NUL) || (c == '\n') || (c == '\r')) {
+            has_checksum = (c == '*');
+            end = pos;              // nothing past here is part of the block
+            return (NUL);
+        }
+        pos++;
+        checksum ^= c;
+        return (c);
+    };
+} gcLineReader;
+
+static char _gcode_block[RX_BUFFER_SIZE];       // normalized Gcode block
+static char _active_comment[RX_BUFFER_SIZE];    // normalized active comments of the block
+
+#ifdef __DIAGNOSTIC_PARAMETERS
+static uint32_t _normalize_bytes;               // raw bytes through _normalize_gcode_block()
+static uint64_t _normalize_cycles;              // CPU cycles spent in _normalize_gcode_block()
+#endif
+
 // local helper functions and macros
-static void _normalize_gcode_block(char *str, char **active_comment, uint8_t *block_delete_flag);
+static void _normalize_gcode_block(gcLineReader &rd, char **active_comment, uint8_t *block_delete_flag);
 static stat_t _get_next_gcode_word(char **pstr, char *letter, float *value, int32_t *value_int);
 static stat_t _point(float value);
-static stat_t _verify_checksum(char *str);
+static stat_t _verify_checksum(const gcLineReader &rd);
 static stat_t _validate_gcode_block(char *active_comment);
 static stat_t _parse_gcode_block(char *line, char *active_comment); // Parse the block into the GN/GF structs
 static stat_t _execute_gcode_block(char *active_comment);           // Execute the gcode block
@@ -238,32 +282,47 @@ void gcode_parser_init()
 {
     memset(&gv, 0, sizeof(GCodeValue_t));
     memset(&gf, 0, sizeof(GCodeFlag_t));
+#ifdef __DIAGNOSTIC_PARAMETERS
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // start the cycle counter for gc_get_gcn()
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
 }
 
 /*
- * gcode_parser() - parse a block (line) of gcode
+ * gcode_parser()      - parse a block (line) of gcode from a string
+ * gcode_parser_line() - parse a block (line) of gcode in place from a line view
  *
  *  Top level of gcode parser. Normalizes block and looks for special cases
+ *  The block is only read - the normalized block is built in _gcode_block
  */
 
 stat_t gcode_parser(char *block)
 {
-    char *str = block;                      // gcode command or NUL string
-    char none = NUL;
-    char *active_comment = &none;           // gcode comment or NUL string
-    uint8_t block_delete_flag;
+    xioLineView line = { block, (uint16_t)strlen(block), nullptr, 0 };
+    return (gcode_parser_line(line));
+}
 
-    stat_t check_ret = _verify_checksum(str);
-    if (check_ret != STAT_OK) {
-        return check_ret;
-    }
+stat_t gcode_parser_line(const xioLineView &line)
+{
+    char *str = _gcode_block;               // gcode command or NUL string
+    char *active_comment;                   // gcode comment or NUL string
+    uint8_t block_delete_flag;
+    gcLineReader rd(line);
 
-    _normalize_gcode_block(str, &active_comment, &block_delete_flag);
+#ifdef __DIAGNOSTIC_PARAMETERS
+    uint32_t start = DWT->CYCCNT;
+    _normalize_gcode_block(rd, &active_comment, &block_delete_flag);
+    _normalize_cycles += DWT->CYCCNT - start;
+    _normalize_bytes += line.size();
+#else
+    _normalize_gcode_block(rd, &active_comment, &block_delete_flag);
+#endif
+    ritorno(_verify_checksum(rd));
 
     // TODO, now MSG is put in the active comment, handle that.
 
     if (str[0] == NUL) {                    // normalization returned null string
-        if ((active_comment != nullptr) && (active_comment[0] == '{')) {
+        if (active_comment[0] == '{') {
             json_parser(active_comment);
         }
         return (STAT_OK);                   // most likely a comment line
@@ -279,48 +338,48 @@ stat_t gcode_parser(char *block)
     if (block_delete_flag == true) {
         return (STAT_NOOP);
     }
-    return(_parse_gcode_block(block, active_comment));
+    return(_parse_gcode_block(str, active_comment));
 }
 
 /*
  * _verify_checksum() - ensure that, if there is a checksum, that it's valid
  *
+ *  The reader has already stopped at the '*' and XORed every character before it.
+ *
  * Returns STAT_OK is it's valid.
  * Returns STAT_CHECKSUM_MATCH_FAILED if the checksum doesn't match.
  */
-static stat_t _verify_checksum(char *str)
+static stat_t _verify_checksum(const gcLineReader &rd)
 {
-    bool has_line_number = false; // -1 means we don't have one
-    if (*str == 'N') {
-        has_line_number = true;
+    if (!rd.has_checksum) {
+        return STAT_OK;
     }
+    gf.checksum = true;
 
-    char checksum = 0;
-    char c = *str++;
-    while (c && (c != '*') && (c != '\n') && (c != '\r')) {
-        checksum ^= c;
-        c = *str++;
+    char digits[12];                        // the checksum is the number after the '*'
+    uint8_t i = 0;
+    for (uint16_t pos = rd.end+1; (pos < rd.line.size()) && (i < sizeof(digits)-1); pos++) {
+        digits[i++] = rd.line[pos];
     }
+    digits[i] = NUL;
 
-    // c might be 0 here, in which case we didn't get a checksum and we return STAT_OK
-
-    if (c == '*') {
-        *(str-1) = 0; // null terminate, the parser won't like this * here!
-        gf.checksum = true;
-        if (strtol(str, NULL, 10) != checksum) {
-            debug_trap("checksum failure");
-            return STAT_CHECKSUM_MATCH_FAILED;
-        }
-        if (!has_line_number) {
-            debug_trap("line number missing with checksum");
-            return STAT_MISSING_LINE_NUMBER_WITH_CHECKSUM;
-        }
+    if (strtol(digits, NULL, 10) != rd.checksum) {
+        debug_trap("checksum failure");
+        return STAT_CHECKSUM_MATCH_FAILED;
+    }
+    if (rd.line[0] != 'N') {
+        debug_trap("line number missing with checksum");
+        return STAT_MISSING_LINE_NUMBER_WITH_CHECKSUM;
     }
     return STAT_OK;
 }
 
 /****************************************************************************************
- * _normalize_gcode_block() - normalize a block (line) of gcode in place
+ * _normalize_gcode_block() - normalize a block (line) of gcode into _gcode_block
+ * _normalize_comment()     - copy an active comment or message to _active_comment, or skip a comment
+ *
+ *  Normalization is a single streaming pass over the raw block, which may still be in
+ *  the RX buffer. Gcode goes to _gcode_block and active comments to _active_comment.
  *
  *  Baseline normalization functions:
  *   - Isolate comments. See below.
@@ -338,224 +397,154 @@ static stat_t _verify_checksum(char *str)
  *   - Semicolon ';' or percent '%' end the line. All characters past are discarded
  *   - Multiple embedded comments are acceptable if '(' form
  *   - Active comments start with exactly "({" and end with "})" (no relaxing, invalid is invalid)
- *   - Active comments are moved to the end of the string
- *   - Multiple active comments are merged and moved to the end of the string
+ *   - Multiple active comments are merged
  *   - Gcode message comments (MSG) are converted to ({msg:"blah"}) active comments
  *     - The 'MSG' specifier in comment can have mixed case but cannot cannot have embedded white spaces
  *     - Only ONE MSG comment will be accepted
  *   - Other "plain" comments are discarded
  *
  *  Returns:
- *   - com points to comment string or to NUL if no comment
- *   - msg points to message string or to NUL if no comment
+ *   - active_comment points to the active comment string or to NUL if no comment
  *   - block_delete_flag is set true if block delete encountered, false otherwise
  */
 /* Active comment notes:
  *
  *   We will convert as follows:
  *   FROM: G0 ({blah: t}) x10 (comment)
- *   TO  : g0x10\0{blah:t}
- *   NOTES: Active comments moved to the end, stripped of (), everything lowercased, and plain comment removed.
+ *   TO  : G0X10 and {blah:t}
+ *   NOTES: Active comments stripped of (), Gcode uppercased, and plain comment removed.
  *
  *   FROM: M100 ({a:t}) (comment) ({b:f}) (comment)
- *   TO  : m100\0{a:t,b:f}
+ *   TO  : M100 and {a:t,b:f}
  *   NOTES: multiple active comments merged, stripped of (), and actual comments ignored.
  */
 
-char _normalize_scratch[RX_BUFFER_SIZE];
-
-void _normalize_gcode_block(char *str, char **active_comment, uint8_t *block_delete_flag)
+static inline void _put_comment_char(char **ac_wr, const char c, const uint8_t reserve = 3)
 {
-    _normalize_scratch[0] = 0;
-
-    char *gc_rd = str;                  // read pointer
-    char *gc_wr = _normalize_scratch;   // write pointer
-    char *ac_rd = str;                  // Active Comment read pointer
-    char *ac_wr = _normalize_scratch;   // Active Comment write pointer
-    bool last_char_was_digit = false;   // used for octal stripping
+    if (*ac_wr < (_active_comment + sizeof(_active_comment) - reserve)) {   // by default leave room to close a msg: "} and NUL
+        *((*ac_wr)++) = c;
+    }
+}
 
-    // Move the ac_wr point forward one for every non-AC character we KEEP (plus one for a NULL in between)
-    ac_wr++;                            // account for the in-between NULL
+static void _normalize_comment(gcLineReader &rd, char **ac_wr)
+{
+    bool in_msg = false;
+    bool has_comment = (*ac_wr > _active_comment);
+    char c = rd.peek();
 
-    // mark block deletes
-    if (*gc_rd == '/') {
-        *block_delete_flag = true;
-        gc_rd++;
-    } else {
-        *block_delete_flag = false;
-    }
+    if (((c == 'm') || (c == 'M')) &&
+        ((rd.peek(1) == 's') || (rd.peek(1) == 'S')) &&
+        ((rd.peek(2) == 'g') || (rd.peek(2) == 'G'))) {
 
-    while (*gc_rd != 0) {
-        if ((*gc_rd == ';') || (*gc_rd == '%')) {   // check for ';' or '%' comments that end the line
-            *gc_rd = 0;                             // go ahead and snap the string off cleanly here
-            break;
+        rd.next(); rd.next(); rd.next();
+        if (rd.peek() == ' ') {
+            rd.next();                      // skip the first space.
+        }
+        if (has_comment && (*(*ac_wr-1) == '}')) {
+            *(*ac_wr-1) = ',';
+        } else {
+            _put_comment_char(ac_wr, '{');
+        }
+        _put_comment_char(ac_wr, 'm');
+        _put_comment_char(ac_wr, 's');
+        _put_comment_char(ac_wr, 'g');
+        _put_comment_char(ac_wr, ':');
+        _put_comment_char(ac_wr, '"');
+        in_msg = true;
+
+    } else if (c == '{') {
+        if (has_comment && (*(*ac_wr-1) == '}')) {  // merge json comments
+            *(*ac_wr-1) = ',';
+            rd.next();                      // don't copy the '{'
         }
 
-        // check for comment '('
-        else if (*gc_rd == '(') {
-            // We only care if it's a "({" in order to handle string-skipping properly
-            gc_rd++;
-            if ((*gc_rd == '{') || (((* gc_rd    == 'm') || (* gc_rd    == 'M')) &&
-                                    ((*(gc_rd+1) == 's') || (*(gc_rd+1) == 'S')) &&
-                                    ((*(gc_rd+2) == 'g') || (*(gc_rd+2) == 'G'))
-                )) {
-                if (ac_rd == nullptr) {
-                    ac_rd = gc_rd;      // note the start of the first AC
-                }
+    } else {                                // plain comment - skip ahead until we find a ')'
+        while (((c = rd.next()) != NUL) && (c != ')'));
+        return;
+    }
 
-                // skip the comment, handling strings carefully
-                bool in_string = false;
-                while (*(++gc_rd) != 0) {
-                    if (*gc_rd=='"') {
-                        in_string = true;
-                    } else if (in_string) {
-                        if ((*gc_rd == '\\') && (*(gc_rd+1) != 0)) {
-                            gc_rd++; // Skip it, it's escaped.
-                        }
-                    } else if ((*gc_rd == ')')) {
-                        break;
-                    }
-                }
-                if (*gc_rd == 0) {      // We don't want the rd++ later to skip the NULL if we're at one
-                    break;
-                }
+    // copy the comment, handling strings carefully
+    bool in_string = false;
+    bool escaped = false;
+    while ((c = rd.next()) != NUL) {
+        if (in_string && (c == '\\')) {
+            escaped = true;
+        } else if (!escaped && (c == '"')) {
+            // In msg comments, we have to escape "
+            if (in_msg) {
+                _put_comment_char(ac_wr, '\\');
             } else {
-                *(gc_rd-1) = ' ';       // Change the '(' to a space to simplify the comment copy later
-                while ((*gc_rd != 0) && (*gc_rd != ')')) {  // skip ahead until we find a ')' (or NULL)
-                    gc_rd++;
-                }
+                in_string = !in_string;
             }
-        } else if (!isspace(*gc_rd)) {
-            bool do_copy = false;
-
-            // Perform Octal stripping - remove invalid leading zeros in number strings
-            // Otherwise number conversions can fail, as Gcode does not support octal but C libs do
-            // Change 0123.004 to 123.004, or -0234.003 to -234.003
-            if (isdigit(*gc_rd) || (*gc_rd == '.')) { // treat '.' as a digit so we don't strip after one
-                if (last_char_was_digit || (*gc_rd != '0') || !isdigit(*(gc_rd+1))) {
-                    do_copy = true;
-                }
-                last_char_was_digit = true;
-            }
-            else if ((isalnum((char)*gc_rd)) || (strchr("-.", *gc_rd))) { // all valid characters
-                last_char_was_digit = false;
-                do_copy = true;
-            }
-            if (do_copy) {
-                *(gc_wr++) = toupper(*gc_rd);
-                ac_wr++; // move the ac start position
+        } else if (!in_string && (c == ')')) {
+            if (in_msg) {
+                _put_comment_char(ac_wr, '"', 2);
+                _put_comment_char(ac_wr, '}', 1);
             }
+            return;
+        } else {
+            escaped = false;
         }
-        gc_rd++;
-    }
 
-    // Enforce null termination
-    *gc_wr = 0;
-    char *comment_start = ac_wr;    // note the beginning of the comments
-    if (ac_rd != nullptr) {
-
-        // Now we'll copy the comments to the scratch
-        while (*ac_rd != 0) {
-            // check for comment '('
-            // Remember: we're only "counting characters" at this point, no more.
-            if (*ac_rd == '(') {
-                // We only care if it's a "({" in order to handle string-skipping properly
-                ac_rd++;
-
-                bool do_copy = false;
-                bool in_msg = false;
-                if (((* ac_rd    == 'm') || (* ac_rd    == 'M')) &&
-                    ((*(ac_rd+1) == 's') || (*(ac_rd+1) == 'S')) &&
-                    ((*(ac_rd+2) == 'g') || (*(ac_rd+2) == 'G'))
-                    ) {
-
-                    ac_rd += 3;
-                    if (*ac_rd == ' ') {
-                        ac_rd++; // skip the first space.
-                    }
-
-                    if (*(ac_wr-1) == '}') {
-                        *(ac_wr-1) = ',';
-                    } else {
-                        *(ac_wr++) = '{';
-                    }
-                    *(ac_wr++) = 'm';
-                    *(ac_wr++) = 's';
-                    *(ac_wr++) = 'g';
-                    *(ac_wr++) = ':';
-                    *(ac_wr++) = '"';
-
-                    // TODO - FIX BUFFER OVERFLOW POTENTIAL
-                    // "(msg)" is four characters. "{msg:" is five. If the write buffer is full, we'll overflow.
-                    // Also " is MSG will be quoted, making one character into two.
-
-                    in_msg = true;
-                    do_copy = true;
-                }
-
-                else if (*ac_rd == '{') {
-                    // merge json comments
-                    if (*(ac_wr-1) == '}') {
-                        *(ac_wr-1) = ',';
+        // Skip spaces if we're not in a string or msg (implicit string)
+        if (in_string || in_msg || (c != ' ')) {
+            _put_comment_char(ac_wr, c);
+        }
+    }
+}
 
-                        // don't copy the '{'
-                        ac_rd++;
-                    }
+static void _normalize_gcode_block(gcLineReader &rd, char **active_comment, uint8_t *block_delete_flag)
+{
+    char *gc_wr = _gcode_block;         // Gcode write pointer
+    char *gc_end = _gcode_block + sizeof(_gcode_block) - 1;
+    char *ac_wr = _active_comment;      // Active Comment write pointer
+    bool last_char_was_digit = false;   // used for octal stripping
+    char c;
 
-                    do_copy = true;
-                }
+    // mark block deletes
+    if (rd.peek() == '/') {
+        *block_delete_flag = true;
+        rd.next();
+    } else {
+        *block_delete_flag = false;
+    }
 
-                if (do_copy) {
-                    // skip the comment, handling strings carefully
-                    bool in_string = false;
-                    bool escaped = false;
-                    while (*ac_rd != 0) {
-                        if (in_string && (*ac_rd == '\\')) {
-                            escaped = true;
-                        } else if (!escaped && (*ac_rd == '"')) {
-                            // In msg comments, we have to escape "
-                            if (in_msg) {
-                                *(ac_wr++) = '\\';
-                            } else {
-                                in_string = !in_string;
-                            }
-                        } else if (!in_string && (*ac_rd == ')')) {
-                            ac_rd++;
-                            if (in_msg) {
-                                *(ac_wr++) = '"';
-                                *(ac_wr++) = '}';
-                            }
-                            break;
-                        } else {
-                            escaped = false;
-                        }
-
-                        // Skip spaces if we're not in a string or msg (implicit string)
-                        if (in_string || in_msg || (*ac_rd != ' ')) {
-                            *ac_wr = *ac_rd;
-                            ac_wr++;
-                        }
-
-                        ac_rd++;
-                    }
-                }
+    while ((c = rd.next()) != NUL) {
+        if ((c == ';') || (c == '%')) {     // check for ';' or '%' comments that end the line
+            break;
+        }
+        if (c == '(') {                     // check for comment '('
+            _normalize_comment(rd, &ac_wr);
+            continue;
+        }
+        if (isspace(c)) {
+            continue;
+        }
+        bool do_copy = false;
 
-                // We don't want the rd++ later to skip the NULL if we're at one
-                if (*ac_rd == 0) {
-                    break;
-                }
+        // Perform Octal stripping - remove invalid leading zeros in number strings
+        // Otherwise number conversions can fail, as Gcode does not support octal but C libs do
+        // Change 0123.004 to 123.004, or -0234.003 to -234.003
+        if (isdigit(c) || (c == '.')) {     // treat '.' as a digit so we don't strip after one
+            if (last_char_was_digit || (c != '0') || !isdigit(rd.peek())) {
+                do_copy = true;
             }
-            ac_rd++;
+            last_char_was_digit = true;
+        }
+        else if (isalnum(c) || (c == '-')) { // all valid characters
+            last_char_was_digit = false;
+            do_copy = true;
+        }
+        if (do_copy && (gc_wr < gc_end)) {
+            *(gc_wr++) = toupper(c);
         }
     }
+    while (rd.next() != NUL);               // read the rest of the line for the checksum
 
     // Enforce null termination
-    *ac_wr = 0;
-
-    // Now copy it all back
-    memcpy(str, _normalize_scratch, (ac_wr-_normalize_scratch)+1);
-
-    *active_comment = str + (comment_start - _normalize_scratch);
+    *gc_wr = NUL;
+    *ac_wr = NUL;
+    *active_comment = _active_comment;
 }
 
 /****************************************************************************************
@@ -592,8 +581,7 @@ static stat_t _get_next_gcode_word(char **pstr, char *letter, float *value, int3
 
     // get-value general case
     char *end = *pstr;
-    *value = c_atof(end);
-    *value_int = atol(*pstr);                       // needed to get an accurate line number for N > 8,388,608
+    *value = atonum(end, *value_int);               // value_int is needed to get an accurate line number for N > 8,388,608
 
     if (end == *pstr) {
 #if MARLIN_COMPAT_ENABLED == true
@@ -1001,8 +989,12 @@ stat_t _execute_gcode_block(char *active_comment)
 
     EXEC_FUNC(cm_set_coord_system, coord_system);           // G54, G55, G56, G57, G58, G59
 
-    if (gf.path_control) {                                  // G61, G61.1, G64
-        status = cm_set_path_control(MODEL, gv.path_control);
+    if (gf.path_control) {                                  // G61, G61.1, G64, G64 P<tolerance>
+        float tolerance = 0;
+        if ((gv.path_control == PATH_CONTINUOUS) && gf.P_word) {
+            tolerance = _to_millimeters(gv.P_word);
+        }
+        ritorno(cm_set_path_control(MODEL, gv.path_control, tolerance));
     }
 
     EXEC_FUNC(cm_set_distance_mode, distance_mode);         // G90, G91
@@ -1040,7 +1032,7 @@ stat_t _execute_gcode_block(char *active_comment)
         case NEXT_ACTION_DEFAULT: {
             cm_set_absolute_override(MODEL, gv.absolute_override); // apply absolute override & display as absolute
             switch (gv.motion_mode) {
-                case MOTION_MODE_CANCEL_MOTION_MODE: { cm->gm.motion_mode = gv.motion_mode; break;}                 // G80
+                case MOTION_MODE_CANCEL_MOTION_MODE: { cm_set_motion_mode(MODEL, gv.motion_mode); break;}          // G80
                 case MOTION_MODE_STRAIGHT_TRAVERSE:  { status = cm_straight_traverse_global(gv.target, gf.target, PROFILE_NORMAL); break;} // G0
                 case MOTION_MODE_STRAIGHT_FEED:      { status = cm_straight_feed_global(gv.target, gf.target, PROFILE_NORMAL); break;}     // G1
                 case MOTION_MODE_CW_ARC:                                                                            // G2
@@ -1100,11 +1092,13 @@ static stat_t _execute_gcode_block_marlin()
         gv.tool_select += 1;
         cm->gm.tool_select = gv.tool_select; // We need to go ahead and apply to tool select, and in Marlin 0 is valid, so add 1
         cm->gm.tool = cm->gm.tool_select;     // Also, in Marlin, tool changes are effective immediately :facepalm:
+        sr_flag_change(SR_CHANGED_MODEL);
         gf.tool_select = false;             // prevent a tool_select command from being buffered (planning to zero)
     }
     else if (cm->gm.tool_select == 0) {
         cm->gm.tool_select = 1;              // We need to ensure we have a valid tool selected, often Marlin gcode won't have a T word at all
         cm->gm.tool = cm->gm.tool_select;     // Also, in Marlin, tool changes are effective immediately :facepalm:
+        sr_flag_change(SR_CHANGED_MODEL);
     }
 
     if (mst.marlin_flavor &&
@@ -1290,6 +1284,20 @@ stat_t gc_run_gc(nvObj_t *nv)
     return(gcode_parser(*nv->stringp));
 }
 
+#ifdef __DIAGNOSTIC_PARAMETERS
+/*
+ * gc_get_gcn() - get mean Gcode normalizer throughput, in bytes per second of CPU time
+ */
+stat_t gc_get_gcn(nvObj_t *nv)
+{
+    float seconds = (float)_normalize_cycles / SystemCoreClock;
+    nv->value_flt = (seconds > 0) ? (_normalize_bytes / seconds) : 0;
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+#endif
+
 /***********************************************************************************
  * TEXT MODE SUPPORT
  * Functions to print variables from the cfgArray table
@@ -0,0 +1,31 @@
+/*
+ * board_gpio.h - host (Linux) GPIO definitions
+ * This file is part of the g2core project
+ *
+ * The host board has one digital input and one digital output, both on null pins, so the
+ * gpio config tables are not empty. It has no analog I/O.
+ */
+#ifndef BOARD_GPIO_H_ONCE
+#define BOARD_GPIO_H_ONCE
+
+// this file is included from the bottom of gpio.h, but we do this for completeness
+#include "gpio.h"
+#include "hardware.h"
+
+#define D_IN_CHANNELS       1       // number of digital inputs supported
+#define D_OUT_CHANNELS      1       // number of digital outputs supported
+#define A_IN_CHANNELS       0       // number of analog inputs supported
+#define A_OUT_CHANNELS      0       // number of analog outputs supported
+
+#define INPUT_LOCKOUT_MS    10      // milliseconds to go dead after input firing
+
+extern gpioDigitalInput*   const d_in[D_IN_CHANNELS];
+extern gpioDigitalOutput*  const d_out[D_OUT_CHANNELS];
+
+using Motate::IRQPin;
+using Motate::PWMLikeOutputPin;
+
+extern gpioDigitalInputPin<IRQPin<Motate::kInput1_PinNumber>>  din1;
+extern gpioDigitalOutputPin<PWMLikeOutputPin<Motate::kOutput1_PinNumber>>  dout1;
+
+#endif // End of include guard: BOARD_GPIO_H_ONCE
@@ -0,0 +1,61 @@
+/*
+ * board_stepper.h - host (Linux) stepper objects
+ * This file is part of the g2core project
+ *
+ * The host motors are counting steppers. They take the step and direction calls from the
+ * DDA and keep the same step counts a StepDirStepper keeps, so a test can check what the
+ * runtime would have put out on the pins. See host_board.cpp.
+ */
+#ifndef BOARD_STEPPER_H_ONCE
+#define BOARD_STEPPER_H_ONCE
+
+#include "hardware.h"  // for MOTORS
+
+struct HostStepper final : Stepper {
+    int32_t _step_count;
+    int32_t _step_count_up;
+    int32_t _step_count_down;
+    uint8_t _step_dir;
+    stPowerMode _power_mode;
+
+    HostStepper() : _step_count{0}, _step_count_up{0}, _step_count_down{0},
+                    _step_dir{DIRECTION_CW}, _power_mode{MOTOR_DISABLED} {};
+
+    void setPowerMode(stPowerMode new_pm) override { _power_mode = new_pm; };
+    stPowerMode getPowerMode() override { return _power_mode; };
+
+    void stepStart() override {
+        if (_step_dir == DIRECTION_CW) {
+            _step_count++;
+            _step_count_up++;
+        } else {
+            _step_count--;
+            _step_count_down++;
+        }
+    };
+    void stepEnd() override {};
+
+    int32_t getStepCount() override { return _step_count; }
+    int32_t getStepCountUp() override { return _step_count_up; }
+    int32_t getStepCountDown() override { return _step_count_down; }
+    void resetStepCounts() override {
+        _step_count = 0;
+        _step_count_up = 0;
+        _step_count_down = 0;
+    }
+
+    void setDirection(uint8_t new_direction) override { _step_dir = new_direction; };
+};
+
+extern HostStepper motor_1;
+extern HostStepper motor_2;
+extern HostStepper motor_3;
+extern HostStepper motor_4;
+extern HostStepper motor_5;     // not in Motors[] - the core code names motors 5 and 6 directly
+extern HostStepper motor_6;
+
+extern Stepper* const Motors[MOTORS];
+
+void board_stepper_init();
+
+#endif  // BOARD_STEPPER_H_ONCE
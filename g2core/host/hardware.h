@@ -0,0 +1,113 @@
+/*
+ * hardware.h - host (Linux) board definitions for the planner harness
+ * This file is part of the g2core project
+ *
+ * The host board has the same motor, axis and queue sizes as the ArduinoDue board so the
+ * planner runs on the host with the buffer counts and segment timing of a real target.
+ * It has no pins, timers or serial devices. See host/README.md.
+ */
+
+#include "config.h"
+#include "settings.h"
+#include "error.h"
+
+#include "MotateUtilities.h" // for HOT_FUNC and HOT_DATA
+
+#ifndef HARDWARE_H_ONCE
+#define HARDWARE_H_ONCE
+
+/*--- Hardware platform enumerations ---*/
+
+#define G2CORE_HARDWARE_PLATFORM    "host"
+#define G2CORE_HARDWARE_VERSION     "na"
+
+/***** Motors & PWM channels supported by this hardware *****/
+
+#define HAS_LASER 0
+#define HAS_PRESSURE 0
+
+#define MOTORS 4                    // number of motors supported the hardware
+#define PWMS 2                      // number of PWM channels supported the hardware
+#define AXES 6                      // axes to support -- must be 6 or 9
+
+/*************************
+ * Global System Defines *
+ *************************/
+
+#define MILLISECONDS_PER_TICK 1     // MS for system tick (systick * N)
+#define SYS_ID_LEN 40               // total length including dashes and NUL
+
+/*************************
+ * Motate Setup          *
+ *************************/
+
+#include "MotatePins.h"
+#include "MotateTimers.h"
+
+using Motate::TimerChannel;
+
+using Motate::pin_number;
+using Motate::Pin;
+using Motate::PWMOutputPin;
+using Motate::OutputPin;
+
+/**** Stepper DDA and dwell timer settings ****/
+
+#define FREQUENCY_DDA       100000UL        // Hz step frequency
+#define FREQUENCY_DWELL     1000UL
+#define MIN_SEGMENT_MS ((float)1.0)
+
+#define PLANNER_QUEUE_SIZE (48)
+#define SECONDARY_QUEUE_SIZE (10)
+
+/**** Motate Definitions ****/
+
+typedef TimerChannel<3,0> dda_timer_type;       // stepper pulse generation in stepper.cpp
+typedef TimerChannel<4,0> exec_timer_type;      // request exec timer in stepper.cpp
+typedef TimerChannel<5,0> fwd_plan_timer_type;  // request exec timer in stepper.cpp
+
+pin_number indicator_led_pin_num = Motate::kLED_USBRXPinNumber;
+static PWMOutputPin<indicator_led_pin_num> IndicatorLed;
+
+/********************************
+ * Function Prototypes (Common) *
+ ********************************/
+
+const configSubtable *const getSysConfig_3();
+
+void hardware_init(void);       // master hardware init
+stat_t hardware_periodic();     // callback from the main loop (time sensitive)
+void hw_hard_reset(void);
+stat_t hw_flash(nvObj_t *nv);
+
+stat_t hw_get_fb(nvObj_t *nv);
+stat_t hw_get_fv(nvObj_t *nv);
+stat_t hw_get_hp(nvObj_t *nv);
+stat_t hw_get_hv(nvObj_t *nv);
+stat_t hw_get_fbs(nvObj_t *nv);
+stat_t hw_get_fbc(nvObj_t *nv);
+stat_t hw_get_id(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+
+    void hw_print_fb(nvObj_t *nv);
+    void hw_print_fv(nvObj_t *nv);
+    void hw_print_fbs(nvObj_t *nv);
+    void hw_print_fbc(nvObj_t *nv);
+    void hw_print_hp(nvObj_t *nv);
+    void hw_print_hv(nvObj_t *nv);
+    void hw_print_id(nvObj_t *nv);
+
+#else
+
+    #define hw_print_fb tx_print_stub
+    #define hw_print_fv tx_print_stub
+    #define hw_print_fbs tx_print_stub
+    #define hw_print_fbc tx_print_stub
+    #define hw_print_hp tx_print_stub
+    #define hw_print_hv tx_print_stub
+    #define hw_print_id tx_print_stub
+
+#endif // __TEXT_MODE
+
+#endif	// end of include guard: HARDWARE_H_ONCE
@@ -0,0 +1,267 @@
+/*
+ * host_board.cpp - host (Linux) board harness for the planner, runtime and DDA
+ * This file is part of the g2core project
+ *
+ * See host_board.h for what the host replaces. This file also carries the board
+ * objects that board/<BOARD>/ supplies on a real target (0_hardware.cpp,
+ * board_gpio.cpp, board_stepper.cpp) and no-op stand-ins for controller.cpp and xio.cpp,
+ * which are not compiled for the host.
+ */
+
+#include "g2core.h"  // #1
+#include "config.h"  // #2
+#include "controller.h"
+#include "canonical_machine.h"
+#include "gcode_parser.h"
+#include "planner.h"
+#include "plan_arc.h"
+#include "stepper.h"
+#include "encoder.h"
+#include "spindle.h"
+#include "coolant.h"
+#include "gpio.h"
+#include "report.h"
+#include "telemetry.h"
+#include "temperature.h"
+#include "persistence.h"
+#include "safety_manager.h"
+#include "text_parser.h"
+#include "util.h"
+#include "xio.h"
+
+#include "MotateUniqueID.h"
+
+#include "host_board.h"
+
+/**** Cortex-M core stand-ins (see host_cmsis.h) ****/
+
+static HostDWT_Type _host_dwt;
+static HostCoreDebug_Type _host_core_debug;
+HostDWT_Type *const DWT = &_host_dwt;
+HostCoreDebug_Type *const CoreDebug = &_host_core_debug;
+uint32_t SystemCoreClock = 1000000000UL;   // the host cycle counter counts nanoseconds
+
+Motate::SysTickTimer_ Motate::SysTickTimer;
+
+/**** System globals normally allocated in main.cpp ****/
+
+stat_t status_code;                         // allocate a variable for the ritorno macro
+
+OutputPin<Motate::kDebug1_PinNumber> debug_pin1;
+OutputPin<Motate::kDebug2_PinNumber> debug_pin2;
+OutputPin<Motate::kDebug3_PinNumber> debug_pin3;
+
+char *get_status_message(stat_t status)
+{
+    return ((char *)GET_TEXT_ITEM(stat_msg, status));
+}
+
+/**** Board objects normally in board/<BOARD>/ ****/
+
+SafetyManager sm{};
+SafetyManager *safety_manager = &sm;
+
+// a toolhead with no outputs - it only remembers what it was told
+struct HostToolHead : ToolHead {
+    float speed = 0;
+    float override_factor = 1.0;
+    bool override_enable = true;
+    spDirection direction = SPINDLE_OFF;
+
+    void init() override {}
+    void pause() override {}
+    void resume() override {}
+    bool set_speed(float new_speed) override { speed = new_speed; return (true); }
+    float get_speed() override { return (speed); }
+    bool set_override(float new_override) override { override_factor = new_override; return (true); }
+    float get_override() override { return (override_factor); }
+    bool set_override_enable(bool new_enable) override { override_enable = new_enable; return (true); }
+    bool get_override_enable() override { return (override_enable); }
+    bool set_direction(spDirection new_direction) override { direction = new_direction; return (true); }
+    spDirection get_direction() override { return (direction); }
+    void engage(const GCodeState_t &gm) override {}
+    bool is_on() override { return (direction != SPINDLE_OFF); }
+};
+static HostToolHead host_toolhead;
+
+ToolHead *toolhead_for_tool(uint8_t tool) { return (&host_toolhead); }
+
+HostStepper motor_1;
+HostStepper motor_2;
+HostStepper motor_3;
+HostStepper motor_4;
+HostStepper motor_5;
+HostStepper motor_6;
+
+Stepper* const Motors[MOTORS] = {&motor_1, &motor_2, &motor_3, &motor_4};
+
+void board_stepper_init() {
+    for (uint8_t motor = 0; motor < MOTORS; motor++) { Motors[motor]->init(); }
+}
+
+gpioDigitalInputPin<IRQPin<Motate::kInput1_PinNumber>>  din1  {DI1_ENABLED, DI1_POLARITY, 1, DI1_EXTERNAL_NUMBER};
+gpioDigitalOutputPin<PWMLikeOutputPin<Motate::kOutput1_PinNumber>>  dout1  {DO1_ENABLED, DO1_POLARITY, DO1_EXTERNAL_NUMBER, (uint32_t)200000};
+
+gpioDigitalInput*  const d_in[] = {&din1};
+gpioDigitalOutput* const d_out[] = {&dout1};
+gpioAnalogInput*    a_in[] = {};
+
+void outputs_reset(void) {}
+void inputs_reset(void) {}
+
+void hardware_init()
+{
+    spindle_set_toolhead(toolhead_for_tool(1));
+}
+
+stat_t hardware_periodic() { return (STAT_OK); }
+void hw_hard_reset(void) {}
+
+stat_t hw_get_fb(nvObj_t *nv) { return (get_float(nv, cs.fw_build)); }
+stat_t hw_get_fv(nvObj_t *nv) { return (get_float(nv, cs.fw_version)); }
+stat_t hw_get_hp(nvObj_t *nv) { return (get_string(nv, G2CORE_HARDWARE_PLATFORM)); }
+stat_t hw_get_hv(nvObj_t *nv) { return (get_string(nv, G2CORE_HARDWARE_VERSION)); }
+stat_t hw_get_fbs(nvObj_t *nv) { return (get_string(nv, G2CORE_FIRMWARE_BUILD_STRING)); }
+stat_t hw_get_fbc(nvObj_t *nv) { return (get_string(nv, "<default-settings>")); }
+stat_t hw_get_id(nvObj_t *nv) { return (get_string(nv, Motate::UUID)); }
+stat_t hw_flash(nvObj_t *nv) { return (STAT_OK); }
+
+constexpr cfgSubtableFromStaticArray sys_config_3{};
+const configSubtable * const getSysConfig_3() { return &sys_config_3; }
+
+#ifdef __TEXT_MODE
+void hw_print_fb(nvObj_t *nv)  { text_print(nv, "[fb]  firmware build%18.2f\n");}
+void hw_print_fv(nvObj_t *nv)  { text_print(nv, "[fv]  firmware version%16.2f\n");}
+void hw_print_fbs(nvObj_t *nv) { text_print(nv, "[fbs] firmware build%34s\n");}
+void hw_print_fbc(nvObj_t *nv) { text_print(nv, "[fbc] firmware config%33s\n");}
+void hw_print_hp(nvObj_t *nv)  { text_print(nv, "[hp]  hardware platform%15s\n");}
+void hw_print_hv(nvObj_t *nv)  { text_print(nv, "[hv]  hardware version%13s\n");}
+void hw_print_id(nvObj_t *nv)  { text_print(nv, "[id]  g2core ID%37s\n");}
+#endif
+
+/**** controller.cpp stand-ins ****/
+
+controller_t cs;                            // controller state structure
+
+/**** xio.cpp stand-ins ****/
+
+static size_t _discard(const char *buffer, size_t size) { return (size); }
+
+size_t (*host_primary_sink)(const char *buffer, size_t size) = _discard;
+size_t (*host_secondary_sink)(const char *buffer, size_t size) = _discard;
+
+size_t xio_write_some(const char *buffer, size_t size, bool only_to_muted)
+{
+    return (host_primary_sink(buffer, size));
+}
+
+void xio_set_partial_line(void (*finish)(void)) {}
+
+size_t xio_write_secondary(const char *buffer, size_t size)
+{
+    return (host_secondary_sink(buffer, size));
+}
+
+int16_t xio_writeline(const char *buffer, bool only_to_muted)
+{
+    return ((int16_t)host_primary_sink(buffer, strlen(buffer)));
+}
+
+void xio_flush_device(devflags_t &flags) {}
+
+/**** Harness ****/
+
+extern dda_timer_type dda_timer;
+extern exec_timer_type exec_timer;
+extern fwd_plan_timer_type fwd_plan_timer;
+
+void host_init()
+{
+    // application_init_services()
+    hardware_init();
+    persistence_init();
+
+    // application_init_machine()
+    cm = &cm1;
+    cm->machine_state = MACHINE_INITIALIZING;
+    canonical_machine_inits();
+    stepper_init();
+    encoder_init();
+#ifdef __TELEMETRY
+    telemetry_init();
+#endif
+    gpio_init();
+
+    // application_init_startup() less controller_init()
+    config_init();
+    canonical_machine_reset(&cm1);
+    gcode_parser_init();
+    spindle_init();
+    spindle_reset();
+    coolant_init();
+    coolant_reset();
+    temperature_init();
+    gpio_reset();
+}
+
+#define DISPATCH(func) if (func == STAT_EAGAIN) return;
+void host_controller_pass()
+{
+    DISPATCH(st_motor_power_callback());
+    DISPATCH(sr_status_report_callback());
+    DISPATCH(qr_queue_report_callback());
+#ifdef __TELEMETRY
+    DISPATCH(telemetry_callback());
+#endif
+    DISPATCH(mp_planner_callback());
+    DISPATCH(cm_operation_runner_callback());
+    DISPATCH(cm_arc_callback(cm));
+    DISPATCH(cm_feedhold_command_blocker());
+}
+
+stat_t host_gcode(const char *line)
+{
+    if (mp_planner_is_full(mp)) {           // _sync_to_planner()
+        return (STAT_EAGAIN);
+    }
+    char block[RX_BUFFER_SIZE];
+    strncpy(block, line, sizeof(block)-1);
+    block[sizeof(block)-1] = NUL;
+    stat_t status = gcode_parser(block);
+    sr_request_status_report(SR_REQUEST_TIMED);
+    return (status);
+}
+
+/*
+ * host_run_interrupts() - run DDA ticks in place of the timer hardware
+ *
+ *  The DDA timer runs at FREQUENCY_DDA, so every FREQUENCY_DDA/1000 ticks is a SysTick.
+ *  After each tick the software interrupts it raised are serviced, exec before forward
+ *  planning, which is their priority order on the targets.
+ */
+
+void host_run_interrupts(uint32_t dda_ticks)
+{
+    static uint32_t systick_downcount = FREQUENCY_DDA / 1000;
+
+    while (dda_ticks--) {
+        dda_timer.interrupt();
+        while (exec_timer.pending || fwd_plan_timer.pending) {
+            if (exec_timer.pending) {
+                exec_timer.interrupt();
+            } else {
+                fwd_plan_timer.interrupt();
+            }
+        }
+        if (--systick_downcount == 0) {
+            systick_downcount = FREQUENCY_DDA / 1000;
+            Motate::SysTickTimer._tick();
+        }
+    }
+}
+
+bool host_is_idle()
+{
+    return ((mp_get_planner_buffers(mp) == mp->q.queue_size) && !st_runtime_isbusy() &&
+            (cm->motion_state == MOTION_STOP));
+}
@@ -0,0 +1,37 @@
+/*
+ * host_board.h - host (Linux) board harness for the planner, runtime and DDA
+ * This file is part of the g2core project
+ *
+ * The host board stands in for the Motate platform, the controller loop and the xio
+ * devices so the planner stack can run as a Linux program. The firmware sources are
+ * compiled unchanged. What the host replaces:
+ *
+ *  - The NVIC. host_run_interrupts() runs the DDA timer interrupt once per tick and
+ *    services the exec and forward planning software interrupts whenever they are
+ *    pending, highest priority first. The SysTick advances once per millisecond of DDA
+ *    ticks, so planner timing and telemetry run on simulated machine time.
+ *
+ *  - The controller loop. host_controller_pass() makes the planner hierarchy calls of
+ *    _controller_HSM() in the same order, and host_gcode() feeds a line to the Gcode
+ *    parser the way _dispatch_gcode() does once _sync_to_planner() lets it through.
+ *
+ *  - The xio devices. Responses and reports go to host_primary_sink, the secondary
+ *    channel (telemetry) goes to host_secondary_sink. Both default to discarding output.
+ *
+ *  - The stepper drivers. The motors are HostSteppers that count steps (board_stepper.h).
+ */
+#ifndef HOST_BOARD_H_ONCE
+#define HOST_BOARD_H_ONCE
+
+#include "g2core.h"
+
+extern size_t (*host_primary_sink)(const char *buffer, size_t size);
+extern size_t (*host_secondary_sink)(const char *buffer, size_t size);
+
+void host_init(void);                       // application inits, in main.cpp order
+void host_controller_pass(void);            // one pass of the controller's planner hierarchy
+stat_t host_gcode(const char *line);        // dispatch one Gcode line - STAT_EAGAIN if the planner is full
+void host_run_interrupts(uint32_t dda_ticks);   // run DDA ticks and any pending software interrupts
+bool host_is_idle(void);                    // true when the queue is empty and the runtime has stopped
+
+#endif  // HOST_BOARD_H_ONCE
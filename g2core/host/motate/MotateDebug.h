@@ -0,0 +1,10 @@
+/*
+ * MotateDebug.h - host stand-in for the Motate debug output
+ * This file is part of the g2core project
+ */
+#ifndef MOTATE_DEBUG_H_ONCE
+#define MOTATE_DEBUG_H_ONCE
+
+#include <stdio.h>
+
+#endif // MOTATE_DEBUG_H_ONCE
@@ -0,0 +1,128 @@
+/*
+ * MotatePins.h - host stand-in for the Motate pin API
+ * This file is part of the g2core project
+ *
+ * Every pin on the host is a null pin: writes are dropped and reads return low. Only the
+ * pin numbers and options the core code names directly are defined.
+ */
+#ifndef MOTATE_PINS_H_ONCE
+#define MOTATE_PINS_H_ONCE
+
+#include <stdint.h>
+#include <functional>
+
+namespace Motate {
+
+typedef const int16_t pin_number;
+
+enum PinMode {
+    kUnchanged      = 0,
+    kOutput         = 1,
+    kInput          = 2,
+};
+
+enum PinOptions {
+    kNormal         = 0,
+    kTotem          = 0,
+    kPullUp         = 1<<1,
+    kWiredAnd       = 1<<2,
+    kDriveLowOnly   = 1<<2,
+    kWiredAndPullUp = kPullUp|kWiredAnd,
+    kDebounce       = 1<<3,
+    kStartHigh      = 1<<4,
+    kStartLow       = 1<<5,
+};
+
+enum PinInterruptOptions {
+    kPinInterruptsOff           = 0,
+    kPinInterruptOnChange       = 1<<1,
+    kPinInterruptOnRisingEdge   = 1<<2,
+    kPinInterruptOnFallingEdge  = 1<<3,
+    kPinInterruptPriorityHighest = 1<<5,
+    kPinInterruptPriorityHigh    = 1<<6,
+    kPinInterruptPriorityMedium  = 1<<7,
+    kPinInterruptPriorityLow     = 1<<8,
+    kPinInterruptPriorityLowest  = 1<<9,
+};
+
+inline PinOptions operator|(PinOptions a, PinOptions b) { return (PinOptions)((int)a | (int)b); }
+
+// pin numbers used by the core code, all unassigned on the host
+pin_number kDebug1_PinNumber = -1;
+pin_number kDebug2_PinNumber = -1;
+pin_number kDebug3_PinNumber = -1;
+pin_number kDebug4_PinNumber = -1;
+pin_number kLED_USBRXPinNumber = -1;
+pin_number kInput1_PinNumber = -1;
+pin_number kOutput1_PinNumber = -1;
+pin_number kOutput2_PinNumber = -1;
+pin_number kOutput3_PinNumber = -1;
+pin_number kOutput4_PinNumber = -1;
+pin_number kOutput5_PinNumber = -1;
+pin_number kOutput6_PinNumber = -1;
+pin_number kOutput7_PinNumber = -1;
+pin_number kOutput8_PinNumber = -1;
+pin_number kOutput9_PinNumber = -1;
+pin_number kOutput10_PinNumber = -1;
+pin_number kOutput11_PinNumber = -1;
+pin_number kOutput12_PinNumber = -1;
+pin_number kOutput13_PinNumber = -1;
+
+template <int16_t pinNum>
+struct Pin {
+    Pin() {}
+    Pin(const PinMode type, const PinOptions options = kNormal) {}
+
+    bool isNull() { return true; }
+    void setMode(const PinMode type, const PinOptions options = kNormal) {}
+    void setOptions(const PinOptions options, const bool fromConstructor = false) {}
+    void set() {}
+    void clear() {}
+    void write(const bool value) {}
+    void toggle() {}
+    uint32_t get() { return 0; }
+    uint32_t getInputValue() { return 0; }
+    operator bool() { return false; }
+};
+
+template <int16_t pinNum>
+struct OutputPin : Pin<pinNum> {
+    OutputPin() {}
+    OutputPin(const PinOptions options) {}
+    OutputPin &operator=(const bool value) { return *this; }
+};
+
+template <int16_t pinNum>
+struct InputPin : Pin<pinNum> {
+    InputPin() {}
+    InputPin(const PinOptions options) {}
+};
+
+template <int16_t pinNum>
+struct PWMOutputPin : OutputPin<pinNum> {
+    PWMOutputPin() {}
+    PWMOutputPin(const PinOptions options, const uint32_t freq = 0) {}
+    void setFrequency(const uint32_t freq) {}
+    void write(const float value) {}
+    PWMOutputPin &operator=(const float value) { return *this; }
+};
+
+template <int16_t pinNum>
+struct PWMLikeOutputPin : OutputPin<pinNum> {
+    PWMLikeOutputPin() {}
+    PWMLikeOutputPin(const PinOptions options, const uint32_t freq = 0) {}
+    void setFrequency(const uint32_t freq) {}
+    void write(const float value) {}
+    PWMLikeOutputPin &operator=(const float value) { return *this; }
+};
+
+template <int16_t pinNum>
+struct IRQPin : Pin<pinNum> {
+    IRQPin() {}
+    IRQPin(const PinOptions options, const std::function<void(void)> &&interrupt, const uint32_t interrupt_settings = 0) {}
+    void setInterrupts(const uint32_t interrupts) {}
+};
+
+} // namespace Motate
+
+#endif // MOTATE_PINS_H_ONCE
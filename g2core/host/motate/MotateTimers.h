@@ -0,0 +1,129 @@
+/*
+ * MotateTimers.h - host stand-in for the Motate timer API
+ * This file is part of the g2core project
+ *
+ * Only the pieces of the Motate timer interface that the planner, runtime and reports
+ * touch are provided. The SysTick is a simulated millisecond clock: it only moves when
+ * the host harness calls SysTickTimer._tick(), which also runs any registered events the
+ * way the SysTick interrupt would. That keeps planner timing and telemetry deterministic.
+ *
+ * Timer channels only remember whether they are running and whether an interrupt has
+ * been requested. The host harness (host_board.cpp) calls interrupt() on the channels that
+ * are pending, highest priority first, in place of the NVIC.
+ */
+#ifndef MOTATE_TIMERS_H_ONCE
+#define MOTATE_TIMERS_H_ONCE
+
+#include <stdint.h>
+#include <functional>
+
+namespace Motate {
+
+enum TimerMode {
+    kTimerUp            = 0,
+    kTimerUpToMatch     = 1,
+    kTimerUpDown        = 2,
+    kTimerUpDownToMatch = 3,
+};
+
+enum TimerChannelInterruptOptions {
+    kInterruptsOff              = 0,
+    kInterruptOnMatch           = 1<<1,
+    kInterruptOnOverflow        = 1<<2,
+    kInterruptOnSoftwareTrigger = 1<<3,
+    kInterruptPriorityHighest   = 1<<5,
+    kInterruptPriorityHigh      = 1<<6,
+    kInterruptPriorityMedium    = 1<<7,
+    kInterruptPriorityLow       = 1<<8,
+    kInterruptPriorityLowest    = 1<<9,
+};
+
+struct SysTickEvent {
+    std::function<void(void)> callback;
+    SysTickEvent *next;
+};
+
+struct SysTickTimer_ {
+    uint32_t ticks = 0;
+    SysTickEvent *first_event = nullptr;
+
+    uint32_t getValue() { return ticks; }
+
+    void registerEvent(SysTickEvent *new_event) {
+        for (SysTickEvent *e = first_event; e != nullptr; e = e->next) {
+            if (e == new_event) { return; }
+        }
+        new_event->next = first_event;
+        first_event = new_event;
+    }
+
+    void unregisterEvent(SysTickEvent *old_event) {
+        SysTickEvent **e = &first_event;
+        while (*e != nullptr) {
+            if (*e == old_event) {
+                *e = old_event->next;
+                old_event->next = nullptr;
+                return;
+            }
+            e = &(*e)->next;
+        }
+    }
+
+    // host only: advance the clock one tick and run the events, as the interrupt would
+    void _tick() {
+        ticks++;
+        for (SysTickEvent *e = first_event; e != nullptr; e = e->next) {
+            e->callback();
+        }
+    }
+};
+extern SysTickTimer_ SysTickTimer;
+
+inline void delay(uint32_t ms) {
+    while (ms--) { SysTickTimer._tick(); }
+}
+
+struct Timeout {
+    uint32_t start_, delay_;
+    Timeout() : start_{0}, delay_{0} {}
+
+    bool isSet() { return (start_ > 0); }
+    bool isPast() {
+        if (!isSet()) { return false; }
+        return ((SysTickTimer.getValue() - start_) > delay_);
+    }
+    void set(uint32_t delay, bool dont_extend = false) {
+        start_ = SysTickTimer.getValue();
+        if (start_ == 0) { start_ = 1; }
+        delay_ = delay;
+    }
+    void clear() { start_ = 0; delay_ = 0; }
+};
+
+template <uint8_t timerNum, uint8_t channelNum>
+struct TimerChannel {
+    bool running = false;
+    bool pending = false;
+
+    TimerChannel() {}
+    TimerChannel(const TimerMode mode, const uint32_t freq) {}
+
+    void setModeAndFrequency(const TimerMode mode, uint32_t freq) {}
+    void setInterrupts(const uint32_t interrupts) {}
+    void setInterruptPending() { pending = true; }
+    uint32_t getInterruptCause() { pending = false; return kInterruptOnOverflow; }
+    void setDutyCycle(const float ratio) {}
+    void enable() {}
+    void disable() {}
+    void start() { running = true; }
+    void stop() { running = false; }
+    uint32_t getTopValue() { return 0; }
+    bool isRunning() { return running; }
+
+    // defined by the firmware for the channels it uses (see stepper.cpp), called by the host harness
+    void interrupt();
+};
+
+} // namespace Motate
+
+#endif // MOTATE_TIMERS_H_ONCE
@@ -0,0 +1,12 @@
+/*
+ * MotateUniqueID.h - host stand-in for the Motate unique ID
+ * This file is part of the g2core project
+ */
+#ifndef MOTATE_UNIQUE_ID_H_ONCE
+#define MOTATE_UNIQUE_ID_H_ONCE
+
+namespace Motate {
+    static const char UUID[] = "host";
+}
+
+#endif // MOTATE_UNIQUE_ID_H_ONCE
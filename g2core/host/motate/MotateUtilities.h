@@ -0,0 +1,16 @@
+/*
+ * MotateUtilities.h - host stand-in for the Motate utility macros
+ * This file is part of the g2core project
+ *
+ * On the ARM targets these place hot code and data in tightly coupled memory. On the
+ * host they are plain functions and data.
+ */
+#ifndef MOTATE_UTILITIES_H_ONCE
+#define MOTATE_UTILITIES_H_ONCE
+
+#include "host_cmsis.h"
+
+#define HOT_FUNC
+#define HOT_DATA
+
+#endif // MOTATE_UTILITIES_H_ONCE
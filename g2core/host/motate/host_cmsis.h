@@ -0,0 +1,43 @@
+/*
+ * host_cmsis.h - host stand-in for the Cortex-M core registers the firmware reads
+ * This file is part of the g2core project
+ *
+ * The diagnostics and planner profiling read the DWT cycle counter and SystemCoreClock.
+ * On the host the "cycle counter" is the monotonic clock in nanoseconds, so cycle counts
+ * divided by SystemCoreClock still come out in seconds.
+ */
+#ifndef HOST_CMSIS_H_ONCE
+#define HOST_CMSIS_H_ONCE
+
+#include <stdint.h>
+#include <time.h>
+
+struct HostCycleCounter {
+    operator uint32_t() const {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ((uint32_t)ts.tv_sec * 1000000000UL + (uint32_t)ts.tv_nsec);
+    }
+};
+
+struct HostDWT_Type {
+    uint32_t CTRL;
+    HostCycleCounter CYCCNT;
+};
+
+struct HostCoreDebug_Type {
+    uint32_t DEMCR;
+};
+
+extern HostDWT_Type *const DWT;
+extern HostCoreDebug_Type *const CoreDebug;
+extern uint32_t SystemCoreClock;
+
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+inline void __NOP() {}
+
+#endif // HOST_CMSIS_H_ONCE
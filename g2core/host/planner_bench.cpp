@@ -0,0 +1,140 @@
+/*
+ * planner_bench.cpp - stream a Gcode job through the planner and runtime on the host
+ * This file is part of the g2core project
+ *
+ * Usage: planner_bench [file.gcode]
+ *
+ *  Feeds the job line by line through the Gcode parser into mp_aline() and runs the exec
+ *  runtime and DDA until the machine stops, then reports planner throughput:
+ *
+ *    blocks/sec      blocks queued per second of controller loop time (parse + plan)
+ *    segments/sec    segments computed per second of time spent in mp_exec_move()
+ *    _plan_block()   worst-case and mean time of one _plan_block() call
+ *
+ *  These are host CPU numbers, so compare them between builds on the same machine rather
+ *  than against a target. The machine time is the simulated time the job took to run.
+ *  Without a file a synthetic job of short G1 lines and G2/G3 arcs is used.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "report.h"
+#include "util.h"
+#include "xio.h"
+
+#include "host_board.h"
+#include "stepper.h"
+
+#include <time.h>
+#include <vector>
+#include <string>
+
+#define DDA_TICKS_PER_PASS 10           // 100 uSec of machine time per controller pass
+#define DRAIN_TIMEOUT_MS (60L*60*1000)  // give up if the job has not stopped in an hour of machine time
+
+static double _now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+static std::vector<std::string> _synthetic_job()
+{
+    std::vector<std::string> job;
+    char line[128];
+
+    job.push_back("G21 G90 G17 G64");
+    job.push_back("G0 X0 Y0 Z5");
+    job.push_back("G1 Z0 F1000");
+    for (int ring = 1; ring <= 20; ring++) {
+        float radius = 2.0 * ring;
+        sprintf(line, "G1 X%.4f Y0 F6000", radius);
+        job.push_back(line);
+        for (int deg = 1; deg <= 360; deg++) {   // a circle as 1 degree chords, like CAM output
+            float a = deg * M_PI / 180;
+            sprintf(line, "G1 X%.4f Y%.4f", radius * cosf(a), radius * sinf(a));
+            job.push_back(line);
+        }
+        sprintf(line, "G2 X%.4f Y0 I%.4f J0", -radius, -radius);
+        job.push_back(line);
+        sprintf(line, "G3 X%.4f Y0 I%.4f J0", radius, radius);
+        job.push_back(line);
+    }
+    job.push_back("G0 Z5");
+    job.push_back("G0 X0 Y0");
+    job.push_back("M2");
+    return (job);
+}
+
+static std::vector<std::string> _read_job(const char *filename)
+{
+    std::vector<std::string> job;
+    FILE *f = fopen(filename, "r");
+    if (f == NULL) {
+        perror(filename);
+        exit(1);
+    }
+    char line[RX_BUFFER_SIZE];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        line[strcspn(line, "\r\n")] = NUL;
+        job.push_back(line);
+    }
+    fclose(f);
+    return (job);
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<std::string> job = (argc > 1) ? _read_job(argv[1]) : _synthetic_job();
+
+    host_init();
+    mp_profile_init();
+
+    double loop_seconds = 0;
+    double start, wall_start = _now();
+    for (const std::string &line : job) {
+        for (;;) {
+            start = _now();
+            host_controller_pass();
+            stat_t status = host_gcode(line.c_str());
+            loop_seconds += _now() - start;
+            if (status != STAT_EAGAIN) {
+                if ((status != STAT_OK) && (status != STAT_NOOP)) {
+                    fprintf(stderr, "\"%s\": %s\n", line.c_str(), get_status_message(status));
+                }
+                break;
+            }
+            host_run_interrupts(DDA_TICKS_PER_PASS);
+        }
+        host_run_interrupts(DDA_TICKS_PER_PASS);
+    }
+    do {
+        start = _now();
+        host_controller_pass();
+        loop_seconds += _now() - start;
+        host_run_interrupts(DDA_TICKS_PER_PASS);
+    } while (!host_is_idle() && (SysTickTimer.getValue() < DRAIN_TIMEOUT_MS));
+    double wall_seconds = _now() - wall_start;
+
+    double exec_seconds = (double)mpf.exec_cycles / SystemCoreClock;
+    printf("lines            %lu\n", (unsigned long)job.size());
+    printf("blocks           %lu\n", (unsigned long)mpf.blocks);
+    printf("segments         %lu\n", (unsigned long)mpf.segments);
+    printf("machine time     %.3f s\n", SysTickTimer.getValue() / 1000.0);
+    printf("wall time        %.3f s\n", wall_seconds);
+    printf("blocks/sec       %.0f\n", mpf.blocks / loop_seconds);
+    printf("segments/sec     %.0f\n", mpf.segments / exec_seconds);
+    printf("_plan_block max  %.2f uSec\n", mpf.plan_block_max * 1e6 / SystemCoreClock);
+    printf("_plan_block mean %.2f uSec\n",
+           (mpf.plan_block_calls > 0) ? ((double)mpf.plan_block_cycles / mpf.plan_block_calls * 1e6 / SystemCoreClock) : 0);
+    printf("starvations      %lu\n", (unsigned long)qr.starvations);
+    printf("motor steps     ");
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        printf(" %ld", (long)Motors[motor]->getStepCount());
+    }
+    printf("\n");
+    return ((host_is_idle()) ? 0 : 1);
+}
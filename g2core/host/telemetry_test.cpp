@@ -0,0 +1,257 @@
+/*
+ * telemetry_test.cpp - decode the binary telemetry stream (see telemetry.h)
+ * This file is part of the g2core project
+ *
+ * Usage: telemetry_test                  run a job and decode the live stream
+ *        telemetry_test file.bin         decode a recorded stream
+ *        telemetry_test -r file.bin      run the job and record its stream to the file
+ *
+ *  The decoder here is written from the record layout in telemetry.h alone - it does not
+ *  use tmRecord_t or util.cpp's crc32() - so it checks what a host program would see.
+ *  A stream decodes if every record has a good CRC, the sequence numbers run without a
+ *  gap, time and line numbers never go backwards, and the last record is the end point
+ *  of the job. The live stream is also decoded again with junk in front of it and one
+ *  record corrupted, which must cost exactly that record.
+ *
+ *  testdata/telemetry_sample.bin is a recording of the job below, so decoding it checks
+ *  that the format has not changed under existing host programs.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "canonical_machine.h"
+#include "planner.h"
+#include "telemetry.h"
+
+#include "host_board.h"
+
+#include <vector>
+
+#define TELEMETRY_TEST_RATE 100         // Hz - keeps the recorded sample small
+
+static const char *_job[] = {
+    "G21 G90 G17 G64",
+    "N10 G0 X10 Y5 Z2",
+    "N20 G1 Z0 F1000",
+    "N30 G1 X20 Y5 F3000",
+    "N40 G2 X20 Y-5 I0 J-5",
+    "N50 G1 X0 Y0",
+    "N60 G0 Z2",
+    "N70 G0 X0 Y0 Z0",
+    "M2",
+};
+static const float _job_end[] = { 0, 0, 0 };    // X, Y, Z of the last record
+
+static int failures = 0;
+
+static void _fail(const char *what, long record)
+{
+    if (++failures <= 10) {
+        printf("FAIL record %ld: %s\n", record, what);
+    }
+}
+
+/**** Decoder ****/
+
+struct Record {
+    uint16_t sequence;
+    uint32_t time_ms;
+    uint32_t linenum;
+    float velocity;
+    uint8_t axes;
+    uint8_t motors;
+    float position[9];
+    int32_t steps[6];
+};
+
+static uint32_t _le32(const uint8_t *b) { return (b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24)); }
+
+static float _le_float(const uint8_t *b)
+{
+    uint32_t bits = _le32(b);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return (value);
+}
+
+static uint32_t _crc32(const uint8_t *b, size_t size)        // the zlib crc32
+{
+    uint32_t crc = ~0U;
+    while (size--) {
+        crc ^= *b++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return (crc ^ ~0U);
+}
+
+// Returns the records found. Bytes that do not start a record with a good CRC are skipped.
+static std::vector<Record> _decode(const std::vector<uint8_t> &stream, size_t *skipped)
+{
+    std::vector<Record> records;
+    *skipped = 0;
+    size_t i = 0;
+    while (i + 2 <= stream.size()) {
+        const uint8_t *b = &stream[i];
+        uint8_t axes = b[1] >> 4;
+        uint8_t motors = b[1] & 0x0F;
+        size_t size = 20 + 4*axes + 4*motors;
+        if ((b[0] != TELEMETRY_SYNC) || (axes < 3) || (axes > 9) || (motors < 1) || (motors > 6) ||
+            (i + size > stream.size()) || (_crc32(b, size-4) != _le32(&b[size-4]))) {
+            i++;
+            (*skipped)++;
+            continue;
+        }
+        Record r;
+        r.sequence = b[2] | (b[3] << 8);
+        r.time_ms = _le32(&b[4]);
+        r.linenum = _le32(&b[8]);
+        r.velocity = _le_float(&b[12]);
+        r.axes = axes;
+        r.motors = motors;
+        for (uint8_t axis = 0; axis < axes; axis++) {
+            r.position[axis] = _le_float(&b[16 + 4*axis]);
+        }
+        for (uint8_t motor = 0; motor < motors; motor++) {
+            r.steps[motor] = (int32_t)_le32(&b[16 + 4*axes + 4*motor]);
+        }
+        records.push_back(r);
+        i += size;
+    }
+    return (records);
+}
+
+// Checks a decoded job and returns the number of sequence gaps
+static long _check_job(const std::vector<Record> &records, const char *name)
+{
+    long gaps = 0;
+    if (records.size() < 10) {
+        _fail("fewer than 10 records", records.size());
+        return (0);
+    }
+    for (size_t n = 1; n < records.size(); n++) {
+        const Record &r = records[n], &prev = records[n-1];
+        if ((uint16_t)(r.sequence - prev.sequence) != 1) {
+            gaps++;
+        }
+        if (r.time_ms <= prev.time_ms) {
+            _fail("time went backwards", n);
+        }
+        if (r.linenum < prev.linenum) {
+            _fail("line number went backwards", n);
+        }
+        if ((r.axes != prev.axes) || (r.motors != prev.motors)) {
+            _fail("layout changed", n);
+        }
+    }
+    const Record &last = records.back();
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        if (fabs(last.position[axis] - _job_end[axis]) > 0.001) {
+            _fail("last record is not the end of the job", records.size()-1);
+        }
+    }
+    if (last.linenum != 70) {
+        _fail("last record is not on the last line", records.size()-1);
+    }
+    printf("%s: %lu records, %ld gaps, %u to %u ms\n", name, (unsigned long)records.size(), gaps,
+           (unsigned)records.front().time_ms, (unsigned)last.time_ms);
+    return (gaps);
+}
+
+/**** Live stream ****/
+
+static std::vector<uint8_t> _stream;
+
+static size_t _capture(const char *buffer, size_t size)
+{
+    _stream.insert(_stream.end(), buffer, buffer + size);
+    return (size);
+}
+
+static void _run_job()
+{
+    host_secondary_sink = _capture;
+    host_init();
+
+    nvObj_t *nv = nv_reset_nv_list();
+    strcpy(nv->token, "tmr");
+    nv->index = nv_get_index("", nv->token);
+    nv->valuetype = TYPE_INTEGER;
+    nv->value_int = TELEMETRY_TEST_RATE;
+    nv_set(nv);
+
+    for (const char *line : _job) {
+        while (host_gcode(line) == STAT_EAGAIN) {
+            host_controller_pass();
+            host_run_interrupts(10);
+        }
+    }
+    do {
+        host_controller_pass();
+        host_run_interrupts(10);
+    } while (!host_is_idle());
+    host_run_interrupts(FREQUENCY_DDA / TELEMETRY_TEST_RATE);  // one sample at rest
+    host_controller_pass();
+}
+
+int main(int argc, char *argv[])
+{
+    size_t skipped;
+
+    if ((argc == 2) && (argv[1][0] != '-')) {       // decode a recording
+        FILE *f = fopen(argv[1], "rb");
+        if (f == NULL) {
+            perror(argv[1]);
+            return (1);
+        }
+        std::vector<uint8_t> stream;
+        int c;
+        while ((c = fgetc(f)) != EOF) {
+            stream.push_back((uint8_t)c);
+        }
+        fclose(f);
+        std::vector<Record> records = _decode(stream, &skipped);
+        if (skipped != 0) {
+            _fail("bytes skipped in a clean recording", 0);
+        }
+        if (_check_job(records, argv[1]) != 0) {
+            _fail("sequence gaps in a clean recording", 0);
+        }
+        return ((failures == 0) ? 0 : 1);
+    }
+
+    _run_job();
+    if ((argc == 3) && (strcmp(argv[1], "-r") == 0)) {
+        FILE *f = fopen(argv[2], "wb");
+        if ((f == NULL) || (fwrite(_stream.data(), 1, _stream.size(), f) != _stream.size())) {
+            perror(argv[2]);
+            return (1);
+        }
+        fclose(f);
+    }
+
+    std::vector<Record> records = _decode(_stream, &skipped);
+    if (skipped != 0) {
+        _fail("bytes skipped in the live stream", 0);
+    }
+    if (_check_job(records, "live") != 0) {
+        _fail("sequence gaps in the live stream", 0);
+    }
+
+    // junk in front and one corrupted record must cost that record and nothing else
+    size_t record_size = _stream.size() / records.size();
+    std::vector<uint8_t> damaged = { 0xA5, 0x64, 0x00, 0xA5, 0x13, 0x37, 0xA5 };
+    damaged.insert(damaged.end(), _stream.begin(), _stream.end());
+    damaged[7 + 5*record_size + 10] ^= 0x40;
+    std::vector<Record> resynced = _decode(damaged, &skipped);
+    if (resynced.size() != records.size()-1) {
+        _fail("resync lost more than the corrupted record", 5);
+    }
+    if (_check_job(resynced, "damaged") != 1) {
+        _fail("the corrupted record is not a single sequence gap", 5);
+    }
+
+    printf("%d failures\n", failures);
+    return ((failures == 0) ? 0 : 1);
+}
@@ -0,0 +1,262 @@
+/*
+ * util_test.cpp - round trip tests and throughput of the number conversions in util.cpp
+ * This file is part of the g2core project
+ *
+ * Usage: util_test [count]
+ *
+ *  atonum()   must return exactly what strtof() returns, and the integer part atol() does
+ *  floattoa() must print what printf("%.*f") prints, trailing zeros stripped - except at
+ *             exact .5 ties, which floattoa() rounds half-up and printf() half-even
+ *  inttoa()   must print what printf("%d") prints
+ *  and a float printed by floattoa() with enough digits must parse back to the same float.
+ *
+ *  Each test runs on count random values (default 1M) plus fixed edge cases, then the
+ *  conversions are timed against the C library. Exits nonzero on the first few mismatches.
+ */
+
+#include "g2core.h"
+#include "util.h"
+#include "xio.h"    // for NUL
+
+#include <time.h>
+#include <limits.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#define FLOATTOA_MAX_PRECISION 9       // as in util.cpp
+
+static int failures = 0;
+static std::mt19937 rng(2201);
+
+static double _now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ts.tv_sec + ts.tv_nsec * 1e-9);
+}
+
+static void _fail(const char *test, const char *input, const char *expected, const char *got)
+{
+    if (++failures <= 10) {
+        printf("FAIL %-9s \"%s\": expected %s, got %s\n", test, input, expected, got);
+    }
+}
+
+// random number text: Gcode style, or with an exponent, with 1 to 12 significant digits
+static void _random_number(char *buf, bool exponent)
+{
+    char *s = buf;
+    if (rng() & 1) { *s++ = '-'; }
+    int digits = 1 + rng() % 12;
+    int point = rng() % (digits + 1);
+    for (int i = 0; i < digits; i++) {
+        if (i == point) { *s++ = '.'; }
+        *s++ = '0' + rng() % 10;
+    }
+    if (exponent && (rng() & 1)) {
+        s += sprintf(s, "e%d", (int)(rng() % 81) - 40);
+    }
+    *s = NUL;
+}
+
+static void _check_atonum(const char *text, bool exponent)
+{
+    char buf[64];
+    strcpy(buf, text);
+    char *p = buf;
+    int32_t int_part;
+    float value = atonum(p, int_part, exponent);
+
+    char *end;
+    float expected = strtof(text, &end);
+    if (!exponent) {                    // Gcode input: E is a word, not an exponent
+        char *e = strpbrk(buf, "eE");
+        if (e != nullptr) {
+            *e = NUL;
+            expected = strtof(buf, &end);
+            end = (char *)text + (end - buf);
+        }
+    }
+    char want[32], got[32];
+    if (memcmp(&value, &expected, sizeof(value)) != 0) {
+        sprintf(want, "%.9g", expected);
+        sprintf(got, "%.9g", value);
+        _fail("atonum", text, want, got);
+    }
+    if ((p - buf) != (end - text)) {
+        sprintf(want, "%d chars", (int)(end - text));
+        sprintf(got, "%d chars", (int)(p - buf));
+        _fail("atonum", text, want, got);
+    }
+    long expected_int = atol(text);
+    if ((expected_int == (int32_t)expected_int) && (int_part != expected_int)) {
+        sprintf(want, "int %ld", expected_int);
+        sprintf(got, "int %ld", (long)int_part);
+        _fail("atonum", text, want, got);
+    }
+}
+
+// true if n is exactly halfway between two values printed at precision
+static bool _is_tie(float n, int precision)
+{
+    long double scaled = (long double)n * powl(10, precision);
+    return ((scaled - floorl(scaled)) == 0.5L);
+}
+
+static void _check_floattoa(float n, int precision)
+{
+    char got[48], want[48];
+    floattoa(got, n, precision, sizeof(got)-1);
+    if ((fabsf(n) >= 4294967040.0f) || _is_tie(n, precision)) {
+        return;
+    }
+    int length = sprintf(want, "%.*f", precision, (double)n);
+    if (strchr(want, '.') != nullptr) {
+        while (want[length-1] == '0') { want[--length] = NUL; }
+        if (want[length-1] == '.') { want[--length] = NUL; }
+    }
+    if (strcmp(want, "-0") == 0) {      // floattoa() never prints -0
+        strcpy(want, "0");
+    }
+    if (strcmp(got, want) != 0) {
+        char input[48];
+        sprintf(input, "%.9g at %d", n, precision);
+        _fail("floattoa", input, want, got);
+    }
+}
+
+static void _check_inttoa(int n)
+{
+    char got[16], want[16];
+    inttoa(got, n);
+    sprintf(want, "%d", n);
+    if (strcmp(got, want) != 0) {
+        _fail("inttoa", want, want, got);
+    }
+}
+
+// floattoa() with 9 decimals shows at least 9 significant digits of a float of 1 or more
+static void _check_round_trip(float n)
+{
+    char text[48];
+    floattoa(text, n, 9, sizeof(text)-1);
+    char *p = text;
+    int32_t int_part;
+    float back = atonum(p, int_part);
+    if (memcmp(&back, &n, sizeof(n)) != 0) {
+        char want[32], got[32];
+        sprintf(want, "%.9g", n);
+        sprintf(got, "%.9g", back);
+        _fail("roundtrip", text, want, got);
+    }
+}
+
+static float _random_float(float low, float high)
+{
+    return (std::uniform_real_distribution<float>(low, high)(rng));
+}
+
+static void _benchmark(long count)
+{
+    std::vector<std::string> texts(1024);
+    for (std::string &t : texts) {
+        char buf[64];
+        _random_number(buf, false);
+        t = buf;
+    }
+    std::vector<float> floats(1024);
+    for (float &f : floats) {
+        f = _random_float(-10000, 10000);
+    }
+    char buf[64];
+    volatile float sink_f = 0;
+    volatile long sink_i = 0;
+    double start, lib, ours;
+
+    start = _now();
+    for (long i = 0; i < count; i++) {
+        const char *t = texts[i & 1023].c_str();
+        sink_f = sink_f + strtof(t, nullptr);
+        sink_i = sink_i + atol(t);
+    }
+    lib = _now() - start;
+    start = _now();
+    for (long i = 0; i < count; i++) {
+        strcpy(buf, texts[i & 1023].c_str());
+        char *p = buf;
+        int32_t int_part;
+        sink_f = sink_f + atonum(p, int_part);
+        sink_i = sink_i + int_part;
+    }
+    ours = _now() - start;
+    printf("atonum    %6.1f ns  strtof+atol %6.1f ns\n", ours * 1e9 / count, lib * 1e9 / count);
+
+    start = _now();
+    for (long i = 0; i < count; i++) {
+        sink_i = sink_i + sprintf(buf, "%.3f", (double)floats[i & 1023]);
+    }
+    lib = _now() - start;
+    start = _now();
+    for (long i = 0; i < count; i++) {
+        sink_i = sink_i + floattoa(buf, floats[i & 1023], 3);
+    }
+    ours = _now() - start;
+    printf("floattoa  %6.1f ns  sprintf %%.3f %6.1f ns\n", ours * 1e9 / count, lib * 1e9 / count);
+
+    start = _now();
+    for (long i = 0; i < count; i++) {
+        sink_i = sink_i + sprintf(buf, "%d", (int)(i * 7919));
+    }
+    lib = _now() - start;
+    start = _now();
+    for (long i = 0; i < count; i++) {
+        sink_i = sink_i + inttoa(buf, (int)(i * 7919));
+    }
+    ours = _now() - start;
+    printf("inttoa    %6.1f ns  sprintf %%d   %6.1f ns\n", ours * 1e9 / count, lib * 1e9 / count);
+}
+
+int main(int argc, char *argv[])
+{
+    long count = (argc > 1) ? atol(argv[1]) : 1000000;
+    char text[64];
+
+    static const char *edge_cases[] = {
+        "0", "-0", "0.0", ".5", "-.5", "5.", "+1", "16777216", "16777217", "123456789",
+        "1234567890123", "0.000000001", "0.1", "0.3", "2.5", "99999999.5", "3.4e38",
+        "3.40282347e38", "1e-38", "1.4e-45", "1e39", "1e-50", "7.006492e-46", "2147483647",
+        "123.456E7", "1.5e", "1.5e+", "1.5E-3", "00001.2500",
+    };
+    for (const char *t : edge_cases) {
+        _check_atonum(t, true);
+        _check_atonum(t, false);
+    }
+    for (long i = 0; i < count; i++) {
+        _random_number(text, false);
+        _check_atonum(text, false);
+        _random_number(text, true);
+        _check_atonum(text, true);
+    }
+
+    for (long i = 0; i < count; i++) {
+        float n = (i & 1) ? _random_float(-1000, 1000) : _random_float(-4e9, 4e9);
+        _check_floattoa(n, i % (FLOATTOA_MAX_PRECISION + 1));
+    }
+
+    static const int int_cases[] = { 0, 1, -1, 9, 10, 99, 100, -100, 65535, INT_MAX, -INT_MAX };
+    for (int n : int_cases) {
+        _check_inttoa(n);
+    }
+    for (long i = 0; i < count; i++) {
+        _check_inttoa((int)rng());
+    }
+
+    for (long i = 0; i < count; i++) {
+        _check_round_trip(_random_float(1, 1000000));
+    }
+
+    printf("%d failures in %ld values per test\n", failures, count);
+    _benchmark(count);
+    return ((failures == 0) ? 0 : 1);
+}
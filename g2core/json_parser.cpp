@@ -49,6 +49,15 @@ static stat_t _json_parser_execute(nvObj_t *nv);
 static stat_t _normalize_json_string(char *str, uint16_t size);
 static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth);
 
+typedef struct jsSink {             // where the serializer writes in the stream chunk
+    char *wr;                       // next character
+    char *end;                      // end of the chunk
+} jsSink_t;
+
+static void _serialize_next(jsSerializer_t &ser, jsSink_t &out);
+static bool _stream_send(bool block);
+static stat_t _stream_run(bool block);
+
 /****************************************************************************
  * json_parser() - exposed part of JSON parser
  * _json_parser_kernal()
@@ -227,12 +236,13 @@ static stat_t _json_parser_kernal(nvObj_t *nv, char *str)
 static stat_t _normalize_json_string(char *str, uint16_t size)
 {
     char *wr;                                       // write pointer
+    char *end = str + size;                         // the string must end by here
     uint8_t in_comment = false;
 
-    if (strlen(str) > size) {
-        return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
-    }
     for (wr = str; *str != NUL; str++) {
+        if (str == end) {                           // checked as we go, rather than a strlen() pass first
+            return (STAT_INPUT_EXCEEDS_MAX_LENGTH);
+        }
         if (!in_comment) {                          // normal processing
             if (*str == '(') in_comment = true;
             if ((*str <= ' ') || (*str == DEL)) continue; // toss ctrls, WS & DEL
@@ -347,10 +357,8 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
 ////##
     // numbers
     } else if (isdigit(**pstr) || (**pstr == '-')) {    // value is a number
-        nv->value_int = atol(*pstr);                    // get the number as an integer
-        ////** my earlier change?  nv->value_flt = (float)strtod(*pstr, &tmp);     // get the number as a float - tmp is the end pointer
-        ////** comit conflict with latest edge-prev 9/17/20
-        nv->value_flt = strtod(*pstr, &tmp);            // get the number as a float - tmp is the end pointer
+        tmp = *pstr;
+        nv->value_flt = atonum(tmp, nv->value_int, true); // get the number as a float and integer - tmp is the end pointer
 
         if ((tmp == *pstr) ||                           // if start pointer equals end the conversion failed
             (strchr(terminators, *tmp) == NULL)) {      // terminators are the only legal chars at the end of a number
@@ -422,124 +430,194 @@ static stat_t _get_nv_pair(nvObj_t *nv, char **pstr, int8_t *depth)
     return (STAT_OK);                           // signal that parsing is complete
 }
 
-/****************************************************************************
- * json_serialize() - make a JSON object string from JSON object array
- *
- *  *nv is a pointer to the first element in the nv list to serialize
- *  *out_buf is a pointer to the output string - usually what was the input string
- *  Returns the character count of the resulting string
+/*
+ * _put()            - append to the serializer output
+ * _serialize_next() - serialize ser.nv as JSON and advance to the next object
  *
- *   Operation:
- *    - The nvObj list is processed start to finish with no recursion
+ *  Output is serialized into the stream chunk, which is normally sent between
+ *  elements. Only an element too long for the chunk (a long string) fills it, in which
+ *  case the full chunk is sent with a blocking write to make room.
  *
+ *  The nvObj list is processed start to finish with no recursion:
  *    - Assume the first object is depth 0 or greater (the opening curly)
- *
  *    - Assume remaining depths have been set correctly; but might not achieve closure;
  *      e.g. list starts on 0, and ends on 3, in which case provide correct closing curlies
- *
  *    - Assume there can be multiple, independent, non-contiguous JSON objects at a
  *      given depth value. These are processed correctly - e.g. 0,1,1,0,1,1,0,1,1
- *
  *    - The list must have a terminating nvObj where nv->nx == NULL.
  *      The terminating object may or may not have data (empty or not empty).
- *
- *  Returns:
- *      Returns length of string, or -1 if there's been an error
- *
- *  Desired behaviors:
- *    - Allow self-referential elements that would otherwise cause a recursive loop
- *    - Skip over empty objects (TYPE_EMPTY)
- *    - If a JSON object is empty represent it as {}
+ *    - Empty objects (TYPE_EMPTY) are skipped. An empty JSON object is represented as {}
  */
 
-uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
+static void _put(jsSink_t &out, const char *src, uint16_t len)
 {
-    char *str = out_buf;
-    char *str_max = out_buf + size;
-    int8_t initial_depth = nv->depth;
-    int8_t prev_depth = 0;
-    uint8_t need_a_comma = false;
-
-    *str++ = '{';                                 // write opening curly
-
-    while (true) {
-        if (nv->valuetype != TYPE_EMPTY) {
-            if (need_a_comma) { *str++ = ',';}
-            need_a_comma = true;
-            strcpy(str++, "\"");
-            strcpy(str, nv->token); str += strlen(nv->token);
-            strcpy(str++, "\":"); str++;
-
-            switch (nv->valuetype)  {
-                case (TYPE_EMPTY):  {   break; }
-                case (TYPE_NULL):   {   strcpy(str, "null");
-                                        str += 4;
-                                        break;
-                                    }
-                case (TYPE_PARENT): {   *str++ = '{';
-                                        need_a_comma = false;
-////##                                        prev_depth++; // make sure empty objects are closed
-                                        break;
-                                    }
-                case (TYPE_FLOAT):  {   convert_outgoing_float(nv);
-                                        str += floattoa(str, nv->value_flt, nv->precision);
-                                        break;
-                                    }
-//                case (TYPE_INT):    {   // str += inttoa(str, (int)nv->value); // doesn't handle negative numbers
-//                                        str += sprintf(str, "%d", (int)nv->value);
-//                                        break;
-//                                    }
-                case (TYPE_INTEGER):{   str += sprintf(str, "%d", (int)nv->value_int);
-                                        break;
-                                    }
-                case (TYPE_STRING): {   *str++ = '"';
-                                        strcpy(str, *nv->stringp);
-                                        str += strlen(*nv->stringp);
-                                        *str++ = '"';
-                                        break;
-                                    }
-                case (TYPE_BOOLEAN):{   if (!nv->value_int) {
-                                            strcpy(str, "false");
-                                            str += 5;
-                                        } else {
-                                            strcpy(str, "true");
-                                            str += 4;
-                                        }
-                                        break;
-                                    }
-                case (TYPE_DATA):   {   uint32_t *v = (uint32_t*)&nv->value_int;
-////## later correction accepted                case (TYPE_DATA):   {   uint32_t *v = (uint32_t*)&nv->value_flt;
-                                        str += sprintf(str, "\"0x%lx\"", *v);
-                                        break;
-                                    }
-                case (TYPE_ARRAY):  {   strcpy(str++, "[");
-                                        strcpy(str, *nv->stringp);
-                                        str += strlen(*nv->stringp);
-                                        strcpy(str++, "]");
-                                        break;
+    while (len) {
+        if (out.wr == out.end) {
+            js.stream_len = out.wr - js.stream_chunk;
+            _stream_send(true);
+            out.wr = js.stream_chunk;
+        }
+        uint16_t room = out.end - out.wr;
+        uint16_t n = (len < room) ? len : room;
+        memcpy(out.wr, src, n);
+        out.wr += n;
+        src += n;
+        len -= n;
+    }
+}
+
+static void _serialize_next(jsSerializer_t &ser, jsSink_t &out)
+{
+    nvObj_t *nv = ser.nv;
+    char num[24];
+
+    if (nv->valuetype != TYPE_EMPTY) {
+        if (ser.need_a_comma) { _put(out, ",", 1);}
+        ser.need_a_comma = true;
+        _put(out, "\"", 1);
+        _put(out, nv->token, strlen(nv->token));
+        _put(out, "\":", 2);
+
+        switch (nv->valuetype)  {
+            case (TYPE_EMPTY):  {   break; }
+            case (TYPE_NULL):   {   _put(out, "null", 4);
+                                    break;
+                                }
+            case (TYPE_PARENT): {   _put(out, "{", 1);
+                                    ser.need_a_comma = false;
+                                    break;
+                                }
+            case (TYPE_FLOAT):  {   convert_outgoing_float(nv);
+                                    _put(out, num, floattoa(num, nv->value_flt, nv->precision));
+                                    break;
+                                }
+            case (TYPE_INTEGER):{   _put(out, num, inttoa(num, (int)nv->value_int));
+                                    break;
+                                }
+            case (TYPE_STRING): {   _put(out, "\"", 1);
+                                    _put(out, *nv->stringp, strlen(*nv->stringp));
+                                    _put(out, "\"", 1);
+                                    break;
+                                }
+            case (TYPE_BOOLEAN):{   if (!nv->value_int) {
+                                        _put(out, "false", 5);
+                                    } else {
+                                        _put(out, "true", 4);
                                     }
-                default: {}
-            }
+                                    break;
+                                }
+            case (TYPE_DATA):   {   uint32_t *v = (uint32_t*)&nv->value_int;
+                                    _put(out, num, sprintf(num, "\"0x%lx\"", *v));
+                                    break;
+                                }
+            case (TYPE_ARRAY):  {   _put(out, "[", 1);
+                                    _put(out, *nv->stringp, strlen(*nv->stringp));
+                                    _put(out, "]", 1);
+                                    break;
+                                }
+            default: {}
+        }
+    }
+    if ((ser.nv = nv->nx) == NULL) {                // end of the list - closing curlies and NEWLINE
+        while (ser.prev_depth-- > ser.initial_depth) {
+            _put(out, "}", 1);
         }
-        if (str >= str_max) { return (-1);}     // signal buffer overrun
-        if ((nv = nv->nx) == NULL) { break;}    // end of the list
+        _put(out, "}\n", 2);
+        return;
+    }
+    while (ser.nv->depth < ser.prev_depth--) {      // iterate the closing curlies
+        ser.need_a_comma = true;
+        _put(out, "}", 1);
+    }
+    ser.prev_depth = ser.nv->depth;
+}
+
+/*
+ * json_print_callback() - main loop callback to keep a streamed response moving
+ * json_print_finish()   - write out the rest of a streamed response (blocking)
+ * _stream_start()       - start streaming the nvObj list from nv
+ * _stream_send()        - write the stream chunk. Returns true once it's all written
+ * _stream_run()         - send and refill the chunk until the response is out (STAT_OK),
+ *                         or the TX device is full (STAT_EAGAIN - non-blocking only)
+ *
+ *  A response is serialized a chunk at a time into the TX device as it will take it, so a
+ *  large response such as {"$":n} doesn't hold the main loop while the host reads it.
+ *  json_print_callback() returns STAT_EAGAIN until the response is out, which holds off the
+ *  next command - its response would overwrite the nvObj list being serialized. For the same
+ *  reason nv_reset_nv_list() finishes any response first, and other output (exceptions,
+ *  text, printf) finishes it through xio so it doesn't land in the middle of the line.
+ */
 
-        while (nv->depth < prev_depth--) {      // iterate the closing curlies
-            need_a_comma = true;
-            *str++ = '}';
+stat_t json_print_callback()
+{
+    if (!js.stream_active) {
+        return (STAT_OK);
+    }
+    return (_stream_run(false));
+}
+
+void json_print_finish()
+{
+    if (js.stream_active) {
+        _stream_run(true);
+    }
+}
+
+static void _stream_start(nvObj_t *nv, const bool only_to_muted)
+{
+    json_print_finish();                            // one response at a time
+    js.stream = { nv, nv->depth, 0, false };
+    js.stream_to_muted = only_to_muted;
+    js.stream_chunk[0] = '{';                       // write opening curly
+    js.stream_len = 1;
+    js.stream_sent = 0;
+    js.stream_count = 0;
+    js.stream_active = true;
+    xio_set_partial_line(json_print_finish);
+    _stream_run(false);                             // send what the TX device will take now
+}
+
+static bool _stream_send(bool block)
+{
+    while (js.stream_sent < js.stream_len) {
+        size_t written = xio_write_some(&js.stream_chunk[js.stream_sent], js.stream_len - js.stream_sent, js.stream_to_muted);
+        if ((written == 0) && !block) {
+            return (false);
         }
-        prev_depth = nv->depth;
+        js.stream_sent += written;
     }
+    js.stream_count += js.stream_len;
+    js.stream_len = 0;
+    js.stream_sent = 0;
+    return (true);
+}
 
-    // closing curlies and NEWLINE
-    while (prev_depth-- > initial_depth) {
-        *str++ = '}';
+static stat_t _stream_run(bool block)
+{
+    uint32_t start_tick = SysTickTimer.getValue();
+    stat_t status = STAT_EAGAIN;
+
+    while (_stream_send(block)) {
+        if (js.stream.nv == NULL) {                 // response is out
+            js.stream_active = false;
+            xio_set_partial_line(nullptr);
+            if (js.stream_count > js.print_len_max) {
+                js.print_len_max = js.stream_count;
+            }
+            status = STAT_OK;
+            break;
+        }
+        jsSink_t out = { js.stream_chunk, js.stream_chunk + JSON_STREAM_CHUNK_LEN };
+        do {
+            _serialize_next(js.stream, out);
+        } while ((js.stream.nv != NULL) && ((out.end - out.wr) >= JSON_STREAM_REFILL_MIN));
+        js.stream_len = out.wr - js.stream_chunk;
     }
-    str += sprintf((char *)str, "}\n");         // using sprintf for this last one ensures a NUL termination
-    if (str > out_buf + size) {
-        return (-1);
+    uint32_t block_ms = SysTickTimer.getValue() - start_tick;
+    if (block_ms > js.print_block_max_ms) {
+        js.print_block_max_ms = block_ms;
     }
-    return (str - out_buf);
+    return (status);
 }
 
 /*
@@ -551,8 +629,7 @@ uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size)
  */
 void json_print_object(nvObj_t *nv)
 {
-    json_serialize(nv, cs.out_buf, sizeof(cs.out_buf));
-    xio_writeline(cs.out_buf);
+    _stream_start(nv, false);
 }
 
 /*
@@ -606,7 +683,7 @@ void json_print_response(uint8_t status, const bool only_to_muted /*= false*/)
     nvObj_t *nv = nv_body;
     if (status == STAT_JSON_SYNTAX_ERROR) {
         nv_reset_nv_list();
-        nv_add_string((const char *)"err", escape_string(cs.bufp, cs.saved_buf));
+        nv_add_string((const char *)"err", escape_string(cs.out_buf, cs.saved_buf, sizeof(cs.out_buf))); // the input line may not be in a writable buffer
 
     } else if ((cm->machine_state != MACHINE_INITIALIZING) || (status == STAT_INITIALIZING)) { // always do full echo during startup
         uint8_t nv_type;
@@ -667,10 +744,8 @@ void json_print_response(uint8_t status, const bool only_to_muted /*= false*/)
     strcpy(nv->token, "f");                                 // set it to Footer
     nv->nx = NULL;                                          // terminate the list
 
-    // serialize the JSON response and print it if there were no errors
-    if (json_serialize(nv_header, cs.out_buf, sizeof(cs.out_buf)) >= 0) {
-        xio_writeline(cs.out_buf, only_to_muted);
-    }
+    // stream the JSON response to the TX device (see json_print_callback())
+    _stream_start(nv_header, only_to_muted);
 }
 
 /***********************************************************************************
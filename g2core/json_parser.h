@@ -38,8 +38,9 @@
 #define FOOTER_REVISION 1
 
 #define JSON_INPUT_STRING_MAX 512   // set an arbitrary max
-#define JSON_OUTPUT_STRING_MAX (OUTPUT_BUFFER_LEN)
 #define MAX_PAD_CHARS 8             // JSON whitespace padding allowable
+#define JSON_STREAM_CHUNK_LEN 128   // responses are serialized to the TX device this much at a time
+#define JSON_STREAM_REFILL_MIN 64   // serialize another element into the chunk if this much is free
 
 typedef enum {
     JV_SILENT = 0,                  // [0] no response is provided for any command
@@ -61,6 +62,13 @@ typedef enum {                      // json output print modes
     JSON_RESPONSE_TO_MUTED_FORMAT   // print the header/body/footer as a response object, only to muted channels
 } jsonFormats;
 
+typedef struct jsSerializer {       // serializer position in an nvObj list - so it can stop and resume
+    nvObj_t *nv;                    // next object to serialize. NULL once the closing curlies are out
+    int8_t initial_depth;
+    int8_t prev_depth;
+    bool need_a_comma;
+} jsSerializer_t;
+
 typedef struct jsSingleton {
 
     /*** config values (PUBLIC) ***/
@@ -73,6 +81,16 @@ typedef struct jsSingleton {
     bool echo_json_gcode_block;
 
     /*** runtime values (PRIVATE) ***/
+    bool stream_active;             // a response is being streamed to the TX device
+    bool stream_to_muted;           // ...and only to muted channels
+    uint8_t stream_len;             // bytes serialized into stream_chunk
+    uint8_t stream_sent;            // bytes of stream_chunk written so far
+    uint32_t stream_count;          // bytes of the response written so far
+    jsSerializer_t stream;          // serializer state for the response
+    char stream_chunk[JSON_STREAM_CHUNK_LEN];
+
+    uint32_t print_block_max_ms;    // longest the main loop was held printing a response (diagnostic)
+    uint32_t print_len_max;         // longest response printed (diagnostic)
 
 } jsSingleton_t;
 
@@ -84,10 +102,11 @@ extern jsSingleton_t js;
 
 stat_t json_parser(char *str, bool suppress_response = false);
 void json_parse_for_exec(char *str, bool execute);
-uint16_t json_serialize(nvObj_t *nv, char *out_buf, uint16_t size);
 void json_print_object(nvObj_t *nv);
 void json_print_response(uint8_t status, const bool only_to_muted = false);
 void json_print_list(stat_t status, uint8_t flags);
+stat_t json_print_callback(void);
+void json_print_finish(void);
 
 stat_t js_get_ej(nvObj_t *nv);
 stat_t js_set_ej(nvObj_t *nv);
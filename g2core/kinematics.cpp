@@ -405,7 +405,7 @@ void kn_config_changed() {
 #endif
         ////##A Handle ABC special case linear for FabMo; AXIS_INHIBITED is used to flag ABC as linear
         // ... and thus can't be used in INHIBITED mode
-        if ((axis <= AXIS_Z) && cm->a[axis].axis_mode == AXIS_INHIBITED) {
+        if ((axis <= AXIS_Z) && cm->config->a[axis].axis_mode == AXIS_INHIBITED) {
             motor_map[motor] = -1;
             steps_per_unit[motor] = 1;  // this is the denominator above, avoid 0
         } else {
@@ -456,7 +456,7 @@ struct FourCableKinematics : KinematicsBase<axes, motors> {
             // J = (A_1-A_0)/T
             cable_jerk[joint] = (cable_accel[joint]-prev_cable_accel[joint])/segment_time;
 
-            // float jmax = cm->a[AXIS_X].jerk_max * JERK_MULTIPLIER * 1.5; // 1.5 margin for cartesian plan to cable jerk
+            // float jmax = cm->config->a[AXIS_X].jerk_max * JERK_MULTIPLIER * 1.5; // 1.5 margin for cartesian plan to cable jerk
             bool jerk_or_velocity_adjusted = false;
             // if (cable_jerk[joint] > jmax) {
             //     cable_jerk[joint] = jmax;
@@ -476,7 +476,7 @@ struct FourCableKinematics : KinematicsBase<axes, motors> {
             }
 
             // limit velocity
-            const double vmax = cm->a[AXIS_X].velocity_max * 1.7;
+            const double vmax = cm->config->a[AXIS_X].velocity_max * 1.7;
             if (cable_vel[joint] < -vmax) {
                 cable_vel[joint] = -vmax;
                 jerk_or_velocity_adjusted = true;
@@ -830,7 +830,7 @@ struct FourCableKinematics : KinematicsBase<axes, motors> {
             //     cable_vel[joint] = 50.0; // it's already stopped, back it off some
             // }
 
-            float jmax = cm->a[AXIS_X].jerk_high * JERK_MULTIPLIER;
+            float jmax = cm->config->a[AXIS_X].jerk_high * JERK_MULTIPLIER;
             cable_jerk[joint] = sensor_diff[joint] * jmax;
             cable_accel[joint] = cable_accel[joint] + cable_jerk[joint]*segment_time;
 
@@ -842,7 +842,7 @@ struct FourCableKinematics : KinematicsBase<axes, motors> {
             cable_vel[joint] = cable_vel[joint] + cable_accel[joint]*segment_time;
 
             // limit velocity
-            const double vmax = cm->a[AXIS_X].velocity_max;
+            const double vmax = cm->config->a[AXIS_X].velocity_max;
             if (cable_vel[joint] < -vmax) {
                 cable_vel[joint] = -vmax;
                 // error_offset = 0; // none of it was applied
@@ -162,8 +162,8 @@ struct PressureKinematics : KinematicsBase<axes, motors> {
                 motor_offset[motor] = steps - (joint_position[joint] * steps_per_unit[motor]);
             }
 
-            joint_max_limit[joint] = joint_position[joint] + cm->a[joint].travel_max;
-            joint_min_limit[joint] = joint_position[joint] + cm->a[joint].travel_min;
+            joint_max_limit[joint] = joint_position[joint] + cm->config->a[joint].travel_max;
+            joint_min_limit[joint] = joint_position[joint] + cm->config->a[joint].travel_min;
         }
     }
 
@@ -235,8 +235,8 @@ struct PressureKinematics : KinematicsBase<axes, motors> {
             // This, solved for motor_offset: step_position[motor] = (position[joint]] * steps_per_unit[motor]) + motor_offset[motor];
             motor_offset[motor] = step_position[motor] - (position[joint] * steps_per_unit[motor]);
 
-            joint_max_limit[joint] = position[joint] + cm->a[joint].travel_max;
-            joint_min_limit[joint] = position[joint] + cm->a[joint].travel_min;
+            joint_max_limit[joint] = position[joint] + cm->config->a[joint].travel_max;
+            joint_min_limit[joint] = position[joint] + cm->config->a[joint].travel_min;
         }
     }
 
@@ -427,13 +427,13 @@ struct PressureKinematics : KinematicsBase<axes, motors> {
                     change_state_to_idle();
                 }
                 if (!last_switch_state[joint]) {
-                    joint_min_limit[joint] = joint_position[joint] + cm->a[AXIS_X].travel_min;
+                    joint_min_limit[joint] = joint_position[joint] + cm->config->a[AXIS_X].travel_min;
                 }
 
             } else if (!switch_state) {
                 if (last_switch_state[joint]) {
                     // just left the switch, record how far we can go
-                    joint_max_limit[joint] = joint_position[joint] + cm->a[AXIS_X].travel_max;
+                    joint_max_limit[joint] = joint_position[joint] + cm->config->a[AXIS_X].travel_max;
                 } else {
                     // check to make sure we haven't gone too far
                     if (joint_position[joint] > joint_max_limit[joint]) {
@@ -445,8 +445,8 @@ struct PressureKinematics : KinematicsBase<axes, motors> {
             // prev_joint_accel[joint] = joint_accel[joint];
             start_velocities[joint] = std::abs(joint_vel[joint]);
 
-            double jmax = cm->a[AXIS_X].jerk_max * JERK_MULTIPLIER;
-            const double vmax = cm->a[AXIS_X].velocity_max;
+            double jmax = cm->config->a[AXIS_X].jerk_max * JERK_MULTIPLIER;
+            const double vmax = cm->config->a[AXIS_X].velocity_max;
 
             prev_joint_position[joint] = joint_position[joint];
             double old_joint_vel = joint_vel[joint];
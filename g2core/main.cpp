@@ -32,6 +32,7 @@
 #include "stepper.h"
 #include "coolant.h"
 #include "encoder.h"
+#include "telemetry.h"
 #include "spindle.h"
 #include "temperature.h"
 #include "gpio.h"
@@ -104,6 +105,9 @@ void application_init_machine(void)
 
     stepper_init();                     // stepper subsystem
     encoder_init();                     // virtual encoders
+#ifdef __TELEMETRY
+    telemetry_init();                   // position telemetry (started by config_init())
+#endif
     gpio_init();                        // inputs and outputs
 }
 
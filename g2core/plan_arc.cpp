@@ -22,11 +22,13 @@
 #include "canonical_machine.h"
 #include "plan_arc.h"
 #include "planner.h"
+#include "stepper.h"
 #include "util.h"
 
 // Local functions
 
 static stat_t _compute_arc(const bool radius_f);
+static void _compute_arc_segments(void);
 static void _compute_arc_offsets_from_radius(void);
 static stat_t _test_arc_soft_limits(void);
 
@@ -140,8 +142,10 @@ stat_t cm_arc_feed_global(const float target[], const bool target_f[],     // ta
  * cm_arc_feed_mm() - canonical machine entry point for arcs;
  *                    mm units - for internal use
  *
- * Generates an arc by queuing line segments to the move buffer. The arc is
- * approximated by generating a large number of tiny, linear segments.
+ * With __NATIVE_ARCS the arc is queued as a single arc block that the runtime
+ * interpolates along the arc (see mp_arc()). Otherwise, or if the coordinate system
+ * is rotated, the arc is approximated by queuing a large number of tiny, linear
+ * segments from cm_arc_callback().
  */
 
 stat_t cm_arc_feed_mm(const float target[], const bool target_f[],     // target endpoint
@@ -262,7 +266,7 @@ stat_t cm_arc_feed_mm(const float target[], const bool target_f[],     // target
     }
 
     // *** now get down to the rest of the work setting up the arc for execution ***
-    cm->gm.motion_mode = motion_mode;
+    cm_set_motion_mode(MODEL, motion_mode);
     cm_set_display_offsets(MODEL);                        // capture the fully resolved offsets to gm
     memcpy(&(cm->arc.gm), MODEL, sizeof(GCodeState_t));   // copy GCode context to arc singleton - some will be overwritten to run segments
     copy_vector(cm->arc.position, cm->gmx.position);        // set initial arc position from gcode model
@@ -292,12 +296,28 @@ stat_t cm_arc_feed_mm(const float target[], const bool target_f[],     // target
     // test arc soft limits
     stat_t status = _test_arc_soft_limits();
     if (status != STAT_OK) {
-        cm->gm.motion_mode = MOTION_MODE_CANCEL_MOTION_MODE;
+        cm_set_motion_mode(MODEL, MOTION_MODE_CANCEL_MOTION_MODE);
         copy_vector(cm->gm.target, cm->arc.position);       // reset model position
         return (cm_alarm(status, "arc soft_limits"));       // throw an alarm
     }
 
     cm_cycle_start();                                       // if not already started
+
+#ifdef __NATIVE_ARCS
+    if (mp_arc_is_native()) {                               // queue the whole arc as one block
+        status = mp_arc(&cm->arc);
+        cm_update_model_position();
+        if (status == STAT_MINIMUM_LENGTH_MOVE) {           // same handling as cm_straight_feed_mm()
+            if (!mp_has_runnable_buffer(mp) && !st_runtime_isbusy()) {
+                cm_cycle_end();
+            }
+            status = STAT_OK;
+        }
+        return (status);
+    }
+#endif
+
+    _compute_arc_segments();
     cm->arc.run_state = BLOCK_ACTIVE;                       // enable arc to be run from the callback
     cm_update_model_position();
     return (STAT_OK);
@@ -389,21 +409,29 @@ static stat_t _compute_arc(const bool radius_f)
 
     // Find the minimum number of segments that meet accuracy and time constraints...
     // Note: removed segment_length test as segment_time accounts for this (build 083.37)
-    float segments_for_chordal_accuracy = cm->arc.length / sqrt(4*cm->chordal_tolerance * (2 * cm->arc.radius - cm->chordal_tolerance));
+    float segments_for_chordal_accuracy = cm->arc.length / sqrt(4*cm->config->chordal_tolerance * (2 * cm->arc.radius - cm->config->chordal_tolerance));
     cm->arc.segments = std::floor(segments_for_chordal_accuracy);
     cm->arc.segments = std::max(cm->arc.segments, (float)1.0);        //...but is at least 1 segment
 
+    // setup the rest of the arc parameters
+    cm->arc.center_0 = cm->arc.position[cm->arc.plane_axis_0] - sin(cm->arc.theta) * cm->arc.radius;
+    cm->arc.center_1 = cm->arc.position[cm->arc.plane_axis_1] - cos(cm->arc.theta) * cm->arc.radius;
+    return (STAT_OK);
+}
+
+/*
+ * _compute_arc_segments() - set up the arc to be run as line segments by cm_arc_callback()
+ */
+
+static void _compute_arc_segments()
+{
     if (cm->arc.gm.feed_rate_mode == INVERSE_TIME_MODE) {
         cm->arc.gm.feed_rate /= cm->arc.segments;
     }
-    // setup the rest of the arc parameters
     cm->arc.segment_count = (int32_t)cm->arc.segments;
     cm->arc.segment_theta = cm->arc.angular_travel / cm->arc.segments;
     cm->arc.segment_linear_travel = cm->arc.linear_travel / cm->arc.segments;
-    cm->arc.center_0 = cm->arc.position[cm->arc.plane_axis_0] - sin(cm->arc.theta) * cm->arc.radius;
-    cm->arc.center_1 = cm->arc.position[cm->arc.plane_axis_1] - cos(cm->arc.theta) * cm->arc.radius;
     cm->arc.gm.target[cm->arc.linear_axis] = cm->arc.position[cm->arc.linear_axis];    // initialize the linear target
-    return (STAT_OK);
 }
 
 /*
@@ -583,11 +611,11 @@ static stat_t _test_arc_soft_limit_plane_axis(float center, uint8_t plane_axis)
         if (arc.angular_travel < M_PI) {                            // case (1)
             return (STAT_OK);
         }
-        if ((center - arc.radius) < cm->a[plane_axis].travel_min) {    // case (2)
+        if ((center - arc.radius) < cm->config->a[plane_axis].travel_min) {    // case (2)
             return (STAT_SOFT_LIMIT_EXCEEDED);
         }
     }
-    if ((center + arc.radius) > cm->a[plane_axis].travel_max) {        // cases (3) and (4)
+    if ((center + arc.radius) > cm->config->a[plane_axis].travel_max) {        // cases (3) and (4)
         return (STAT_SOFT_LIMIT_EXCEEDED);
     }
     return(STAT_OK);
@@ -596,7 +624,7 @@ static stat_t _test_arc_soft_limit_plane_axis(float center, uint8_t plane_axis)
 static stat_t _test_arc_soft_limits()
 {
 /*
-    if (cm->soft_limit_enable == true) {
+    if (cm->config->soft_limit_enable == true) {
 
         // Test if target falls outside boundaries. This is a 3 dimensional test
         // so it also checks the linear axis of the arc (helix axis)
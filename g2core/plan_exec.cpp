@@ -45,8 +45,16 @@ static stat_t _exec_aline_tail(mpBuf_t *bf);
 static stat_t _exec_aline_segment(void);
 static void   _exec_aline_normalize_block(mpBlockRuntimeBuf_t *b);
 static stat_t _exec_aline_feedhold(mpBuf_t *bf);
+static void   _exec_arc_point(const float distance, float point[]);
+static float  _exec_remaining_length(void);
+static float  _exec_override_target(void);
+static void   _exec_override(void);
 
 static void _init_forward_diffs(float v_0, float v_1);
+static float _exec_segments(const float section_time, const float delta_v);
+
+static inline mpFixed_t _to_fixed(const float x) { return ((mpFixed_t)(x * POSITION_FIXED_ONE)); }
+static inline float _to_float(const mpFixed_t x) { return ((float)x / POSITION_FIXED_ONE); }
 
 
 /****************************************************************************************
@@ -155,6 +163,29 @@ static void _init_forward_diffs(float v_0, float v_1);
  *
  *       (Note: all COMMAND(s) in 2j. should be in PLANNED state)
  */
+/*
+ * _exit_is_queue_limited() - true if the block's exit velocity is set by braking to the end of the queue
+ *
+ *  A block exits below its exit_vmax for many reasons - a corner, a command, a cruise ahead.
+ *  It's only queue limited if the perfect decelerations that follow it run all the way to
+ *  the end of the back-planned queue, so the stop it brakes for is just where the queue ends.
+ */
+static bool _exit_is_queue_limited(const mpBuf_t *bf, const float exit_velocity)
+{
+    if (!VELOCITY_LT(exit_velocity, bf->exit_vmax)) {
+        return (false);
+    }
+    for (const mpBuf_t *nx = bf->nx; nx != bf; nx = nx->nx) {
+        if (nx->buffer_state < MP_BUFFER_BACK_PLANNED) {
+            return (true);                          // end of the planned queue
+        }
+        if (nx->hint != PERFECT_DECELERATION) {
+            return (false);                         // something real ahead sets the braking
+        }
+    }
+    return (false);
+}
+
 /*
  * _plan_aline() - mp_forward_plan() helper
  *
@@ -180,6 +211,11 @@ static stat_t _plan_aline(mpBuf_t *bf, float entry_velocity)
     debug_trap_if_true((block->head_length < 0.00001 && block->body_length < 0.00001 && block->tail_length < 0.00001),
         "_plan_line() zero or negative length block after calculate_ramps()");
 
+    // count moves that had to slow down because there wasn't enough time queued behind them
+    if (mp->block_timeout.isSet() && _exit_is_queue_limited(bf, block->exit_velocity)) {
+        qr.queue_limited++;
+    }
+
     bf->buffer_state = MP_BUFFER_FULLY_PLANNED;     //...here
     bf->plannable = false;
     return (STAT_OK);                               // report that we planned something...
@@ -260,9 +296,18 @@ stat_t mp_exec_move()
         if (kn->idle_task()) {
             return STAT_OK; // IOW: we need something loaded
         }
+        // Starvation: moving, and a block is queued that the planner hasn't got to yet.
+        // This is called again for every null segment, so count each stall once.
+        if ((cm->motion_state == MOTION_RUN) && (mp_get_queued_buffers(mp) > 0)) {
+            if (!qr.starved) {
+                qr.starvations++;
+                qr.starved = true;
+            }
+        }
         st_prep_null();
         return (STAT_NOOP); // IOW: exec is done, nothing to load here, move on
     }
+    qr.starved = false;
 
     if (bf->block_type == BLOCK_TYPE_ALINE) {           // cycle auto-start for lines only
         // first-time operations
@@ -437,7 +482,8 @@ stat_t mp_exec_aline(mpBuf_t *bf)
             "mp_exec_aline() mr->exit_velocity > mr->r->cruise_velocity");
 
         // Start a new move by setting up the runtime singleton (mr)
-        memcpy(&mr->gm, &(bf->gm), sizeof(GCodeState_t));   // copy in the gcode model state
+        mp_get_block_gm(bf, &mr->gm);                       // copy in the gcode model state
+        sr_flag_change(SR_CHANGED_MODEL);                   // reports read the runtime model while moving
         bf->block_state = BLOCK_ACTIVE;                     // note that this buffer is running
         mr->block_state = BLOCK_INITIAL_ACTION;             // note the planner doesn't look at block_state
 
@@ -453,8 +499,30 @@ stat_t mp_exec_aline(mpBuf_t *bf)
 
         // transfer move parameters from planner buffer to the runtime
         copy_vector(mr->unit, bf->unit);
-        copy_vector(mr->target, bf->gm.target);
+        copy_vector(mr->target, bf->target);
         copy_vector(mr->axis_flags, bf->axis_flags);
+        for (uint8_t axis=0; axis<AXES; axis++) {       // seed the master position (see _exec_aline_segment())
+            mr->position_fixed[axis] = _to_fixed(mr->position[axis]);
+        }
+
+        mr->arc_active = (bf->arc != nullptr);          // native arcs interpolate from their geometry
+        if (mr->arc_active) {
+            mr->arc = *bf->arc;
+            copy_vector(mr->arc_start, mr->position);
+            mr->arc_distance = 0;
+        }
+
+        // Rebase the runtime override to the factor this block was planned with, so a block
+        // already slowed in planning is not slowed again by the scale left from the last one
+        float override_planned = (bf->override_factor > EPSILON) ? bf->override_factor : 1.0;
+        mr->override_headroom = std::max((float)1.0, bf->absolute_vmax / mr->r->cruise_velocity);
+        mr->override_scale *= mr->override_planned / override_planned;
+        mr->override_scale = std::max((float)FEED_OVERRIDE_MIN, std::min(mr->override_scale, mr->override_headroom));
+        mr->override_planned = override_planned;
+        if (fp_ZERO(mr->entry_velocity)) {              // starting from rest - no need to ramp the override
+            mr->override_scale = _exec_override_target();
+            mr->override_rate = 0;
+        }
 
         mr->run_bf = bf;                                // DIAGNOSTIC: points to running bf
         mr->plan_bf = bf->nx;                           // DIAGNOSTIC: points to next bf to forward plan
@@ -484,15 +552,28 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         }          
 
         // generate the way points for position correction at section ends
+        // The tail always ends exactly on the target, so position error never carries into the next block
+        float point[AXES];
+        for (uint8_t section=SECTION_HEAD; section<SECTION_TAIL; section++) {
+            float distance = mr->r->head_length + ((section == SECTION_BODY) ? mr->r->body_length : 0);
+            if (mr->arc_active) {
+                mr->arc_waypoint[section] = distance;
+                _exec_arc_point(distance, point);
+                for (uint8_t axis=0; axis<AXES; axis++) {
+                    mr->waypoint[section][axis] = _to_fixed(point[axis]);
+                }
+            } else {
+                for (uint8_t axis=0; axis<AXES; axis++) {
+                    mr->waypoint[section][axis] = mr->position_fixed[axis] + _to_fixed(mr->unit[axis] * distance);
+                }
+            }
+        }
+        mr->arc_waypoint[SECTION_TAIL] = mr->r->head_length + mr->r->body_length + mr->r->tail_length;
         for (uint8_t axis=0; axis<AXES; axis++) {
-            mr->waypoint[SECTION_HEAD][axis] = mr->position[axis] + mr->unit[axis] * mr->r->head_length;
-            mr->waypoint[SECTION_BODY][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length);
-            mr->waypoint[SECTION_TAIL][axis] = mr->position[axis] + mr->unit[axis] * (mr->r->head_length + mr->r->body_length + mr->r->tail_length);
+            mr->waypoint[SECTION_TAIL][axis] = _to_fixed(mr->target[axis]);
         }
     }
 
-    // Feed Override Processing - We need to handle the following cases (listed in rough sequence order):
-
     // Feedhold Processing - We need to handle the following cases (listed in rough sequence order):
     if (cm->hold_state != FEEDHOLD_OFF) {
         // if running actions, or in HOLD state, or exiting with actions
@@ -546,6 +627,13 @@ stat_t mp_exec_aline(mpBuf_t *bf)
         cm_set_motion_state(MOTION_RUN);
     }
 
+    // A merged line reports its first line number until it reaches the newest merged line
+    if ((bf->last_line_length > 0) && (mr->gm.linenum != bf->last_linenum) &&
+        (_exec_remaining_length() <= bf->last_line_length)) {
+        mr->gm.linenum = bf->last_linenum;
+        sr_flag_change(SR_CHANGED_MODEL);
+    }
+
     // There are 4 things that can happen here depending on return conditions:
     //  status        bf->block_state       Description
     //  -----------   --------------        ----------------------------------------
@@ -748,6 +836,35 @@ static void _init_forward_diffs(const float v_0, const float v_1)
     mr->target_velocity = v_0 + mr->forward_diff_5;
 }
 
+/*********************************************************************************************
+ * _exec_segments() - choose the number of segments for a head, body or tail
+ *
+ *  The steppers run each segment as a linear velocity ramp (see st_prep_line()), which
+ *  departs from the section's velocity curve by up to h^2/8 |v''| for a segment of time h.
+ *  Heads and tails follow v = v_0 + dv (10t^3 - 15t^4 + 6t^5) with t = time/T, so |v''|
+ *  peaks at (10/sqrt(3)) dv/T^2. Segments are made as long as SEGMENT_VELOCITY_ERROR
+ *  allows, between NOM_SEGMENT_TIME and MAX_SEGMENT_TIME. A body has v'' = 0 and runs at
+ *  MAX_SEGMENT_TIME, so long cruises take a fraction of the segments they used to.
+ *
+ *  The floor stays at NOM_SEGMENT_TIME (2x MIN_SEGMENT_TIME) so that splitting a section
+ *  into equal segments can never make one shorter than MIN_SEGMENT_TIME. Segments within
+ *  a section are always equal, as the forward differences require.
+ */
+
+static float _exec_segments(const float section_time, const float delta_v)
+{
+    const float v_dd = 5.77350269 * std::abs(delta_v) / (section_time * section_time);  // 10/sqrt(3) dv/T^2
+    float segment_time = MAX_SEGMENT_TIME;
+    if (v_dd > EPSILON) {
+        segment_time = std::min(segment_time, (float)sqrt(8 * SEGMENT_VELOCITY_ERROR / v_dd));
+    }
+    segment_time = std::max(segment_time, NOM_SEGMENT_TIME);
+
+    float segments = ceil(section_time / segment_time);
+    PROFILE_SEGMENT_ERROR(v_dd * square(section_time / segments) / 8);
+    return (segments);
+}
+
 /*********************************************************************************************
  * _exec_aline_head()
  */
@@ -759,7 +876,7 @@ static stat_t _exec_aline_head(mpBuf_t *bf)
             mr->section = SECTION_BODY;
             return(_exec_aline_body(bf));                              // skip ahead to the body generator
         }
-        mr->segments = ceil(uSec(mr->r->head_time) / NOM_SEGMENT_USEC);    // # of segments for the section
+        mr->segments = _exec_segments(mr->r->head_time, mr->r->cruise_velocity - mr->entry_velocity);
         mr->segment_count = (uint32_t)mr->segments;
         mr->segment_time = mr->r->head_time / mr->segments;            // time to advance for each segment
 
@@ -812,7 +929,7 @@ static stat_t _exec_aline_body(mpBuf_t *bf)
         }
 
         float body_time = mr->r->body_time;
-        mr->segments = ceil(uSec(body_time) / NOM_SEGMENT_USEC);
+        mr->segments = _exec_segments(body_time, 0);
         mr->segment_time = body_time / mr->segments;
         mr->segment_velocity = mr->r->cruise_velocity;
         mr->target_velocity = mr->segment_velocity;
@@ -846,7 +963,7 @@ static stat_t _exec_aline_tail(mpBuf_t *bf)
         bf->plannable = false;
 
         if (fp_ZERO(mr->r->tail_length)) { return(STAT_OK);}         // end the move
-        mr->segments = ceil(uSec(mr->r->tail_time) / NOM_SEGMENT_USEC);// # of segments for the section
+        mr->segments = _exec_segments(mr->r->tail_time, mr->r->cruise_velocity - mr->r->exit_velocity);
         mr->segment_count = (uint32_t)mr->segments;
         mr->segment_time = mr->r->tail_time / mr->segments;          // time to advance for each segment
 
@@ -901,6 +1018,7 @@ static stat_t _exec_aline_tail(mpBuf_t *bf)
 
 float exec_target_steps[MOTORS];
 float exec_travel_steps[MOTORS];
+static mpFixed_t exec_target_fixed[AXES];
 
 static stat_t _exec_aline_segment()
 {
@@ -908,25 +1026,31 @@ static stat_t _exec_aline_segment()
     // If the segment ends on a section waypoint synchronize to the head, body or tail end
     // Otherwise if not at a section waypoint compute target from segment time and velocity
     // Don't do waypoint correction if you are going into a hold.
-    ////## If I undertand the waypoint correctly, this is just a minor replacement of whatever
-    ////     ... value may have wandered in. Not currently thinking it is of much interest.    
+    //
+    // The master position is kept in 32.32 fixed point (mr->position_fixed), seeded from
+    // mr->position when the block starts. Lines add each segment's length to it exactly, so
+    // float rounding never accumulates over a block no matter how far it is from the origin.
+    // The float target handed to the kinematics is rounded from the master position once
+    // per segment - it is always within half a float ULP of the exact position.
 
     if ((--mr->segment_count == 0) && (cm->hold_state == FEEDHOLD_OFF)) {
-        copy_vector(mr->gm.target, mr->waypoint[mr->section]);
+        copy_vector(exec_target_fixed, mr->waypoint[mr->section]);
+        mr->arc_distance = mr->arc_waypoint[mr->section];
+    } else if (mr->arc_active) {
+        mr->arc_distance += (mr->segment_velocity+mr->target_velocity) * 0.5 * mr->segment_time;
+        _exec_arc_point(mr->arc_distance, mr->gm.target);   // arc points are computed from the arc start
+        for (uint8_t a=0; a<AXES; a++) {
+            exec_target_fixed[a] = _to_fixed(mr->gm.target[a]);
+        }
     } else {
         float segment_length = (mr->segment_velocity+mr->target_velocity) * 0.5 * mr->segment_time;
-        // See https://en.wikipedia.org/wiki/Kahan_summation_algorithm
-        // for the summation compensation description
         for (uint8_t a=0; a<AXES; a++) {
-            // The following is equivalent to:
-            // mr->gm.target[a] = mr->position[a] + (mr->unit[a] * segment_length);
-
-            float to_add = (mr->unit[a] * segment_length) - mr->gm.target_comp[a];
-            float target = mr->position[a] + to_add;
-            mr->gm.target_comp[a] = (target - mr->position[a]) - to_add;
-            mr->gm.target[a] = target;
+            exec_target_fixed[a] = mr->position_fixed[a] + _to_fixed(mr->unit[a] * segment_length);
         }
     }
+    for (uint8_t a=0; a<AXES; a++) {
+        mr->gm.target[a] = _to_float(exec_target_fixed[a]);
+    }
 
     // Convert target position to steps
     ////## As far as I can tell, this is the only point real steps are swapped in to the
@@ -935,6 +1059,9 @@ static stat_t _exec_aline_segment()
     ////   Now corrected by converting locations to nearest true step location in plan_line.cpp
     kn->inverse_kinematics(mr->gm, mr->gm.target, mr->position, mr->segment_velocity, mr->target_velocity, mr->segment_time, exec_target_steps);
 
+    // Advance the runtime feed override. It scales the stepper time of this segment, not its length
+    _exec_override();
+
     // Update the mb->run_time_remaining -- we know it's missing the current segment's time before it's loaded, that's ok.
     mp->run_time_remaining -= mr->segment_time;
     if (mp->run_time_remaining < 0) {
@@ -943,14 +1070,111 @@ static stat_t _exec_aline_segment()
 
     // Set the target steps and call the stepper prep function
     ritorno(mp_set_target_steps(exec_target_steps));
+    PROFILE_INC_SEGMENTS;
 
     copy_vector(mr->position, mr->gm.target);               // update position from target
+    copy_vector(mr->position_fixed, exec_target_fixed);
+    sr_flag_change(SR_CHANGED_RUNTIME);
     if (mr->segment_count == 0) {
         return (STAT_OK);                                   // this section has run all its segments
     }
     return (STAT_EAGAIN);                                   // this section still has more segments to run
 }
 
+/*********************************************************************************************
+ * _exec_arc_point() - point on the running native arc at a distance along the arc
+ * _exec_remaining_length() - distance left to run in the running block
+ *
+ *  The plane axes follow the circle (see _compute_arc() in plan_arc.cpp for the angle
+ *  convention). All other axes, including the linear axis of a helix, move linearly with
+ *  the distance along the arc. Points are computed from the arc start, not accumulated
+ *  from the previous segment, so the arc does not drift off its radius.
+ */
+
+static void _exec_arc_point(const float distance, float point[])
+{
+    float fraction = distance / mr->arc.length;
+    float theta = mr->arc.theta + mr->arc.angular_travel * fraction;
+
+    for (uint8_t axis=0; axis<AXES; axis++) {
+        point[axis] = mr->arc_start[axis] + (mr->target[axis] - mr->arc_start[axis]) * fraction;
+    }
+    point[mr->arc.plane_axis_0] = mr->arc.center_0 + sin(theta) * mr->arc.radius;
+    point[mr->arc.plane_axis_1] = mr->arc.center_1 + cos(theta) * mr->arc.radius;
+}
+
+static float _exec_remaining_length()
+{
+    if (mr->arc_active) {
+        return (mr->arc.length - mr->arc_distance);
+    }
+    return (get_axis_vector_length(mr->target, mr->position));
+}
+
+/*********************************************************************************************
+ * _exec_override_target() - runtime override needed to run the block at the requested override
+ * _exec_override() - advance the runtime override by one segment
+ *
+ *  The running block was planned with the override in effect when it was forward planned.
+ *  The runtime override is the requested override divided by that one, so turning the knob
+ *  down slows the running and already planned blocks on the next segment.
+ *
+ *  Turning the knob up speeds up the body of the running block on the next segment as well,
+ *  up to its velocity headroom: absolute_vmax over the planned cruise velocity, and no more
+ *  than would make a segment shorter than MIN_SEGMENT_TIME. Heads and tails are capped at
+ *  1.0. Running a ramp faster scales its jerk by the cube of the override, and planned
+ *  ramps already use the axis jerk. So the override comes back down to 1.0 before the body
+ *  ends, starting as soon as the rest of the body is only just long enough to ramp it down.
+ *  Later blocks take the new factor in full as they are forward planned.
+ *
+ *  When a block loads, the runtime override is rebased from the factor the last block was
+ *  planned with to the factor this one was (see mp_exec_aline()). Otherwise a block that was
+ *  forward planned after the knob was turned down would be slowed twice - once in planning
+ *  and again by the runtime override - and then ramp back up.
+ *
+ *  The runtime override moves to its target along an S-curve: the rate of change is limited
+ *  to override_rate_max, the rate itself changes by at most override_rate_max per
+ *  FEED_OVERRIDE_JERK_TIME, and it slows in time to stop on the target. The stepper time of
+ *  each segment is divided by the runtime override (see mp_set_target_steps()), which
+ *  scales velocity by the override and leaves the segment lengths and waypoints unchanged.
+ */
+
+static float _exec_override_target()
+{
+    float target = mp_get_override_factor(mr->gm.motion_mode) / mr->override_planned;
+    float target_max = 1.0;
+    if ((mr->section == SECTION_BODY) && (mr->section_state == SECTION_RUNNING)) {
+        float body_left = mr->segment_count * mr->segment_time * 60 / mr->override_scale;   // seconds
+        float ramp_down = (mr->override_scale - 1) / mr->override_rate_max + 2 * FEED_OVERRIDE_JERK_TIME;
+        if (body_left > ramp_down) {
+            target_max = std::min(mr->override_headroom, mr->segment_time / MIN_SEGMENT_TIME);
+        }
+    }
+    return (std::max((float)FEED_OVERRIDE_MIN, std::min(target, target_max)));
+}
+
+static void _exec_override()
+{
+    float error = _exec_override_target() - mr->override_scale;
+    if (fp_ZERO(error) && fp_ZERO(mr->override_rate)) {
+        return;
+    }
+    float dt = mr->segment_time * 60 / mr->override_scale;     // seconds the segment takes to run
+    float jerk = mr->override_rate_max / FEED_OVERRIDE_JERK_TIME;
+    float rate_wanted = copysignf(std::min(mr->override_rate_max, (float)sqrt(2 * jerk * std::abs(error))), error);
+    float rate_change = std::max(-jerk * dt, std::min(rate_wanted - mr->override_rate, jerk * dt));
+
+    mr->override_rate += rate_change;
+    float change = mr->override_rate * dt;
+    if ((change * error >= 0) && (std::abs(change) >= std::abs(error))) {   // arrived
+        mr->override_scale += error;
+        mr->override_rate = 0;
+    } else {
+        mr->override_scale += change;
+    }
+    mr->override_scale = std::max((float)FEED_OVERRIDE_MIN, std::min(mr->override_scale, mr->override_headroom));
+}
+
 /*********************************************************************************************
  * _exec_aline_normalize_block() - re-organize block to eliminate minimum time segments
  *
@@ -1044,13 +1268,19 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
 
             // Otherwise setup the block to complete motion (regardless of how hold will ultimately be exited)
             else {
-                bf->length = get_axis_vector_length(mr->position, mr->target);  // update bf w/remaining length in move
+                bf->length = _exec_remaining_length();          // update bf w/remaining length in move
 
                 // If length ~= 0 it's because the deceleration was exact. Handle this exception to avoid planning errors
                 if (bf->length < EPSILON4) {
                     copy_vector(mp->position, mr->position);// update planner position to the final runtime position
                     mp_free_run_buffer();                   // advance to next block, discarding the zero-length move
                 } else {
+                    if (mr->arc_active) {                   // restart a native arc from the hold point
+                        float fraction = mr->arc_distance / mr->arc.length;
+                        bf->arc->theta = mr->arc.theta + mr->arc.angular_travel * fraction;
+                        bf->arc->angular_travel = mr->arc.angular_travel * (1 - fraction);
+                        bf->arc->length = bf->length;
+                    }
                     bf->block_state = BLOCK_INITIAL_ACTION;   // tell _exec to re-use the bf buffer
                     while (bf->buffer_state > MP_BUFFER_BACK_PLANNED) {
                         bf->buffer_state = MP_BUFFER_BACK_PLANNED;// revert from RUNNING so it can be forward planned again
@@ -1119,7 +1349,7 @@ static stat_t _exec_aline_feedhold(mpBuf_t *bf)
         // enough (to EPSILON2) (1e). Case 1e happens frequently when the tail in the move was
         // already planned to zero. EPSILON2 deals with floating point rounding errors that can
         // mis-classify this case. EPSILON2 is 0.0001, which is 0.1 microns in length.
-        float available_length = get_axis_vector_length(mr->target, mr->position);
+        float available_length = _exec_remaining_length();
 
         // Cases (1b1, 1c1) deceleration will fit in the block
         if ((available_length + EPSILON2 - mr->r->tail_length) > 0) {
@@ -53,7 +53,25 @@ static mpBuf_t* _plan_block(mpBuf_t* bf);
 
 static void _calculate_jerk(mpBuf_t* bf);
 static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const float axis_square[]);
+static void _sample_block_length(const mpBuf_t* bf);
 static void _calculate_junction_vmax(mpBuf_t* bf);
+static void _calculate_exit_vmax(mpBuf_t* bf);
+static void _calculate_arc_vmax(mpBuf_t* bf);
+static void _arc_envelope(const float theta, const float angular_travel, float* max_sin, float* max_cos);
+static float _to_step_location(const float value, const uint8_t axis);
+static void _plan_blend(const GCodeState_t* _gm, const float target[]);
+static bool _plan_merge(const GCodeState_t* _gm, const float target[]);
+static bool _last_block_is_editable(mpBuf_t* bf);
+static bool _plan_is_usable(void);
+
+static struct mpMerge {                 // line merger state - only ever describes the last queued line
+    mpBuf_t* bf;                        // line that may be extended, or nullptr
+    uint8_t vertices;                   // number of endpoints merged into it so far
+    float start[AXES];                  // start position of the line
+    float vertex[MERGE_MAX_VERTICES][AXES]; // merged endpoints, checked against every new extension
+} _merge;
+
+static const mpStoredPlan_t* _stored_plan = nullptr;   // plan for the next line queued (see mp_set_stored_plan())
 
 
 #ifdef __PLANNER_DIAGNOSTICS
@@ -77,10 +95,10 @@ static void _set_bf_diagnostics(mpBuf_t* bf) {}
  *                                      that were in effect at move planning time
  */
 
-void  mp_zero_segment_velocity() { mr->segment_velocity = 0; }
+void  mp_zero_segment_velocity() { mr->segment_velocity = 0; sr_flag_change(SR_CHANGED_RUNTIME); }
 float mp_get_runtime_velocity(void) { return (mr->segment_velocity); }
 float mp_get_runtime_absolute_position(mpPlannerRuntime_t *_mr, uint8_t axis) { return (_mr->position[axis]); }
-void mp_set_runtime_display_offset(float offset[]) { copy_vector(mr->gm.display_offset, offset); }
+void mp_set_runtime_display_offset(float offset[]) { copy_vector(mr->gm.display_offset, offset); sr_flag_change(SR_CHANGED_RUNTIME); }
 
 // We have to handle rotation - "rotate" by the transverse of the matrix to got "normal" coordinates
 float mp_get_runtime_display_position(uint8_t axis) {
@@ -151,6 +169,7 @@ stat_t mp_aline(GCodeState_t* _gm)
 
     float length_square = 0;
     float length;
+    PROFILE_ALINE_START;
 
     // A few notes about the rotated coordinate space:
     // These are positions PRE-rotation:
@@ -211,19 +230,16 @@ stat_t mp_aline(GCodeState_t* _gm)
 ////        - Kyle's testing turned up an issue with (too) small arcs not being flagged right. That issue is additionally resolved here.
 //// ========================================================================================= Setting Locations to Exact Step Locations Here
 ////                                                                                           By converting back and forth    
-    
+
+    if (_plan_merge(_gm, target_rotated)) {             // extend the previous line if this one is close to collinear...
+        return (STAT_OK);
+    }
+    _plan_blend(_gm, target_rotated);                   // ...otherwise G64 P may round the corner into this line
+
     for (uint8_t axis = 0; axis < AXES; axis++) {
 
         // make targets exact step locations
-        long int temp_toSteps;
-        int temp_sign = 1;
-        if (isnan(target_rotated[axis])) {
-                    // ignore NaN from arcs that are too small
-        } else {    // process good values    
-            if (target_rotated[axis] < 0 ) temp_sign = -1;                                              // see note on negative step rounding
-            temp_toSteps = ((std::abs(target_rotated[axis]) * st_cfg.mot[axis].steps_per_unit) + .5);   // round integer of full steps
-            target_rotated[axis] = (temp_toSteps * temp_sign) / st_cfg.mot[axis].steps_per_unit;        // convert back to float of true target location and asign sign
-        }        
+        target_rotated[axis] = _to_step_location(target_rotated[axis], axis);
 
         // clean up final values
         axis_length[axis] = target_rotated[axis] - mp->position[axis];
@@ -248,11 +264,14 @@ stat_t mp_aline(GCodeState_t* _gm)
     // get a cleared buffer and copy in the Gcode model state
     mpBuf_t* bf = mp_get_write_buffer();
 
-    if (bf == NULL) {                                   // never supposed to fail
+    if ((bf == NULL) || !mp_attach_gm(bf, _gm)) {       // never supposed to fail
         return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "aline()"));
     }
-    memcpy(&bf->gm, _gm, sizeof(GCodeState_t));
-    copy_vector(bf->gm.target, target_rotated);         // copy the rotated target in place
+    copy_vector(bf->target, target_rotated);            // copy the rotated target in place
+    if ((_stored_plan != nullptr) && _plan_is_usable()) {
+        bf->plan = *_stored_plan;                       // velocity caps and ramps from a compiled job
+        bf->has_plan = true;
+    }
 
     // setup the buffer
     bf->bf_func = mp_exec_aline;                        // register the callback to the exec function
@@ -263,15 +282,478 @@ stat_t mp_aline(GCodeState_t* _gm)
         }
     }
     _calculate_jerk(bf);                                // compute bf->jerk values
+    _sample_block_length(bf);                           // update the average block length for the horizon
     _calculate_vmaxes(bf, axis_length, axis_square);    // compute cruise_vmax and absolute_vmax
     _set_bf_diagnostics(bf);                            // DIAGNOSTIC
 
+    _merge.bf = bf;                                     // this line may be extended by the lines that follow
+    _merge.vertices = 0;
+    copy_vector(_merge.start, mp->position);
+    PROFILE_ALINE_END;
+
     // Note: these next lines must remain in exact order. Position must update before committing the buffer.
-    copy_vector(mp->position, bf->gm.target);           // update the planner position for the next move
+    copy_vector(mp->position, bf->target);              // update the planner position for the next move
     mp_commit_write_buffer(BLOCK_TYPE_ALINE);           // commit current block (must follow the position update)
     return (STAT_OK);
 }
 
+/*
+ * _to_step_location() - round an axis target to the nearest exact step location
+ *
+ *  The step size is taken from the first motor mapped to the axis. An axis with no motor
+ *  has no step grid, so its target is returned as is.
+ */
+
+static float _to_step_location(const float value, const uint8_t axis)
+{
+    if (isnan(value)) {         // ignore NaN from arcs that are too small
+        return (value);
+    }
+    float steps_per_unit = 0;
+    for (uint8_t motor = 0; motor < MOTORS; motor++) {
+        if (st_cfg.mot[motor].motor_map == axis) {
+            steps_per_unit = st_cfg.mot[motor].steps_per_unit;
+            break;
+        }
+    }
+    if (fp_ZERO(steps_per_unit)) {
+        return (value);
+    }
+    int temp_sign = 1;
+    if (value < 0) temp_sign = -1;                                          // see note on negative step rounding
+    long int temp_toSteps = ((std::abs(value) * steps_per_unit) + .5);      // round integer of full steps
+    return ((temp_toSteps * temp_sign) / steps_per_unit);                   // convert back to float of true target location and asign sign
+}
+
+/****************************************************************************************
+ * mp_arc()           - plan a native arc with acceleration / deceleration
+ * mp_arc_is_native() - returns true if arcs can be queued as native arc blocks
+ *
+ *  mp_arc() queues an arc or helix that was set up by cm_arc_feed_mm() as a single ALINE
+ *  block. The block is planned using the arc length and carries its geometry (mpArc_t)
+ *  to the runtime, which interpolates the arc one segment at a time. See
+ *  _exec_aline_segment() in plan_exec.cpp. Compared to decomposing the arc into chords
+ *  this takes one planner buffer per arc instead of one per chord, and there are no
+ *  chord junctions to slow the arc down.
+ *
+ *  Instead the arc is limited by its centripetal acceleration (see _calculate_arc_vmax()).
+ *  The entry tangent is kept in bf->unit so the junction into the arc is computed as for
+ *  any line. The exit tangent is kept in the arc geometry for the junction out of it.
+ *
+ *  The plane axes are swept through the arc. Each is planned with the largest share of the
+ *  planar travel it takes anywhere in the swept angle (see _arc_envelope()), so the jerk and
+ *  velocity limits of each plane axis are projected onto the arc just as they are onto the
+ *  unit vector of a line. A short arc or G64 blend that barely moves one plane axis is not
+ *  held to that axis's limits as if it were a full circle. The linear axis and any other
+ *  axes move linearly with arc length.
+ *
+ *  Native arcs are only used if the coordinate rotation is the identity. A rotated arc
+ *  may leave its plane, so in that case arcs are decomposed into chords by mp_aline().
+ */
+
+bool mp_arc_is_native()
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            if (fp_NE(cm->rotation_matrix[i][j], ((i == j) ? 1.0 : 0.0))) {
+                return (false);
+            }
+        }
+    }
+    return (fp_ZERO(cm->rotation_z_offset));
+}
+
+stat_t mp_arc(cmArc_t *arc)
+{
+    float target[]      = INIT_AXES_ZEROES;
+    float axis_square[] = INIT_AXES_ZEROES;
+    float axis_length[] = INIT_AXES_ZEROES;
+    uint8_t p0 = arc->plane_axis_0;
+    uint8_t p1 = arc->plane_axis_1;
+    PROFILE_ALINE_START;
+
+    // exit if the move has zero movement. At all.
+    if (arc->length < 0.0001) {
+        sr_request_status_report(SR_REQUEST_TIMED_FULL);
+        return (STAT_MINIMUM_LENGTH_MOVE);
+    }
+
+    // set up the target and the axes that move linearly with arc length
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        target[axis] = _to_step_location(arc->gm.target[axis], axis);
+        if ((axis != p0) && (axis != p1)) {
+            axis_length[axis] = target[axis] - mp->position[axis];
+            if (fp_ZERO(axis_length[axis])) {
+                axis_length[axis] = 0;
+            }
+            axis_square[axis] = square(axis_length[axis]);
+        }
+    }
+    float planar_unit = arc->planar_travel / arc->length;   // d(planar travel) / d(arc length), signed
+    float max_sin, max_cos;
+    _arc_envelope(arc->theta, arc->angular_travel, &max_sin, &max_cos);
+    axis_length[p0] = std::abs(arc->planar_travel) * max_cos;   // each plane axis at its fastest in the sweep...
+    axis_length[p1] = std::abs(arc->planar_travel) * max_sin;
+    axis_square[p0] = square(arc->planar_travel);           // ...but the feed rate applies to the planar travel once
+    axis_square[p1] = 0;
+
+    mpBuf_t* bf = mp_get_write_buffer();
+    if ((bf == NULL) || !mp_attach_gm(bf, &arc->gm)) {  // never supposed to fail
+        return (cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "arc()"));
+    }
+    copy_vector(bf->target, target);
+
+    bf->arc = bf->arc_data;                             // mark the block as a native arc and record its geometry
+    bf->arc->center_0 = arc->center_0;
+    bf->arc->center_1 = arc->center_1;
+    bf->arc->radius = arc->radius;
+    bf->arc->theta = arc->theta;
+    bf->arc->angular_travel = arc->angular_travel;
+    bf->arc->length = arc->length;
+    bf->arc->plane_axis_0 = p0;
+    bf->arc->plane_axis_1 = p1;
+    float theta_end = arc->theta + arc->angular_travel;
+    bf->arc->exit_unit_0 =  cos(theta_end) * planar_unit;
+    bf->arc->exit_unit_1 = -sin(theta_end) * planar_unit;
+
+    bf->bf_func = mp_exec_aline;                        // arcs run through the aline exec
+    bf->length = arc->length;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if ((bf->axis_flags[axis] = fp_NOT_ZERO(axis_length[axis]))) {
+            bf->unit[axis] = axis_length[axis] / arc->length;
+        }
+    }
+    _calculate_jerk(bf);                                // jerk for the plane axes at their fastest...
+    bf->unit[p0] =  cos(arc->theta) * planar_unit;      // ...then the entry tangent for the junction into the arc
+    bf->unit[p1] = -sin(arc->theta) * planar_unit;
+    _sample_block_length(bf);
+    _calculate_vmaxes(bf, axis_length, axis_square);
+    _calculate_arc_vmax(bf);
+    _set_bf_diagnostics(bf);
+    PROFILE_ALINE_END;
+
+    // Note: these next lines must remain in exact order. Position must update before committing the buffer.
+    copy_vector(mp->position, bf->target);
+    mp_commit_write_buffer(BLOCK_TYPE_ALINE);
+    return (STAT_OK);
+}
+
+/****************************************************************************************
+ * _plan_blend() - round the corner between the previous line and a new line (G64 P)
+ *
+ *  In G64 with a P tolerance the corner at the end of the previous line is replaced by a
+ *  circular blend that is tangent to both lines and passes within the tolerance of the
+ *  corner. The previous line is shortened to the start of the blend, the blend is queued
+ *  as a native arc (see mp_arc()), and the planner position moves to the end of the blend
+ *  so the new line starts there. Both junctions are then tangent, so the corner speed is
+ *  set by the blend's centripetal limit instead of by _calculate_junction_vmax().
+ *
+ *  For a deflection angle phi between the lines the half-angle at the corner is
+ *  a = (pi - phi)/2. For a tolerance d:
+ *
+ *      r = d sin(a) / (1 - sin(a))     puts the middle of the blend d from the corner
+ *      t = r cos(a) / sin(a)           distance from the corner to each tangent point
+ *
+ *  t is capped at half of each line so adjacent blends never overlap, which reduces r.
+ *
+ *  A corner is only blended if:
+ *    - both lines are G1 feeds in G64 with a P tolerance, not in inverse time mode. The
+ *      previous block must be a line - not a native arc or another blend - and the new
+ *      line must not be an arc chord (arcs are queued with an arc motion mode)
+ *    - both lines lie in the same XY, XZ or YZ plane, as native arcs are planar
+ *    - the previous line is the last block queued, and is far enough from the run buffer
+ *      that it can't be forward planned or started while it is being shortened
+ *  Other corners are left exact, as before.
+ */
+
+static bool _blend_in_plane(const float u1[], const float u2[], const uint8_t p0, const uint8_t p1)
+{
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        if ((axis != p0) && (axis != p1) && (fp_NOT_ZERO(u1[axis]) || fp_NOT_ZERO(u2[axis]))) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+static void _plan_blend(const GCodeState_t* _gm, const float target[])
+{
+    static cmArc_t blend;               // static to keep the gm copy off the stack
+    mpBuf_t* pv = mp->q.w->pv;          // the line that ends at the corner
+
+    if ((_gm->path_control != PATH_CONTINUOUS) || (_gm->path_tolerance < EPSILON) ||
+        (_gm->motion_mode != MOTION_MODE_STRAIGHT_FEED) || (_gm->feed_rate_mode == INVERSE_TIME_MODE) ||
+        (cm->hold_state != FEEDHOLD_OFF) || !mp_arc_is_native() || mp_planner_is_full(mp)) {
+        return;
+    }
+    if (!_last_block_is_editable(pv) || (pv->arc != nullptr) ||
+        (pv->motion_mode != MOTION_MODE_STRAIGHT_FEED) || (pv->gm->feed_rate_mode == INVERSE_TIME_MODE) ||
+        (pv->gm->path_control != PATH_CONTINUOUS)) {
+        return;
+    }
+
+    // unit vector of the new line
+    float u2[AXES];
+    float length = get_axis_vector_length(target, mp->position);
+    if (length < EPSILON4) {
+        return;
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        u2[axis] = (target[axis] - mp->position[axis]) / length;
+    }
+
+    // find the plane of the corner
+    uint8_t p0, p1, linear;
+         if (_blend_in_plane(pv->unit, u2, AXIS_X, AXIS_Y)) { p0 = AXIS_X; p1 = AXIS_Y; linear = AXIS_Z; }
+    else if (_blend_in_plane(pv->unit, u2, AXIS_X, AXIS_Z)) { p0 = AXIS_X; p1 = AXIS_Z; linear = AXIS_Y; }
+    else if (_blend_in_plane(pv->unit, u2, AXIS_Y, AXIS_Z)) { p0 = AXIS_Y; p1 = AXIS_Z; linear = AXIS_X; }
+    else { return; }
+
+    // size the blend - skip near-straight corners (the junction handles them) and near reversals
+    float cos_phi = pv->unit[p0] * u2[p0] + pv->unit[p1] * u2[p1];
+    float sin_a = sqrt(std::max((1 + cos_phi) / 2, (float)0));
+    float cos_a = sqrt(std::max((1 - cos_phi) / 2, (float)0));
+    if ((cos_a < 0.01) || (sin_a < 0.05)) {
+        return;
+    }
+    float radius = _gm->path_tolerance * sin_a / (1 - sin_a);
+    float trim = radius * cos_a / sin_a;
+    float trim_max = std::min(pv->length, length) / 2;
+    if (trim > trim_max) {
+        trim = trim_max;
+        radius = trim * sin_a / cos_a;
+    }
+    float phi = acos(std::max(std::min(cos_phi, (float)1), (float)-1));
+    if (radius * phi < 0.001) {         // not worth a block
+        return;
+    }
+
+    // geometry: tangent points on each line, and the center on the bisector of the corner.
+    // The start is snapped to a step location as it is the new end of the previous line.
+    // The end is snapped by mp_arc(). Both are within a step of the true tangent points.
+    float start_0  = _to_step_location(mp->position[p0] - pv->unit[p0] * trim, p0);
+    float start_1  = _to_step_location(mp->position[p1] - pv->unit[p1] * trim, p1);
+    float end_0    = mp->position[p0] + u2[p0] * trim;
+    float end_1    = mp->position[p1] + u2[p1] * trim;
+    float center_d = radius / sin_a / (2 * cos_a);  // |u2 - u1| is 2 cos(a)
+    blend.center_0 = mp->position[p0] + (u2[p0] - pv->unit[p0]) * center_d;
+    blend.center_1 = mp->position[p1] + (u2[p1] - pv->unit[p1]) * center_d;
+    blend.theta = atan2(start_0 - blend.center_0, start_1 - blend.center_1);
+    blend.angular_travel = atan2(end_0 - blend.center_0, end_1 - blend.center_1) - blend.theta;
+    if (blend.angular_travel > M_PI)  { blend.angular_travel -= 2*M_PI; }
+    if (blend.angular_travel < -M_PI) { blend.angular_travel += 2*M_PI; }
+    blend.radius = radius;
+    blend.planar_travel = blend.angular_travel * radius;
+    blend.linear_travel = 0;
+    blend.length = std::abs(blend.planar_travel);
+    blend.plane_axis_0 = (cmAxes)p0;
+    blend.plane_axis_1 = (cmAxes)p1;
+    blend.linear_axis = (cmAxes)linear;
+    memcpy(&blend.gm, _gm, sizeof(GCodeState_t));
+    copy_vector(blend.gm.target, mp->position);
+    blend.gm.target[p0] = end_0;
+    blend.gm.target[p1] = end_1;
+
+    // shorten the previous line to the start of the blend. Its velocities don't change,
+    // so its time scales with its length. It has to be back-planned again, and any plan
+    // stored for it no longer fits.
+    trim = sqrt(square(mp->position[p0] - start_0) + square(mp->position[p1] - start_1));
+    pv->target[p0] = start_0;
+    pv->target[p1] = start_1;
+    pv->block_time *= (pv->length - trim) / pv->length;
+    pv->length -= trim;
+    pv->has_plan = false;
+    if (pv->buffer_state == MP_BUFFER_BACK_PLANNED) {
+        pv->buffer_state = MP_BUFFER_NOT_PLANNED;
+    }
+    pv->plannable = true;
+    mp->position[p0] = start_0;
+    mp->position[p1] = start_1;
+
+    mp_arc(&blend);                     // queue the blend and move the planner position to its end
+}
+
+/*
+ * _last_block_is_editable() - true if bf is a line that can still be changed in place
+ *
+ *  bf must be the last block queued, and must not have been forward planned. It must be
+ *  at least 3 buffers from the run buffer so the runtime can't forward plan or load it
+ *  while it is being changed.
+ */
+
+static bool _last_block_is_editable(mpBuf_t* bf)
+{
+    // The newest committed block is mp_get_queued_buffers()-1 blocks past the run buffer.
+    // It is editable if that is beyond the blocks the interrupts may still change.
+    return ((bf == mp->q.w->pv) && (bf->block_type == BLOCK_TYPE_ALINE) &&
+            (bf->buffer_state != MP_BUFFER_EMPTY) && (bf->buffer_state <= MP_BUFFER_BACK_PLANNED) &&
+            (mp_get_queued_buffers(mp) > RUNTIME_RESERVED_BUFFERS));
+}
+
+/****************************************************************************************
+ * _plan_merge() - merge a G1 line into the previous line if the path stays within tolerance
+ *
+ *  CAM output often has long runs of nearly collinear short lines. Each one otherwise
+ *  takes a planner buffer, a vmax calculation and a junction. If the merge tolerance
+ *  ({lmt:}) is set, and a new G1 continues the previous G1 with the same modal state, the
+ *  previous line is extended to the new target as long as every endpoint merged into it
+ *  stays within the tolerance of the extended line. This holds up to MERGE_MAX_VERTICES
+ *  endpoints per line.
+ *
+ *  The extended line keeps the line number of the first line merged into it, and records
+ *  the newest line and its length. The runtime reports the first line number until it
+ *  reaches the newest line (see mp_exec_aline()). Lines between the two are reported as the
+ *  first. Every Gcode line still gets its own response, so line-counting flow control is
+ *  not affected.
+ *
+ *  Returns true if the line was merged, in which case there is nothing else to queue.
+ */
+
+/*
+ * mp_clear_merge() - stop the last queued line from being extended
+ *
+ *  There is one merge state, shared by both planners. It must be cleared whenever the
+ *  queue it points into is reset, and when planners are swapped for a feedhold.
+ */
+
+void mp_clear_merge()
+{
+    _merge.bf = nullptr;
+    _merge.vertices = 0;
+}
+
+/*
+ * mp_set_stored_plan() - attach a stored plan to the next line queued, or nullptr to stop
+ *
+ *  A compiled SD job carries a plan for most of its lines, made over the whole file ahead
+ *  of the run (see sd_job.h). The binary parser sets it around the call that queues the
+ *  line. The plan is ignored if the tram rotation is set, since it was made for the lines
+ *  as written. Lines that are merged or blended drop their plans, as their geometry is no
+ *  longer what was planned. What is done with the plan is in _calculate_exit_vmax() and
+ *  mp_calculate_ramps().
+ */
+
+void mp_set_stored_plan(const mpStoredPlan_t* plan)
+{
+    _stored_plan = plan;
+}
+
+static bool _plan_is_usable()
+{
+    for (uint8_t i = 0; i < 3; i++) {
+        for (uint8_t j = 0; j < 3; j++) {
+            if (cm->rotation_matrix[i][j] != ((i == j) ? 1 : 0)) {
+                return (false);
+            }
+        }
+    }
+    return (cm->rotation_z_offset == 0);
+}
+
+static bool _merge_same_state(const mpBuf_t* bf, const GCodeState_t* b)
+{
+    const GCodeState_t* a = bf->gm;
+    return ((bf->motion_mode == b->motion_mode) && (bf->feed_rate == b->feed_rate) &&
+            (a->feed_rate_mode == b->feed_rate_mode) && (a->path_control == b->path_control) &&
+            (a->path_tolerance == b->path_tolerance) && (a->motion_profile == b->motion_profile) &&
+            (bf->spindle_speed == b->spindle_speed) && (a->spindle_direction == b->spindle_direction) &&
+            (a->tool == b->tool) && (a->coord_system == b->coord_system) &&
+            (bf->absolute_override == b->absolute_override) &&
+            (memcmp(bf->display_offset, b->display_offset, sizeof(bf->display_offset)) == 0));
+}
+
+static bool _plan_merge(const GCodeState_t* _gm, const float target[])
+{
+    mpBuf_t* pv = mp->q.w->pv;
+    float snapped[AXES];
+    float axis_length[AXES];
+    float axis_square[AXES];
+    float length_square = 0;
+
+    if ((cm->config->merge_tolerance < EPSILON) || (_gm->motion_mode != MOTION_MODE_STRAIGHT_FEED) ||
+        (_gm->feed_rate_mode == INVERSE_TIME_MODE) || (cm->hold_state != FEEDHOLD_OFF)) {
+        return (false);
+    }
+    if ((pv != _merge.bf) || (_merge.vertices >= MERGE_MAX_VERTICES) ||
+        !_last_block_is_editable(pv) || (pv->arc != nullptr) || !_merge_same_state(pv, _gm)) {
+        return (false);
+    }
+    // The junction into the line changes with its direction, so the block before it is
+    // replanned too. It must also be out of reach of the interrupts.
+    if (mp_get_queued_buffers(mp) <= (RUNTIME_RESERVED_BUFFERS + 1)) {
+        return (false);
+    }
+
+    // the extended line runs from the start of the previous line to the new target
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        snapped[axis] = _to_step_location(target[axis], axis);
+        axis_length[axis] = snapped[axis] - _merge.start[axis];
+        axis_square[axis] = square(axis_length[axis]);
+        length_square += axis_square[axis];
+    }
+    float length = sqrt(length_square);
+    if (length < EPSILON4) {
+        return (false);
+    }
+
+    // the end of the previous line becomes a merged endpoint. Test all of them.
+    copy_vector(_merge.vertex[_merge.vertices], pv->target);
+    float tolerance_sq = square(cm->config->merge_tolerance);
+    for (uint8_t i = 0; i <= _merge.vertices; i++) {
+        float along = 0;
+        float distance_sq = 0;
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            float d = _merge.vertex[i][axis] - _merge.start[axis];
+            along += d * axis_length[axis];
+            distance_sq += d * d;
+        }
+        along /= length;
+        if ((along < 0) || (along > length) || ((distance_sq - along * along) > tolerance_sq)) {
+            return (false);
+        }
+    }
+    _merge.vertices++;
+
+    // extend the previous line. It no longer matches any plan stored for it.
+    pv->has_plan = false;
+    pv->last_linenum = _gm->linenum;
+    pv->last_line_length = get_axis_vector_length(snapped, pv->target);
+    copy_vector(pv->target, snapped);
+    pv->length = length;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        pv->axis_flags[axis] = fp_NOT_ZERO(axis_length[axis]);
+        if (!pv->axis_flags[axis]) {
+            axis_length[axis] = 0;
+            axis_square[axis] = 0;
+        }
+        pv->unit[axis] = axis_length[axis] / length;
+    }
+    _calculate_jerk(pv);
+    _calculate_vmaxes(pv, axis_length, axis_square);
+    _set_bf_diagnostics(pv);
+
+    // Recompute the junction into the line now. Back-planning may have already marked the
+    // block before it optimal (not plannable), and then would not revisit the junction.
+    _calculate_junction_vmax(pv->pv);
+    _calculate_exit_vmax(pv->pv);
+    pv->pv->plannable = true;
+    if (pv->pv->buffer_state == MP_BUFFER_BACK_PLANNED) {
+        pv->pv->buffer_state = MP_BUFFER_NOT_PLANNED;
+    }
+
+    // Re-prime the line and back-plan from it again. If the planner hasn't caught up yet
+    // it will get there anyway.
+    pv->buffer_state = MP_BUFFER_INITIALIZING;
+    pv->plannable = true;
+    if (mp->p == mp->q.w) {
+        mp->p = pv;
+    }
+    mp->request_planning = true;
+    mp->block_timeout.set(BLOCK_TIMEOUT_MS);
+    copy_vector(mp->position, snapped);
+    return (true);
+}
+
 /****************************************************************************************
  * mp_plan_block_list() - plan all the blocks in the list
  *
@@ -295,7 +777,9 @@ void mp_plan_block_list()
             mp->p = mp->p->nx;
             return;
         }
+        PROFILE_PLAN_BLOCK_START;
         bf = _plan_block(bf);       // returns next block to plan
+        PROFILE_PLAN_BLOCK_END;
         mp->p = bf;                 // DIAGNOSTIC - this is not needed but is set here for debugging purposes
     }
 
@@ -325,13 +809,7 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
                 _calculate_junction_vmax(bf->pv);  // compute maximum junction velocity constraint - but only once
             }
 
-            if (bf->pv->gm.path_control == PATH_EXACT_STOP) {
-                bf->pv->exit_vmax = 0;
-            } else {
-                // bf->pv->exit_vmax = std::min(std::min(bf->pv->junction_vmax, bf->pv->cruise_vmax), bf->cruise_vmax);
-                bf->pv->exit_vmax = std::min(std::min(bf->pv->junction_vmax, bf->pv->absolute_vmax), bf->absolute_vmax);
-            // }
-            }
+            _calculate_exit_vmax(bf->pv);
         }
 
 
@@ -359,14 +837,29 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
         float braking_velocity = 0;  // we use this to store the previous entry velocity, start at 0
         bool optimal = false;  // we use the optimal flag (as the opposite of plannable) to carry plan-ability backward.
 
+        // Incremental back-planning is only safe if nothing but the newly added blocks has changed.
+        // Feedholds change velocities mid-queue, so they always re-walk. (Overrides don't - they
+        // are applied in forward planning and by the runtime. See mp_start_feed_override())
+        bool incremental = (cm->hold_state == FEEDHOLD_OFF);
+        PROFILE_BACKPLAN_START
+
         // We test for (braking_velocity < bf->exit_velocity) in case of an inversion, and plannable is then violated.
         for (; bf->plannable || (braking_velocity < bf->exit_velocity); bf = bf->pv) {
             INC_PLANNER_ITERATIONS    // DIAGNOSTIC
+            PROFILE_INC_BACKPLAN
             bf->plannable = bf->plannable && !optimal;  // Don't accidentally enable plannable!
 
             // Let's be mindful that forward planning may change exit_vmax, and our exit velocity may be lowered
             braking_velocity = std::min(braking_velocity, bf->exit_vmax);
 
+            // If a block that was back-planned on an earlier pass gets the same exit velocity again
+            // then its entry velocity, and every block behind it, is planned through already. Stop here.
+            // This is the common case once the exit velocity is capped by exit_vmax, and keeps the
+            // work per new block roughly constant instead of re-walking the whole queue.
+            if (incremental && (bf->buffer_state == MP_BUFFER_BACK_PLANNED) && (braking_velocity == bf->exit_velocity)) {
+                break;
+            }
+
             // We *must* set cruise before exit, and keep it at least as high as exit.
             bf->cruise_velocity = std::max(braking_velocity, bf->cruise_velocity);
             bf->exit_velocity   = braking_velocity;
@@ -462,12 +955,60 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
                 bf->buffer_state = MP_BUFFER_BACK_PLANNED;
             }
         }  // for loop
-    }      // exits with bf pointing to a locked or EMPTY block
+        PROFILE_BACKPLAN_END
+    }      // exits with bf pointing to a locked, EMPTY or already planned-through block
 
     mp->planner_state = PLANNER_PRIMING;  // revert to initial state
     return (mp->planning_return);
 }
 
+/****************************************************************************************
+ * mp_calculate_line()     - set up a scratch block for a line without queueing it
+ * mp_calculate_junction() - set the junction and exit limits of a scratch block and bf->nx
+ *
+ *  These give the SD job compiler the same length, unit vector, jerk and velocity limits
+ *  that mp_aline() and block stitching would give the line, so it can plan a whole job
+ *  ahead of running it (see sd_job.h). bf->gm, bf->motion_mode and bf->feed_rate must be
+ *  set. Start and target are rounded to steps as mp_aline() rounds them, but not rotated.
+ *  mp_calculate_line() returns false for a line too short to queue. Nothing in the planner
+ *  queue is changed.
+ */
+
+bool mp_calculate_line(mpBuf_t* bf, const float start[], const float target[])
+{
+    float axis_length[AXES];
+    float axis_square[AXES];
+    float length_square = 0;
+
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        axis_length[axis] = _to_step_location(target[axis], axis) - _to_step_location(start[axis], axis);
+        bf->axis_flags[axis] = fp_NOT_ZERO(axis_length[axis]);
+        if (!bf->axis_flags[axis]) {
+            axis_length[axis] = 0;
+        }
+        axis_square[axis] = square(axis_length[axis]);
+        length_square += axis_square[axis];
+    }
+    bf->length = sqrt(length_square);
+    if (bf->length < 0.0001) {                          // same as mp_aline()
+        return (false);
+    }
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        bf->unit[axis] = axis_length[axis] / bf->length;
+    }
+    bf->arc = nullptr;
+    bf->has_plan = false;
+    _calculate_jerk(bf);
+    _calculate_vmaxes(bf, axis_length, axis_square);
+    return (true);
+}
+
+void mp_calculate_junction(mpBuf_t* bf)
+{
+    _calculate_junction_vmax(bf);
+    _calculate_exit_vmax(bf);
+}
+
 /***** ALINE HELPERS *****
  * _calculate_jerk()
  * _calculate_vmaxes()
@@ -487,30 +1028,34 @@ static mpBuf_t* _plan_block(mpBuf_t* bf)
 
 static float _get_axis_jerk(mpBuf_t* bf, uint8_t axis)
 {
-    if (bf->gm.motion_profile == PROFILE_FAST) {
-        return cm->a[axis].jerk_high;
+    if ((bf->gm->motion_profile == PROFILE_FAST) || bf->hold_jerk) {
+        return cm->config->a[axis].jerk_high;
     }
-    return cm->a[axis].jerk_max;
+    return cm->config->a[axis].jerk_max;
 }
 
 static void _calculate_jerk(mpBuf_t* bf)
 {
     // compute the jerk as the largest jerk that still meets axis constraints
-    bf->jerk   = 8675309;  // a ridiculously large number
-    float jerk = 0;
+    // Only axes participating in the move count. The unit selects the result rather than
+    // branching around the division (see util.h)
+    float jerk = 8675309;  // a ridiculously large number
 
     for (uint8_t axis = 0; axis < AXES; axis++) {
-        if (std::abs(bf->unit[axis]) > 0) {  // if this axis is participating in the move
-            float axis_jerk = _get_axis_jerk(bf, axis);
-
-            jerk = axis_jerk / std::abs(bf->unit[axis]);
-            if (jerk < bf->jerk) {
-                bf->jerk = jerk;
-                //              bf->jerk_axis = axis;           // +++ diagnostic
-            }
-        }
+        float unit = std::abs(bf->unit[axis]);
+        float axis_jerk = _get_axis_jerk(bf, axis) / unit;
+        jerk = (unit > 0) ? std::min(jerk, axis_jerk) : jerk;
     }
-    bf->jerk *= JERK_MULTIPLIER;           // goose it!
+    mp_set_jerk(bf, jerk * JERK_MULTIPLIER);  // goose it!
+}
+
+/*
+ * mp_set_jerk() - set a block's jerk and the terms cached from it
+ */
+
+void mp_set_jerk(mpBuf_t* bf, const float jerk)
+{
+    bf->jerk = jerk;
     bf->jerk_sq    = bf->jerk * bf->jerk;  // pre-compute terms used multiple times during planning
     bf->recip_jerk = 1 / bf->jerk;
 
@@ -529,18 +1074,19 @@ static void _calculate_jerk(mpBuf_t* bf)
  * mp_should_recalculate_jerk_for_feedhold() - Checks to see if jerk needs to be recalculated
  *
  * This function returns true if the motion_profile has been briefly set to PROFILE_FAST_STOP
- * in bf->gm or false if it hasn't.
+ * in bf->gm and the block hasn't been switched to high jerk yet, or false otherwise.
+ * The gm record may be shared with other blocks, so the switch is kept in bf->hold_jerk.
  */
 
 void mp_recalculate_jerk_for_feedhold(mpBuf_t *bf) {
-    if (PROFILE_FAST_STOP == bf->gm.motion_profile) {
-        bf->gm.motion_profile = PROFILE_FAST;
+    if (mp_should_recalculate_jerk_for_feedhold(bf)) {
+        bf->hold_jerk = true;
         _calculate_jerk(bf);
     }
 }
 
 bool mp_should_recalculate_jerk_for_feedhold(mpBuf_t *bf) {
-    if (PROFILE_FAST_STOP == bf->gm.motion_profile) {
+    if ((PROFILE_FAST_STOP == bf->gm->motion_profile) && !bf->hold_jerk) {
         return true;
     }
     return false;
@@ -642,10 +1188,9 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
     float block_time;           // resulting move time
 
     // compute feed time for feeds and probe motion
-    if (bf->gm.motion_mode != MOTION_MODE_STRAIGHT_TRAVERSE) {
-        if (bf->gm.feed_rate_mode == INVERSE_TIME_MODE) {
-            feed_time = bf->gm.feed_rate;  // NB: feed rate was un-inverted to minutes by cm_set_feed_rate()
-            bf->gm.feed_rate_mode = UNITS_PER_MINUTE_MODE;
+    if (bf->motion_mode != MOTION_MODE_STRAIGHT_TRAVERSE) {
+        if (bf->gm->feed_rate_mode == INVERSE_TIME_MODE) {
+            feed_time = bf->feed_rate;      // NB: feed rate was un-inverted to minutes by cm_set_feed_rate()
         } else {
           // compute length of linear move in millimeters. Feed rate is provided as mm/min
 
@@ -653,23 +1198,23 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
           if (cm->gmx.planning_mode == PLAN_3D) {
           
 #if (AXES == 9)
-            feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_Z] + axis_square[AXIS_U] + axis_square[AXIS_V] + axis_square[AXIS_W]) / bf->gm.feed_rate;
+            feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_Z] + axis_square[AXIS_U] + axis_square[AXIS_V] + axis_square[AXIS_W]) / bf->feed_rate;
 #else
-            feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_Z]) / bf->gm.feed_rate;
+            feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_Z]) / bf->feed_rate;
 #endif
           }
             // in 2D mode the XY/UV plane is used to set feed rate
             // Z/W is ignored unless it's a Z/W move, in which case that motion sets the feed rate
           else { // 2D planning mode
 #if (AXES == 9)
-                feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_U] + axis_square[AXIS_V]) / bf->gm.feed_rate;
+                feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y] + axis_square[AXIS_U] + axis_square[AXIS_V]) / bf->feed_rate;
                 if (fp_ZERO(feed_time)) {
-                    feed_time = sqrt(axis_square[AXIS_Z] + axis_square[AXIS_W]) / bf->gm.feed_rate;
+                    feed_time = sqrt(axis_square[AXIS_Z] + axis_square[AXIS_W]) / bf->feed_rate;
                 }                    
 #else
-                feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y]) / bf->gm.feed_rate;
+                feed_time = sqrt(axis_square[AXIS_X] + axis_square[AXIS_Y]) / bf->feed_rate;
                 if (fp_ZERO(feed_time)) {
-                    feed_time = sqrt(axis_square[AXIS_Z]) / bf->gm.feed_rate;
+                    feed_time = sqrt(axis_square[AXIS_Z]) / bf->feed_rate;
                 }                    
 #endif                
           }
@@ -678,21 +1223,18 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
             // if no linear axes, compute length of multi-axis rotary move in degrees.
             // Feed rate is provided as degrees/min
             if (fp_ZERO(feed_time)) {
-                feed_time = sqrt(axis_square[AXIS_A] + axis_square[AXIS_B] + axis_square[AXIS_C]) / bf->gm.feed_rate;
+                feed_time = sqrt(axis_square[AXIS_A] + axis_square[AXIS_B] + axis_square[AXIS_C]) / bf->feed_rate;
             }
         }
     }
 
     // compute rate limits and absolute maximum limit
+    // axis_flags select the result rather than branch around the division (see util.h)
+    const bool traverse = (bf->motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE);
     for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
-        if (bf->axis_flags[axis]) {
-            if (bf->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) {
-                tmp_time = std::abs(axis_length[axis]) / cm->a[axis].velocity_max;
-            } else {// gm.motion_mode == MOTION_MODE_STRAIGHT_FEED
-                tmp_time = std::abs(axis_length[axis]) / cm->a[axis].feedrate_max;
-            }
-            max_time = std::max(max_time, tmp_time);
-        }
+        float axis_vmax = traverse ? cm->config->a[axis].velocity_max : cm->config->a[axis].feedrate_max;
+        tmp_time = std::abs(axis_length[axis]) / axis_vmax;
+        max_time = bf->axis_flags[axis] ? std::max(max_time, tmp_time) : max_time;
     }
 
     block_time        = std::max(max_time, MIN_BLOCK_TIME); // the slowest of most-limited axis or MIN_BLOCK_TIME
@@ -705,6 +1247,50 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
     bf->cruise_vmax   = bf->absolute_vmax;                  // starting value for cruise vmax to absolute highest
 }
 
+/****************************************************************************************
+ * _sample_block_length() - keep the running average block length
+ * mp_get_horizon_vmax()  - cap a cruise velocity to what can be stopped within the planner horizon
+ *
+ *  The planner always plans to stop at the end of the queue, so the fastest the machine
+ *  can sustain is the velocity it can brake from within the path the queue holds. With
+ *  a fixed number of buffers that is set by block length: dense short moves give a short
+ *  horizon. The horizon is the longer of the path actually queued ahead of the runtime
+ *  (mp->horizon_length) and the path the queue would hold when full - a running average
+ *  of block length times the buffers the planner can fill (the rest are headroom and runtime).
+ *
+ *  Planning a faster cruise gains nothing - back-planning would brake every block to fit
+ *  the queue anyway - but it accelerates into blocks that are then replanned down as the
+ *  queue moves, which shows up as surging on dense toolpaths. The cap is applied when a
+ *  block is forward planned (mp_calculate_ramps()) and is not stored in the block, so a
+ *  block queued among short moves runs at full speed if longer moves have queued behind it
+ *  by the time it runs. Stopping at the end of the queue is still up to back-planning.
+ *
+ *  bf->jerk must already be set. _sample_block_length() is called once for each new
+ *  block, so lines recalculated by _plan_merge() are not counted again in the average.
+ */
+
+static void _sample_block_length(const mpBuf_t* bf)
+{
+    if (fp_ZERO(mp->horizon_block_length)) {
+        mp->horizon_block_length = bf->length;
+    } else {
+        mp->horizon_block_length += (bf->length - mp->horizon_block_length) * HORIZON_AVERAGE_WEIGHT;
+    }
+}
+
+float mp_get_horizon_vmax(const mpBuf_t* bf, const float vmax)
+{
+    float horizon_length = std::max(mp->horizon_block_length, bf->length) *
+                           (mp->q.queue_size - PLANNER_BUFFER_HEADROOM - RUNTIME_RESERVED_BUFFERS);
+    horizon_length = std::max(horizon_length, mp->horizon_length);
+
+    // the length test is a sqrt - only solve for the velocity (a cbrt) if the cap applies
+    if (mp_get_target_length(0, vmax, bf) <= horizon_length) {
+        return (vmax);
+    }
+    return (std::min(vmax, mp_get_target_velocity(0, horizon_length, bf)));
+}
+
 ////## I removed this from FabMo-G2 in order to get e-p to compile and run correctly, it may work fine ...
 ////## Test Reversion to 101.03 for junction
 // /****************************************************************************************
@@ -760,7 +1346,7 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
 //                 float delta = bf->unit[axis];
 
 //                 if (delta > EPSILON) {
-//                     velocity = std::min(velocity, ((cm->a[axis].max_junction_accel * _get_axis_jerk(bf, axis)) / delta)); // formula (2)
+//                     velocity = std::min(velocity, ((cm->config->a[axis].max_junction_accel * _get_axis_jerk(bf, axis)) / delta)); // formula (2)
 //                 }
 //             }
 //         }
@@ -800,7 +1386,7 @@ static void _calculate_vmaxes(mpBuf_t* bf, const float axis_length[], const floa
 
 //             // (A) special case handling
 //             if (delta > EPSILON) {
-//                 velocity = std::min(velocity, ((cm->a[axis].max_junction_accel * _get_axis_jerk(bf, axis)) / delta)); // formula (2)
+//                 velocity = std::min(velocity, ((cm->config->a[axis].max_junction_accel * _get_axis_jerk(bf, axis)) / delta)); // formula (2)
 //             }
 //         }
 //     }
@@ -865,38 +1451,122 @@ static void _calculate_junction_vmax(mpBuf_t* bf)
 
     // cmAxes jerk_axis = AXIS_X;   // a diagnostic in case you want to find the limiting axis
 
-    for (uint8_t axis = 0; axis < AXES; axis++) {
+    // native arcs leave along their exit tangent
+    float exit_unit[AXES] AXIS_VECTOR_ALIGNED;
+    copy_vector(exit_unit, bf->unit);
+    if (bf->arc != nullptr) {
+        exit_unit[bf->arc->plane_axis_0] = bf->arc->exit_unit_0;
+        exit_unit[bf->arc->plane_axis_1] = bf->arc->exit_unit_1;
+    }
 
-        //2dm  ////## not in commented out code above!
-        if (cm->gmx.planning_mode == PLAN_2DB) {    // do not incorporate Z/W cornering if in 2D mode B 
- 
+    //2dm  ////## not in commented out code above!
+    const bool plan_2db = (cm->gmx.planning_mode == PLAN_2DB);  // do not incorporate Z/W cornering if in 2D mode B
+
+    for (uint8_t axis = 0; axis < AXES; axis++) {
 #if (AXES == 9)
-            if (axis == AXIS_Z || axis == AXIS_W) { 
-                continue;
-            }
+        bool cornering = !(plan_2db && ((axis == AXIS_Z) || (axis == AXIS_W)));
 #else
-            if (axis == AXIS_Z) {        ////## for FabMo may need to consider how to handle a "linear A axis"
-                continue;
-            }
+        bool cornering = !(plan_2db && (axis == AXIS_Z));   ////## for FabMo may need to consider how to handle a "linear A axis"
 #endif
-        }
-
-        if (bf->axis_flags[axis] || bf->nx->axis_flags[axis]) {       // skip axes with no movement
-            float delta = fabs(bf->unit[axis] - bf->nx->unit[axis]);  // formula (1)
+        cornering &= (bf->axis_flags[axis] || bf->nx->axis_flags[axis]);   // skip axes with no movement
 
-            // Corner case: If an axis has zero delta, we might have a straight line.
-            // Corner case: An axis doesn't change (and it's not a straight line).
-            //   In either case, division-by-zero is bad, m'kay?
-            if (delta > EPSILON) {
-                // formula (4): (See Note 1, above)
+        float delta = fabs(exit_unit[axis] - bf->nx->unit[axis]);         // formula (1)
 
-                // velocity = min(velocity, (cm->a[axis].max_junction_accel / delta));
-                if ((cm->a[axis].max_junction_accel / delta) < velocity) {
-                    velocity = (cm->a[axis].max_junction_accel / delta);
-                    // bf->jerk_axis = axis;
-                }
-            }
-        }
+        // Corner case: If an axis has zero delta, we might have a straight line.
+        // Corner case: An axis doesn't change (and it's not a straight line).
+        //   In either case, division-by-zero is bad, m'kay? The select discards it.
+        // formula (4): (See Note 1, above)
+        float axis_velocity = cm->config->a[axis].max_junction_accel / delta;
+        velocity = (cornering && (delta > EPSILON)) ? std::min(velocity, axis_velocity) : velocity;
     }
     bf->junction_vmax = velocity;
 }
+
+/*
+ * _calculate_exit_vmax() - limit a block's exit to its junction with the next block
+ */
+
+static void _calculate_exit_vmax(mpBuf_t* bf)
+{
+    if ((bf->gm != nullptr) && (bf->gm->path_control == PATH_EXACT_STOP)) {
+        bf->exit_vmax = 0;
+    } else {
+        // bf->exit_vmax = std::min(std::min(bf->junction_vmax, bf->cruise_vmax), bf->nx->cruise_vmax);
+        bf->exit_vmax = std::min(std::min(bf->junction_vmax, bf->absolute_vmax), bf->nx->absolute_vmax);
+    }
+
+    // A stored plan was made over the whole job at 100% override, so its exit velocity is an
+    // upper bound on any exit the queue can plan at 100% or below. Capping the exit with it
+    // lets back-planning stop as soon as it reaches the stored plan. Above 100% it would hold
+    // the corners back to the programmed feed, so it is not applied.
+    if (bf->has_plan && (mp_get_override_factor(bf->motion_mode) <= 1)) {
+        bf->exit_vmax = std::min(bf->exit_vmax, bf->plan.exit_velocity);
+    }
+}
+
+/****************************************************************************************
+ * _calculate_arc_vmax() - limit a native arc by its centripetal acceleration
+ *
+ *  Following a radius r at velocity v takes a centripetal acceleration of v^2/r, so
+ *
+ *      v = sqrt(a * r)
+ *
+ *  The acceleration is the one the junction model allows on each plane axis: the junction
+ *  velocity term max_junction_accel (see Note 1, above) applied over one junction
+ *  integration time. The centripetal acceleration points at the center, so plane axis 0
+ *  sees |sin(theta)| of it and plane axis 1 sees |cos(theta)|. Each axis is checked at
+ *  its worst angle in the sweep, and the slower of the two limits the arc.
+ */
+
+static void _calculate_arc_vmax(mpBuf_t* bf)
+{
+    float max_sin, max_cos;
+    _arc_envelope(bf->arc->theta, bf->arc->angular_travel, &max_sin, &max_cos);
+
+    float recip_T = 1000.0 / cm->config->junction_integration_time;
+    float vmax_sq = 8675309.0 * 8675309.0;
+    if (max_sin > EPSILON) {
+        vmax_sq = std::min(vmax_sq, cm->config->a[bf->arc->plane_axis_0].max_junction_accel * recip_T * bf->arc->radius / max_sin);
+    }
+    if (max_cos > EPSILON) {
+        vmax_sq = std::min(vmax_sq, cm->config->a[bf->arc->plane_axis_1].max_junction_accel * recip_T * bf->arc->radius / max_cos);
+    }
+    float vmax = sqrt(vmax_sq);
+
+    if (vmax < bf->absolute_vmax) {
+        bf->absolute_vmax = vmax;
+        bf->cruise_vmax   = vmax;
+        bf->block_time    = bf->length / vmax;
+    }
+    bf->cruise_vset = std::min(bf->cruise_vset, vmax);
+}
+
+/****************************************************************************************
+ * _arc_envelope() - largest |sin| and |cos| of the angle swept by an arc
+ *
+ *  An arc point is (c0 + sin(theta) r, c1 + cos(theta) r), so the tangent along plane
+ *  axis 0 goes with |cos(theta)| and the centripetal acceleration with |sin(theta)|, and
+ *  the other way around for plane axis 1. Both peak at 1 if the sweep crosses the angle
+ *  where they peak, otherwise at one of the ends.
+ */
+
+static void _arc_envelope(const float theta, const float angular_travel, float* max_sin, float* max_cos)
+{
+    float lo = std::min(theta, theta + angular_travel);
+    float hi = std::max(theta, theta + angular_travel);
+
+    if ((hi - lo) >= M_PI) {
+        *max_sin = 1;
+        *max_cos = 1;
+        return;
+    }
+    *max_sin = std::max(std::abs(sin(lo)), std::abs(sin(hi)));
+    *max_cos = std::max(std::abs(cos(lo)), std::abs(cos(hi)));
+
+    if (floor((hi - M_PI/2) / M_PI) != floor((lo - M_PI/2) / M_PI)) {  // crosses pi/2 + k pi
+        *max_sin = 1;
+    }
+    if (floor(hi / M_PI) != floor(lo / M_PI)) {                        // crosses k pi
+        *max_cos = 1;
+    }
+}
@@ -71,6 +71,7 @@ static float _get_meet_velocity(const float          v_0,
                                 const float          L,
                                 mpBuf_t*             bf,
                                 mpBlockRuntimeBuf_t* block) HOT_FUNC;
+static bool _stored_ramps_fit(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float entry_velocity);
 
 /****************************************************************************************
  * mp_calculate_ramps() - calculate trapezoid-like ramp parameters for a block
@@ -140,17 +141,12 @@ stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float e
     block->tail_length = 0;
 
     // handle overrides
-    bf->override_factor = 1.0;
-    if (bf->gm.motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) {
-        bf->override_factor = cm->gmx.mto_enable ? cm->gmx.mto_factor : BASE_STATE_MTO_FACTOR;
-    }
-    else if ((bf->gm.motion_mode == MOTION_MODE_STRAIGHT_FEED) || (bf->gm.motion_mode == MOTION_MODE_CW_ARC) || (bf->gm.motion_mode == MOTION_MODE_CCW_ARC)) {
-        bf->override_factor = cm->gmx.mfo_enable ? cm->gmx.mfo_factor : BASE_STATE_MFO_FACTOR;
-    }
+    bf->override_factor = mp_get_override_factor(bf->motion_mode);
 
     // bf->cruise_vmax adjusted by override cannot go above absolute vmax,
     //   and should stay below the back-planned cruise velocity.
     bf->cruise_vmax = std::min(bf->absolute_vmax, std::min(bf->cruise_velocity, bf->override_factor * bf->cruise_vset));
+    bf->cruise_vmax = mp_get_horizon_vmax(bf, bf->cruise_vmax);    // ...and no faster than the queue can stop from
 
     //   also cannot go below the entry velocity, but if it does,
     //   we have to make sure that the exit velocity reflects what we wanted cruise to be
@@ -302,6 +298,73 @@ stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float e
     // We don't really care if it's symmetric, since the first test that _get_meet_velocity
     //  does is for a symmetric move. It's cheaper to just let it do that then to try and prevent it.
 
+    // *** Stored-Fit case *** ramps fitted when the job was compiled (see sd_job.h)
+    if (_stored_ramps_fit(block, bf, entry_velocity)) {
+        return (_ramp_exit_logger(bf, "2s"));
+    }
+    return (mp_fit_ramps(block, bf, entry_velocity));
+}
+
+/*
+ * _stored_ramps_fit() - use the ramps stored with the block if they fit what was planned
+ *
+ *  The stored head and tail were fitted by mp_fit_ramps() to the velocities of the stored
+ *  plan, and still fit if the block enters and exits at those velocities. That happens
+ *  whenever the queue is deep enough for the live plan to reach the stored one - the exit
+ *  is capped at the stored exit, so they meet exactly. The cruise must also be as planned,
+ *  unless the stored fit was a bump (no body) that never reached the cruise anyway. The
+ *  rest of the block - body and times - follows from the lengths. The compiler rounds the
+ *  line to steps as mp_aline() does, so the lengths agree, but the fit is used only if the
+ *  body takes up any difference. Returns false to fit the ramps as usual.
+ */
+
+static bool _stored_ramps_fit(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float entry_velocity)
+{
+    const mpStoredPlan_t* plan = &bf->plan;
+
+    if (!bf->has_plan || bf->hold_jerk ||
+        !VELOCITY_EQ(entry_velocity, plan->entry_velocity) || !VELOCITY_EQ(block->exit_velocity, plan->exit_velocity)) {
+        return (false);
+    }
+    float body_length = bf->length - (plan->head_length + plan->tail_length);
+    if (body_length < -EPSILON4) {
+        return (false);
+    }
+    bool bump = (body_length < EPSILON4);
+    if (!VELOCITY_EQ(block->cruise_velocity, plan->cruise_velocity) &&
+        !(bump && (block->cruise_velocity > plan->cruise_velocity))) {
+        return (false);
+    }
+    block->cruise_velocity = plan->cruise_velocity;
+    block->head_length = plan->head_length;
+    block->tail_length = plan->tail_length;
+    block->body_length = std::max(body_length, (float)0);
+
+    if (fp_NOT_ZERO(block->head_length)) {
+        block->head_time = (block->head_length * 2.0) / (entry_velocity + block->cruise_velocity);
+    }
+    if (fp_NOT_ZERO(block->body_length)) {
+        block->body_time = block->body_length / block->cruise_velocity;
+    }
+    if (fp_NOT_ZERO(block->tail_length)) {
+        block->tail_time = (block->tail_length * 2.0) / (block->exit_velocity + block->cruise_velocity);
+    }
+    bf->block_time = block->head_time + block->body_time + block->tail_time;
+    bf->hint = ASYMMETRIC_BUMP;
+    PROFILE_INC_STORED_FITS;
+    return (true);
+}
+
+/*
+ * mp_fit_ramps() - fit head, body and tail to the entry, cruise and exit velocities
+ *
+ *  The requested-fit and rate-limited-fit cases of mp_calculate_ramps(). Expects
+ *  block->cruise_velocity and block->exit_velocity to be set, and the section lengths and
+ *  times to be zeroed. Also used by the SD job compiler to fit the ramps it stores.
+ */
+
+stat_t mp_fit_ramps(mpBlockRuntimeBuf_t* block, mpBuf_t* bf, const float entry_velocity)
+{
     // *** Requested-Fit cases (2) ***
 
     // Prepare the head and tail lengths for evaluating cases (nb: zeros head / tail < min length)
@@ -484,8 +547,25 @@ float mp_get_decel_velocity(const float v_0, const float L, const mpBuf_t* bf)
  * and jerk (J), will locate the velocity v_1 that will allow acceleration from v_0
  * at jerk J to v_1 and then deceleration at jerk J to v_2, all over total length L.
  *
+ *  With Q = q_recip_2_sqrt_j the head and tail lengths are Q sqrt(v_1-v_0) (v_1+v_0) and
+ *  Q sqrt(v_1-v_2) (v_1+v_2). Let v_m be the larger of v_0 and v_2, v_n the smaller,
+ *  d = v_m - v_n, and solve for s = sqrt(v_1 - v_m) instead of v_1:
+ *
+ *      f(s) = s (2 v_m + s^2) + sqrt(s^2 + d) (v_m + v_n + s^2) = L/Q
+ *
+ *  f(s) is increasing and convex for s >= 0 and has no sqrt singularity at v_1 == v_m,
+ *  so Newton's method on s cannot wander off. The seed is the closed-form (Cardano) root of
+ *  the cubic we get by replacing sqrt(s^2 + d) with s + sqrt(d). That cubic is exact at s = 0
+ *  and for symmetric moves and is never below f(s), so the seed never overshoots the root.
+ *  The first refinement lands just above the root and the rest close in from above.
+ *  One or two refinements are typical. See the _pf0 - _pf4 profiling histogram.
+ *
+ *  If f(0) >= L/Q there is no meet velocity - the block is too short to even get from
+ *  v_n to v_m - and we fall back to a head or tail plus a body.
  */
 
+#define MEET_REFINEMENTS_MAX 8      // bounds the cost in the forward planning interrupt
+
 static float _get_meet_velocity(const float          v_0,
                                 const float          v_2,
                                 const float          L,
@@ -496,104 +576,126 @@ static float _get_meet_velocity(const float          v_0,
 
     // v_1 can never be smaller than v_0 or v_2, so we keep track of this value
     const float min_v_1 = std::max(v_0, v_2);
-
-    // v_1 is our estimated return value.
-    // We estimate with the speed obtained by L/2 traveled from the highest speed of v_0 or v_2.
-    float v_1 = mp_get_target_velocity(min_v_1, L / 2.0, bf);
-    // var v_1 = min_v_1 + 100;
+    float v_1;
 
     if (fp_EQ(v_0, v_2)) {
         // Case (1)
         // We can catch a symmetric case early and return now
 
         // We'll have a head roughly equal to the tail, and no body
+        v_1 = mp_get_target_velocity(min_v_1, L / 2.0, bf);
         block->head_length = L / 2.0;
         block->body_length = 0;
         block->tail_length = L - block->head_length;
         SET_PLANNER_ITERATIONS(-1);     // DIAGNOSTIC
+        PROFILE_MEET_ITERATIONS(0);
         return v_1;
     }
 
-    // Per iteration: 2 sqrt, 2 abs, 6 -, 4 +, 12 *, 3 /
-    int i = 0;          // limit the iterations // 466us - 644us
-    while (i++ < 30) {  // If it fails after 30, something's wrong
-        if (v_1 < min_v_1) {
-            // Case (2)
-            // We have caught a rather nasty problem. There is no meet velocity.
-            // This is due to an inversion in the velocities of very short moves.
-            // We need to compute the head OR tail length, and the body will be the rest.
-            // Yes, that means we're computing a cruise in here.
-
-            v_1 = min_v_1;
-
-            if (v_0 < v_2) {
-                // acceleration - it'll be a head/body
-                block->head_length = mp_get_target_length(v_0, v_2, bf);
-                if (block->head_length > L) {
-                    block->head_length = L;
-                    block->body_length = 0;
-                    v_1 = mp_get_target_velocity(v_0, L, bf);
-                } else {
-                    block->body_length = L - block->head_length;
-                }
-                block->tail_length = 0;
-
+    const float v_m = min_v_1;
+    const float v_n = std::min(v_0, v_2);
+    const float d = v_m - v_n;
+    const float sqrt_d = sqrt(d);
+
+    if ((q_recip_2_sqrt_j * sqrt_d * (v_m + v_n)) >= L) {
+        // Case (2)
+        // We have caught a rather nasty problem. There is no meet velocity.
+        // This is due to an inversion in the velocities of very short moves.
+        // We need to compute the head OR tail length, and the body will be the rest.
+        // Yes, that means we're computing a cruise in here.
+
+        v_1 = min_v_1;
+
+        if (v_0 < v_2) {
+            // acceleration - it'll be a head/body
+            block->head_length = mp_get_target_length(v_0, v_2, bf);
+            if (block->head_length > L) {
+                block->head_length = L;
+                block->body_length = 0;
+                v_1 = mp_get_target_velocity(v_0, L, bf);
             } else {
-                // deceleration - it'll be tail/body
-                block->tail_length = mp_get_target_length(v_2, v_0, bf);
-                if (block->tail_length > L) {
-                    block->tail_length = L;
-                    block->body_length = 0;
-                    v_1 = mp_get_target_velocity(v_2, L, bf);
-                } else {
-                    block->body_length = L - block->tail_length;
-                }
-                block->head_length = 0;
+                block->body_length = L - block->head_length;
             }
-
-            break;
+            block->tail_length = 0;
+
+        } else {
+            // deceleration - it'll be tail/body
+            block->tail_length = mp_get_target_length(v_2, v_0, bf);
+            if (block->tail_length > L) {
+                block->tail_length = L;
+                block->body_length = 0;
+                v_1 = mp_get_target_velocity(v_2, L, bf);
+            } else {
+                block->body_length = L - block->tail_length;
+            }
+            block->head_length = 0;
         }
+        SET_MEET_ITERATIONS(0);     // DIAGNOSTIC
+        PROFILE_MEET_ITERATIONS(0);
+        return v_1;
+    }
 
-        // Precompute some common chunks -- note that some attempts may have v_1 < v_0 or v_1 < v_2
-        const float sqrt_delta_v_0 = sqrt(std::abs(v_1 - v_0));
-        const float sqrt_delta_v_2 = sqrt(std::abs(v_1 - v_2));  // 849us
-
-        // l_c is our total-length calculation with the current v_1 estimate, minus the expected length.
-        // This makes l_c == 0 when v_1 is the correct value.
+    // Seed: s^3 + B s^2 + C s + E = 0, depressed to y^3 + P y + R = 0 with s = y - B/3.
+    // P is always positive here (d <= v_m), so there is exactly one real root.
+    const float B = sqrt_d / 2;
+    const float C = (3 * v_m + v_n) / 2;
+    const float E = (sqrt_d * (v_m + v_n) - L / q_recip_2_sqrt_j) / 2;
+    const float P = C - (B * B) / 3;
+    const float R = ((2 * B * B * B) / 27) - ((B * C) / 3) + E;
+    const float A = -copysignf(cbrtf(std::abs(R) / 2 + sqrt((R * R) / 4 + (P * P * P) / 27)), R);
+    float s = ((A == 0) ? 0 : (A - P / (3 * A))) - B / 3;
+    if (s < 0) {
+        s = 0;
+    }
 
-        // GAMBLE: At the cost of one more multiply per iteration, we will keep the two length calculations seperate.
-        // This allows us to store the resulting head/tail lengths.
-        const float l_h = q_recip_2_sqrt_j * (sqrt_delta_v_0 * (v_1 + v_0));
-        const float l_t = q_recip_2_sqrt_j * (sqrt_delta_v_2 * (v_1 + v_2));
-        const float l_c = (l_h + l_t) - L;
+    // Per refinement: 1 sqrt, 10 *, 3 /
+    uint8_t i = 0;
+    float l_m, l_n, l_c;
+    while (true) {
+        const float s_2 = s * s;
+        const float g = sqrt(s_2 + d);
+        const float k = v_m + v_n + s_2;
 
-        block->head_length = l_h;
-        block->tail_length = l_t;
-        block->body_length = 0;
+        // l_c is our total-length calculation with the current estimate, minus the expected length.
+        // This makes l_c == 0 when s is the correct value.
+        l_m = q_recip_2_sqrt_j * s * (2 * v_m + s_2);
+        l_n = q_recip_2_sqrt_j * g * k;
+        l_c = (l_m + l_n) - L;
 
         // We need this level of precision, or our length computations fail to match the block length.
         // What we really want to ensure is that the two lengths down add up to be too much.
         // We can be a little under (and have a small body).
-
-        // TODO: make these tunable
-        if ((l_c < 0.00001) && (l_c > -1.0)) {  // allow 0.00001 overlap, OR up to a 1mm gap
-            if (l_c < 0.0) {
-                // Case (3a)
-                block->body_length = -l_c;
-            } else {
-                // Case (3b)
-                // fix the overlap
-                block->tail_length = L - block->head_length;
-            }
+        if (((l_c < 0.00001) && (l_c > -1.0)) || (i == MEET_REFINEMENTS_MAX)) {  // allow 0.00001 overlap, OR up to a 1mm gap
             break;
         }
+        const float s_over_g = (g > 0) ? (s / g) : 1;   // s/g -> 1 as s -> 0 when d == 0
+        const float f_prime = 2 * v_m + 3 * s_2 + s_over_g * k + 2 * s * g;
+        s -= l_c / (q_recip_2_sqrt_j * f_prime);
+        if (s < 0) {
+            s = 0;
+        }
+        i++;
+    }
+    v_1 = v_m + s * s;
 
-        const float v_1x3     = 3 * v_1;
-        const float recip_l_d = (2 * sqrt_delta_v_0 * sqrt_delta_v_2) /
-                                ((sqrt_delta_v_0 * (v_1x3 - v_2) - (v_0 - v_1x3) * sqrt_delta_v_2) * q_recip_2_sqrt_j);
+    if (v_0 > v_2) {
+        block->head_length = l_m;
+        block->tail_length = l_n;
+    } else {
+        block->head_length = l_n;
+        block->tail_length = l_m;
+    }
+    block->body_length = 0;
 
-        v_1 = v_1 - (l_c * recip_l_d);
+    if (l_c < 0.0) {
+        // Case (3a)
+        block->body_length = -l_c;
+    } else {
+        // Case (3b)
+        // fix the overlap
+        block->tail_length = L - block->head_length;
     }
     SET_MEET_ITERATIONS(i);     // DIAGNOSTIC
+    PROFILE_MEET_ITERATIONS(i);
     return v_1;
 }
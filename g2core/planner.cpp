@@ -64,6 +64,8 @@
 #include "json_parser.h"
 #include "xio.h"    //+++++ DIAGNOSTIC - only needed if xio_writeline() direct prints are used
 
+#include <type_traits>
+
 // Allocate planner structures
 
 mpPlanner_t *mp;                            // currently active planner (global variable)
@@ -76,6 +78,18 @@ mpPlannerRuntime_t mr2;                     // secondary planner runtime context
 
 mpBuf_t mp1_queue[PLANNER_QUEUE_SIZE];      // storage allocation for primary planner queue buffers
 mpBuf_t mp2_queue[SECONDARY_QUEUE_SIZE];    // storage allocation for secondary planner queue buffers
+mpGmRecord_t mp1_gm_pool[PLANNER_GM_POOL_SIZE];    // gm storage shared by primary planner queue buffers
+mpGmRecord_t mp2_gm_pool[SECONDARY_GM_POOL_SIZE];  // gm storage shared by secondary planner queue buffers
+mpArc_t mp1_arc_pool[PLANNER_QUEUE_SIZE];       // arc storage for primary planner queue buffers
+mpArc_t mp2_arc_pool[SECONDARY_QUEUE_SIZE];     // arc storage for secondary planner queue buffers
+
+static_assert((PLANNER_QUEUE_SIZE > PLANNER_BUFFER_HEADROOM), "PLANNER_QUEUE_SIZE (or PLANNER_QUEUE_MEMORY) is too small");
+static_assert((PLANNER_GM_POOL_SIZE > PLANNER_BUFFER_HEADROOM), "PLANNER_GM_POOL_SIZE is too small - lower PLANNER_GM_SHARING");
+static_assert(std::is_standard_layout<mpGmRecord_t>::value, "_release_gm() finds a gm record from its gm");
+
+#ifdef __PLANNER_PROFILING
+mpPlannerProfile_t mpf;                     // planner profiling counters
+#endif
 
 // Execution routines (NB: These are called from the LO interrupt)
 static stat_t _exec_dwell(mpBuf_t *bf);
@@ -149,26 +163,40 @@ _json_commands_t jc;
  */
 
 // initialize a planner queue
-void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, uint8_t size)
+void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, mpArc_t *arc_pool, uint16_t size, mpGmRecord_t *gm_pool, uint16_t gm_size)
 {
     mpBuf_t *pv, *nx;
-    uint8_t i, nx_i;
+    uint16_t i, nx_i;
     mpPlannerQueue_t *q = &(_mp->q);
 
-    memset(q, 0, sizeof(mpPlannerQueue_t)); // clear values, pointers and status
+    // Every field is set here. Not memset, as the counts are atomic
     q->magic_start = MAGICNUM;
     q->magic_end = MAGICNUM;
 
     memset(queue, 0, sizeof(mpBuf_t)*size); // clear all buffers in queue
+    memset(arc_pool, 0, sizeof(mpArc_t)*size);
+    for (i=0; i < gm_size; i++) {
+        gm_pool[i].gm.reset();
+        gm_pool[i].refs.store(0);           // all gm records are free
+    }
     q->bf = queue;                          // link the buffer pool first
+    q->arc = arc_pool;
+    q->gm = gm_pool;
+    q->gm_last = nullptr;
+    q->gm_size = gm_size;
+    q->gm_next = 0;
+    q->gm_free.store(gm_size);
     q->w = queue;                           // init all buffer pointers
     q->r = queue;
     q->queue_size = size;
-    q->buffers_available = size;
+    q->committed.store(0);
+    q->freed.store(0);
+    q->claimed = 0;
 
     pv = &q->bf[size-1];
     for (i=0; i < size; i++) {
         q->bf[i].buffer_number = i;         // number is for diagnostics only (otherwise not used)
+        q->bf[i].arc_data = &arc_pool[i];   // bind the buffer to its cold arc storage
         nx_i = ((i<size-1) ? (i+1) : 0);    // buffer increment & wrap
         nx = &q->bf[nx_i];
         q->bf[i].nx = nx;                   // setup circular list pointers
@@ -178,23 +206,32 @@ void _init_planner_queue(mpPlanner_t *_mp, mpBuf_t *queue, uint8_t size)
     q->bf[size-1].nx = queue;
 }
 
-void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, uint8_t queue_size)
+void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, mpArc_t *arc_pool, uint16_t queue_size, mpGmRecord_t *gm_pool, uint16_t gm_pool_size)
 {
-    // init planner master structure
-    memset(_mp, 0, sizeof(mpPlanner_t));    // clear all values, pointers and status
+    // init planner master structure. Not memset, as the queue has atomic counts
     _mp->magic_start = MAGICNUM;            // set boundary condition assertions
     _mp->magic_end = MAGICNUM;
-    _mp->mfo_factor = BASE_STATE_MFO_FACTOR;
+    _mp->reset();                           // clear times, horizon and planner state
+    _mp->run_time_remaining_ms = 0;
+    _mp->plannable_time_ms = 0;
+    clear_vector(_mp->position);
+    _mp->p = nullptr;
+    _mp->c = nullptr;
+    _mp->planning_return = nullptr;
 
     // init planner queues
     _mp->q.bf = queue;                      // assign puffer pool to queue manager structure
-    _init_planner_queue(_mp, queue, queue_size);
+    _init_planner_queue(_mp, queue, arc_pool, queue_size, gm_pool, gm_pool_size);
 
     // init runtime structs
     _mp->mr = _mr;
     memset(_mr, 0, sizeof(mpPlannerRuntime_t)); // clear all values, pointers and status
     _mr->magic_start = MAGICNUM;            // mr assertions
     _mr->magic_end = MAGICNUM;
+    _mr->override_planned = 1.0;
+    _mr->override_scale = 1.0;
+    _mr->override_headroom = 1.0;
+    _mr->override_rate_max = 1.0 / FEED_OVERRIDE_RAMP_TIME;
 
     _mr->block[0].nx = &_mr->block[1];      // Handle the two "stub blocks" in the runtime structure
     _mr->block[1].nx = &_mr->block[0];
@@ -208,7 +245,8 @@ void planner_reset(mpPlanner_t *_mp)        // reset planner queue, cease MR act
     _mp->reset();
     _mp->mr->reset();
     jc.reset();
-    _init_planner_queue(_mp, _mp->q.bf, _mp->q.queue_size); // reset planner buffers
+    mp_clear_merge();                       // the line that could be extended is gone
+    _init_planner_queue(_mp, _mp->q.bf, _mp->q.arc, _mp->q.queue_size, _mp->q.gm, _mp->q.gm_size); // reset planner buffers
 }
 
 stat_t planner_assert(const mpPlanner_t *_mp)
@@ -217,8 +255,9 @@ stat_t planner_assert(const mpPlanner_t *_mp)
         (BAD_MAGIC(_mp->mr->magic_start)) || (BAD_MAGIC(_mp->mr->magic_end))) {
         return (cm_panic(STAT_PLANNER_ASSERTION_FAILURE, "planner_assert()"));
     }
-    for (uint8_t i=0; i < _mp->q.queue_size; i++) {
-        if ((_mp->q.bf[i].nx == nullptr) || (_mp->q.bf[i].pv == nullptr)) {
+    for (uint16_t i=0; i < _mp->q.queue_size; i++) {
+        if ((_mp->q.bf[i].nx == nullptr) || (_mp->q.bf[i].pv == nullptr) ||
+            (_mp->q.bf[i].gm == nullptr) || (_mp->q.bf[i].arc_data == nullptr)) {
             return (cm_panic(STAT_PLANNER_ASSERTION_FAILURE, "planner buffer is corrupted"));
         }
     }
@@ -249,6 +288,7 @@ void mp_halt_runtime()
  *
  *     - mp->position - start and end position for planning
  *     - mr->position - current position of runtime segment
+ *     - mr->position_fixed - the same in fixed point, the master copy while a block runs
  *     - mr->target   - target position of runtime segment
  *
  *  The runtime keeps a lot more data, such as waypoints, step vectors, etc.
@@ -260,7 +300,7 @@ void mp_halt_runtime()
  */
 
 void mp_set_planner_position(uint8_t axis, const float position) { mp->position[axis] = position; }
-void mp_set_runtime_position(uint8_t axis, const float position) { mr->position[axis] = position; }
+void mp_set_runtime_position(uint8_t axis, const float position) { mr->position[axis] = position; sr_flag_change(SR_CHANGED_RUNTIME); }
 
 void mp_set_steps_to_runtime_position()
 {
@@ -319,7 +359,8 @@ stat_t mp_set_target_steps(const float target_steps[MOTORS])
         mr->following_error[m] = mr->encoder_steps[m] - mr->commanded_steps[m];
     }
 
-    return st_prep_line(mr->segment_velocity, mr->target_velocity, mp_travel_steps, mr->following_error, mr->segment_time);
+    // the runtime feed override stretches the time the steppers take for the segment (see _exec_override())
+    return st_prep_line(mr->segment_velocity, mr->target_velocity, mp_travel_steps, mr->following_error, mr->segment_time / mr->override_scale);
 }
 
 stat_t mp_set_target_steps(const float target_steps[MOTORS], const float start_velocities[MOTORS], const float end_velocities[MOTORS], const float segment_time)
@@ -370,18 +411,18 @@ void mp_queue_command(cm_exec_t cm_exec, float *value, bool *flag)
     mpBuf_t *bf;
 
     // Never supposed to fail as buffer availability was checked upstream in the controller
-    if ((bf = mp_get_write_buffer()) == NULL) {
+    // Commands carry a snapshot of the active gcode state
+    if (((bf = mp_get_write_buffer()) == NULL) || !mp_attach_gm(bf, &cm->gm)) {
         cm_panic(STAT_FAILED_GET_PLANNER_BUFFER, "mp_queue_command()");
         return;
     }
     bf->block_type = BLOCK_TYPE_COMMAND;
-    memcpy(&bf->gm, &cm->gm, sizeof(GCodeState_t)); // snapshot the active gcode state
     bf->bf_func = _exec_command;      // callback to planner queue exec function
     bf->cm_func = cm_exec;            // callback to canonical machine exec function
 
-    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {
-        bf->unit[axis] = value[axis];               // use the unit vector to store command values
-        bf->axis_flags[axis] = flag[axis];
+    for (uint8_t axis = AXIS_X; axis < AXES; axis++) {   // value and flag are AXES long, or nullptr if not used
+        bf->unit[axis] = (value != nullptr) ? value[axis] : 0;  // use the unit vector to store command values
+        bf->axis_flags[axis] = (flag != nullptr) ? flag[axis] : false;
     }
     mp_commit_write_buffer(BLOCK_TYPE_COMMAND);     // must be final operation before exit
 }
@@ -535,20 +576,28 @@ void mp_request_out_of_band_dwell(float seconds)
  * Planner helpers
  *
  * mp_get_planner_buffers()  - return # of available planner buffers
+ * mp_get_queued_buffers()   - return # of committed buffers not yet freed by the runtime
  * mp_planner_is_full()      - true if planner has no room for a new block
  * mp_has_runnable_buffer()  - true if next buffer is runnable, indicating motion has not stopped.
  * mp_is_it_phat_city_time() - test if there is time for non-essential processes
  */
 
-uint8_t mp_get_planner_buffers(const mpPlanner_t *_mp)  // which planner are you interested in?
+uint16_t mp_get_planner_buffers(const mpPlanner_t *_mp)  // which planner are you interested in?
+{
+    return (_mp->q.queue_size - mp_get_queued_buffers(_mp) - _mp->q.claimed);
+}
+
+uint16_t mp_get_queued_buffers(const mpPlanner_t *_mp)   // which planner are you interested in?
 {
-    return (_mp->q.buffers_available);
+    const mpPlannerQueue_t *q = &(_mp->q);
+    return ((uint16_t)(q->committed.load(std::memory_order_acquire) - q->freed.load(std::memory_order_acquire)));
 }
 
 bool mp_planner_is_full(const mpPlanner_t *_mp)         // which planner are you interested in?
 {
     // We also need to ensure we have room for another JSON command
-    return ((_mp->q.buffers_available < PLANNER_BUFFER_HEADROOM) || (jc.available == 0));
+    return ((mp_get_planner_buffers(_mp) < PLANNER_BUFFER_HEADROOM) ||
+            (_mp->q.gm_free.load(std::memory_order_acquire) < PLANNER_BUFFER_HEADROOM) || (jc.available == 0));
 }
 
 bool mp_has_runnable_buffer(const mpPlanner_t *_mp)     // which planner are you interested in?)
@@ -672,51 +721,55 @@ void mp_replan_queue(mpBuf_t *bf, bool back_too/*=false*/)
 }
 
 /*
- *  mp_start_feed_override() - gradually adjust existing and new buffers to target override percentage
- *  mp_end_feed_override() - gradually adjust existing and new buffers to no override percentage
+ *  mp_get_override_factor() - return the override factor currently requested for a motion mode
+ *  mp_start_feed_override() - ramp running and new moves to the override factor in cm->gmx
+ *  mp_end_feed_override()   - ramp running and new moves back to no override
  *
  *  Variables:
- *    - 'mfo_factor' is the override scaling factor normalized to 1.0 = 100%
- *      Values < 1.0 are speed decreases, > 1.0 are increases. Upper and lower limits are checked.
+ *    - The override factor is not passed in. It is read from cm->gmx (mfo_factor, mfo_enable)
+ *      by mp_get_override_factor() each time it is needed, normalized to 1.0 = 100%.
+ *      Upper and lower limits are checked upstream.
  *
- *    - 'ramp_time' is approximate, as the ramp dynamically changes move execution times
- *      The ramp will attempt to meet the time specified but it will not be exact.
+ *    - 'ramp_time' is the time in seconds for the runtime override to change by 1.00 at its
+ *      full rate. The start and end of the ramp are jerk limited (FEED_OVERRIDE_JERK_TIME).
  */
 /*  Function:
- *  The override takes effect as close to real-time as possible. Practically, this means about 20 or
- *  so behind the current running move. How it works:
+ *  Overrides are applied in two places, and neither of them replans the queue:
  *
- *    - If the planner is idle just apply the override factor and be done with it. That's easy.
- *    - Otherwise look for the "break point" at 20 ms
+ *    - Each block takes the requested factor when it is forward planned (mp_calculate_ramps()).
+ *      Forward planning runs just ahead of the runtime, so every block that has not been
+ *      forward planned yet picks up a new factor as the queue drains.
+ *
+ *    - Blocks that are already planned or running are scaled by the runtime, which compares
+ *      the requested factor to the one the running block was planned with and stretches the
+ *      stepper time of each segment (see _exec_override() in plan_exec.cpp). This takes
+ *      effect on the next segment prepped, so the knob responds within a segment time.
+ *
+ *  Overrides set with {fro:n} or {froe:n} take effect the same way on the next segment.
  */
 
-////##fro
-void mp_start_feed_override(const float ramp_time, const float override_factor)
+float mp_get_override_factor(const cmMotionMode motion_mode)
 {
-    cm->mfo_state = MFO_REQUESTED;
-
-    if (mp->planner_state == PLANNER_IDLE) {
-        mp->mfo_factor = override_factor;             // that was easy
-        return;
+    if (motion_mode == MOTION_MODE_STRAIGHT_TRAVERSE) {
+        return (cm->gmx.mto_enable ? cm->gmx.mto_factor : BASE_STATE_MTO_FACTOR);
     }
-
-    // Assume that the min and max values for override_factor have been validated upstream
-    // SUVAT: V = U+AT ==> A = (V-U)/T
-    mp->ramp_target = override_factor;
-    mp->ramp_dvdt = (override_factor - mp->c->override_factor) / ramp_time;
-    mp->mfo_active = true;
-
-    if (fp_NOT_ZERO(mp->ramp_dvdt)) {    // do these things only if you actually have a ramp to run
-        mp->p = mp->c;                    // re-position the planner pointer
-        mp->ramp_active = true;
-        mp->request_planning = true;
+    if ((motion_mode == MOTION_MODE_STRAIGHT_FEED) || (motion_mode == MOTION_MODE_CW_ARC) || (motion_mode == MOTION_MODE_CCW_ARC)) {
+        return (cm->gmx.mfo_enable ? cm->gmx.mfo_factor : BASE_STATE_MFO_FACTOR);
     }
+    return (1.0);
+}
+
+////##fro
+void mp_start_feed_override(const float ramp_time)
+{
+    cm->mfo_state = MFO_REQUESTED;
+    mr->override_rate_max = 1.0 / ramp_time;
 }
 
 ////##fro
 void mp_end_feed_override(const float ramp_time)
 {
-    mp_start_feed_override (FEED_OVERRIDE_RAMP_TIME, 1.00);
+    mp_start_feed_override(ramp_time);
 }
 
 // void mp_start_traverse_override(const float ramp_time, const float override_factor)
@@ -730,23 +783,51 @@ void mp_end_feed_override(const float ramp_time)
 // }
 
 /*
- * mp_planner_time_accounting() - gather time in planner
+ * mp_planner_time_accounting() - gather time and path length in planner
+ *
+ *  Called by the runtime as each block starts running.
+ *
+ *  plannable_time is the time in blocks that can no longer be replanned. The horizon
+ *  is everything queued ahead of the running block - the path the planner has to work
+ *  with. The planner always plans to stop at the end of the queue, so if the horizon is
+ *  shorter than the distance needed to brake from the running block's cruise velocity
+ *  the machine is being slowed by the queue and not by the path. Those blocks are
+ *  counted in qsh while new blocks are still arriving.
  */
 
 void mp_planner_time_accounting()
 {
-    mpBuf_t *bf = mp_get_r();                       // start with run buffer
+    mpBuf_t *run = mp_get_r();                      // start with run buffer
+    mpBuf_t *bf = run;
+
+    mp->horizon_length = 0;
+    mp->horizon_time = 0;
 
     // check the run buffer to see if anything is running. Might not be
-    if (bf->buffer_state != MP_BUFFER_RUNNING) {    // this is not an error condition
+    if (run->buffer_state != MP_BUFFER_RUNNING) {   // this is not an error condition
         return;
     }
     mp->plannable_time = 0; //UPDATE_BF_MS(bf);     // DIAGNOSTIC
-    while ((bf = bf->nx) != mp_get_r()) {
-        if (bf->buffer_state == MP_BUFFER_EMPTY || bf->plannable == true) {
+    bool plannable = false;
+    while ((bf = bf->nx) != run) {
+        if (bf->buffer_state < MP_BUFFER_NOT_PLANNED) {
             break;
         }
-        mp->plannable_time += bf->block_time;
+        plannable |= bf->plannable;
+        if (!plannable) {
+            mp->plannable_time += bf->block_time;
+        }
+        if (bf->block_type == BLOCK_TYPE_ALINE) {
+            mp->horizon_length += bf->length;
+            mp->horizon_time += bf->block_time;     // an estimate until the block is forward planned
+        }
+    }
+    if (mp->block_timeout.isSet()) {                // only sample while new blocks are still arriving
+        qs_sample_plannable_time(mp->plannable_time);
+        if ((run->block_type == BLOCK_TYPE_ALINE) &&
+            (mp->horizon_length < mp_get_target_length(0, run->cruise_velocity, run))) {
+            qr.horizon_short++;
+        }
     }
     UPDATE_MP_DIAGNOSTICS                           // DIAGNOSTIC
 }
@@ -793,6 +874,11 @@ void mp_planner_time_accounting()
  *  run buffer pointer only moves forward on mp_free_run_buffer().
  *  Tests, gets and unget have no effect on the pointers.
  *
+ *  The queue is a single-producer/single-consumer ring (see mpPlannerQueue_t). Whether
+ *  a buffer can be written or run is decided from the committed and freed counts, not
+ *  from its buffer_state, so neither side relies on the interrupt priorities to keep
+ *  the other from changing a buffer under it.
+ *
  * Functions Provided:
  *   _clear_buffer(bf)        Zero the contents of a buffer
  *
@@ -825,9 +911,24 @@ void mp_planner_time_accounting()
  *   mp_copy_buffer(bf,bp)    Copy the contents of bp into bf - preserves links.
  */
 
+// Drops the buffer's reference to its gm record. The record is free when the last
+// buffer using it lets go. Called by the producer and the consumer. The consumer is an
+// interrupt, so the producer only ever sees its release complete.
+static inline void _release_gm(mpPlannerQueue_t *q, mpBuf_t *bf)
+{
+    if (bf->gm != nullptr) {
+        mpGmRecord_t *record = reinterpret_cast<mpGmRecord_t *>(bf->gm);
+        if (record->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            q->gm_free.fetch_add(1, std::memory_order_release);
+        }
+        bf->gm = nullptr;
+    }
+}
+
 // Also clears unlocked, so the buffer cannot be used
-static inline void _clear_buffer(mpBuf_t *bf)
+static inline void _clear_buffer(mpPlannerQueue_t *q, mpBuf_t *bf)
 {
+    _release_gm(q, bf);
     bf->reset();    // Call a reset method on the buffer object.
 }
 
@@ -842,13 +943,13 @@ mpBuf_t * mp_get_r() { return (mp->q.r); }
 
 mpBuf_t * mp_get_write_buffer()     // get & clear a buffer
 {
-
     mpPlannerQueue_t *q = &(mp->q);
 
-    if (q->w->buffer_state == MP_BUFFER_EMPTY) {
-        _clear_buffer(q->w);        // NB: this is redundant if the buffer was cleared mp_free_run_buffer()
+    // The acquire load of freed makes sure the runtime has finished clearing the buffer
+    if (!q->claimed && (mp_get_queued_buffers(mp) < q->queue_size)) {
+        _clear_buffer(q, q->w);     // NB: this is redundant if the buffer was cleared mp_free_run_buffer()
         q->w->buffer_state = MP_BUFFER_INITIALIZING;
-        q->buffers_available--;
+        q->claimed = 1;
         return (mp_get_w());
     }
     // The no buffer condition always causes a panic - invoked by the caller
@@ -860,9 +961,10 @@ void mp_unget_write_buffer()        // mark buffer as empty and adjust free buff
 {
     mpPlannerQueue_t *q = &(mp->q);
 
-    if (q->w->buffer_state != MP_BUFFER_EMPTY) {  // safety. Can't unget an empty buffer
+    if (q->claimed) {               // safety. Can't unget a buffer that was never got
+        _release_gm(q, q->w);
         q->w->buffer_state = MP_BUFFER_EMPTY;
-        q->buffers_available++;
+        q->claimed = 0;
     }
 }
 
@@ -877,6 +979,10 @@ void mp_commit_write_buffer(const blockType block_type)
 
     q->w->block_type = block_type;
     q->w->block_state = BLOCK_INITIAL_ACTION;
+    q->w->plannable = true;                 // enable block for planning
+    q->w = q->w->nx;                        // advance write buffer pointer
+    q->claimed = 0;
+    q->committed.store(q->committed.load(std::memory_order_relaxed) + 1, std::memory_order_release); // publish the buffer
 
     if (block_type != BLOCK_TYPE_ALINE) {
         if ((mp->planner_state > PLANNER_STARTUP) && (cm->hold_state == FEEDHOLD_OFF)) {
@@ -884,31 +990,36 @@ void mp_commit_write_buffer(const blockType block_type)
             // processed IMMEDIATELY and then freed - invalidating the contents
             st_request_forward_plan();      // request an exec if the runtime is not busy
         }
+    } else {
+        PROFILE_INC_BLOCKS;                 // count motion blocks for planner profiling
     }
-    q->w->plannable = true;                 // enable block for planning
     mp->request_planning = true;
-    q->w = q->w->nx;                        // advance write buffer pointer
     mp->block_timeout.set(BLOCK_TIMEOUT_MS);// reset the block timer
     qr_request_queue_report(+1);            // request QR and add to "added buffers" count
 }
 
 // Note: mp_get_run_buffer() is only called by mp_exec_move(), which is inside an interrupt
-// EMPTY and INITALIZING are the two cases where nothing is returned. This is not an error
-// Otherwise return the buffer. Let mp_exec_move() manage the state machine to sort out:
+// Nothing is returned if no buffer has been committed, or if the committed buffer is still
+// INITIALIZING (not yet planned). This is not an error. Otherwise return the buffer.
+// Let mp_exec_move() manage the state machine to sort out:
 //  (1) is the the first time the run buffer has been retrieved?
 //  (2) is the buffer in error - i.e. not yet ready for running?
 mpBuf_t * mp_get_run_buffer()
 {
     mpBuf_t *r = mp->q.r;
 
-    if (r->buffer_state == MP_BUFFER_EMPTY || r->buffer_state == MP_BUFFER_INITIALIZING) {
+    if (mp_get_queued_buffers(mp) == 0) {   // acquire - the buffer contents are visible from here on
+        return (NULL);
+    }
+    if (r->buffer_state == MP_BUFFER_INITIALIZING) {
         return (NULL);
     }
     return (r);
 }
 
 // Note: mp_free_run_buffer() is only called from mp_exec_XXX, which are within an interrupt
-// Clearing and advancing must be done atomically as other interrupts may be using the run buffer
+// The buffer is cleared and the run pointer advanced before the freed count is published,
+// so the producer never sees a free buffer that is still being cleared
 bool mp_free_run_buffer()           // EMPTY current run buffer & advance to the next
 {
     mpPlannerQueue_t *q = &(mp->q);
@@ -916,18 +1027,104 @@ bool mp_free_run_buffer()           // EMPTY current run buffer & advance to the
 
     _audit_buffers();               // DIAGNOSTIC audit for buffer chain integrity (only runs in DEBUG mode)
     q->r = q->r->nx;                // advance to next run buffer first...
-    _clear_buffer(r_now);           // ... then clear out the old buffer (& set MP_BUFFER_EMPTY)
+    _clear_buffer(q, r_now);        // ... then clear out the old buffer (& set MP_BUFFER_EMPTY)
 //    r_now->buffer_state = MP_BUFFER_EMPTY; //... then mark the buffer empty while preserving content for debug inspection
-    q->buffers_available++;
+    q->freed.store(q->freed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
     qr_request_queue_report(-1);    // request a QR and add to the "removed buffers" count
-    return (q->w == q->r);          // return true if the queue emptied
+    return (mp_get_queued_buffers(mp) == 0);   // return true if the queue emptied
+}
+
+/*
+ * mp_attach_gm()    - point a write buffer at a gm record holding the model state in _gm
+ * mp_get_block_gm() - put a buffer's full Gcode model state back together in gm
+ *
+ *  mp_attach_gm() copies the per-move fields of _gm into the buffer - the ones that can
+ *  change on every line. The rest is the modal state, which is shared. If it is the same
+ *  as in the last record written that record is shared, even if the runtime has freed it
+ *  since - only the producer writes records, so its contents are still good. Otherwise the
+ *  next free record is written. A field added to GCodeState_t must either be copied here
+ *  as a per-move field or compared in _gm_same_modal_state().
+ *
+ *  Sharing depends on the modal state staying the same between lines. G0/G1 alternation,
+ *  dwells and offset changes don't count, as those fields are per-move. Only a program that
+ *  changes units, plane, path control, tool or the like on every line gets a record per
+ *  block, and then it can only queue as many blocks as there are records. mp_planner_is_full()
+ *  holds back input when the free records run as low as the free buffers would.
+ *
+ *  Returns false if there was no free record. That is never supposed to happen.
+ */
+
+static bool _gm_same_modal_state(const GCodeState_t *a, const GCodeState_t *b)
+{
+    // Field by field, not memcmp, so that struct padding can't force a new record
+    return ((a->feed_rate_mode == b->feed_rate_mode) && (a->select_plane == b->select_plane) &&
+            (a->units_mode == b->units_mode) && (a->path_control == b->path_control) &&
+            (a->path_tolerance == b->path_tolerance) && (a->distance_mode == b->distance_mode) &&
+            (a->arc_distance_mode == b->arc_distance_mode) && (a->coord_system == b->coord_system) &&
+            (a->motion_profile == b->motion_profile) && (a->tool == b->tool) &&
+            (a->tool_select == b->tool_select) && (a->spindle_direction == b->spindle_direction));
+}
+
+bool mp_attach_gm(mpBuf_t *bf, const GCodeState_t *_gm)
+{
+    mpPlannerQueue_t *q = &(mp->q);
+    mpGmRecord_t *record = q->gm_last;
+
+    copy_vector(bf->target, _gm->target);
+    bf->linenum = _gm->linenum;
+    bf->feed_rate = _gm->feed_rate;
+    bf->spindle_speed = _gm->spindle_speed;
+    bf->P_word = _gm->P_word;
+    bf->motion_mode = _gm->motion_mode;
+    bf->absolute_override = _gm->absolute_override;
+    copy_vector(bf->display_offset, _gm->display_offset);
+
+    if ((record == nullptr) || !_gm_same_modal_state(&record->gm, _gm)) {
+        record = nullptr;
+        for (uint16_t i = 0; i < q->gm_size; i++) {
+            mpGmRecord_t *candidate = &q->gm[q->gm_next];
+            q->gm_next = ((q->gm_next + 1 < q->gm_size) ? (q->gm_next + 1) : 0);
+            if (candidate->refs.load(std::memory_order_acquire) == 0) {   // only the producer takes records
+                record = candidate;
+                break;
+            }
+        }
+        if (record == nullptr) {
+            rpt_exception(STAT_FAILED_TO_GET_PLANNER_BUFFER, "mp_attach_gm()");
+            return (false);
+        }
+        record->gm = *_gm;                      // the per-move fields come along but are never read
+        q->gm_last = record;
+    }
+    if (record->refs.fetch_add(1, std::memory_order_acq_rel) == 0) {
+        q->gm_free.fetch_sub(1, std::memory_order_relaxed);
+    }
+    bf->gm = &record->gm;
+    return (true);
+}
+
+void mp_get_block_gm(const mpBuf_t *bf, GCodeState_t *gm)
+{
+    *gm = *bf->gm;
+    copy_vector(gm->target, bf->target);
+    gm->linenum = bf->linenum;
+    gm->feed_rate = bf->feed_rate;
+    gm->spindle_speed = bf->spindle_speed;
+    gm->P_word = bf->P_word;
+    gm->motion_mode = bf->motion_mode;
+    gm->absolute_override = bf->absolute_override;
+    copy_vector(gm->display_offset, bf->display_offset);
 }
 
 /* UNUSED FUNCTIONS - left in for completeness and for reference
 void mp_copy_buffer(mpBuf_t *bf, const mpBuf_t *bp)
 {
     // copy contents of bp to bf while preserving pointers in bp
-    memcpy((void *)(&bf->bf_func), (&bp->bf_func), sizeof(mpBuf_t) - (sizeof(void *) * 2));
+    memcpy((void *)(&bf->bf_func), (&bp->bf_func), sizeof(mpBuf_t) - offsetof(mpBuf_t, bf_func));
+    if (bp->arc != nullptr) {       // re-point a native arc at bf's own arc storage
+        memcpy(bf->arc_data, bp->arc, sizeof(mpArc_t));
+        bf->arc = bf->arc_data;
+    }
 }
 */
 
@@ -1001,7 +1198,7 @@ static void _planner_report(const char *msg)
     #ifdef __PLANNER_REPORT_ENABLED
     rpt_exception(STAT_PLANNER_ASSERTION_FAILURE, msg);
 
-    for (uint8_t i=0; i<PLANNER_QUEUE_SIZE; i++) {
+    for (uint16_t i=0; i<PLANNER_QUEUE_SIZE; i++) {
         printf("{\"er\":{\"stat\":%d, \"type\":%d, \"lock\":%d, \"plannable\":%d",
             mb.bf[i].buffer_state,
             mb.bf[i].block_type,
@@ -1107,6 +1304,149 @@ static void _audit_buffers()
  * Functions to get and set variables from the cfgArray table
  ***********************************************************************************/
 
+#ifdef __PLANNER_PROFILING
+/*
+ * mp_profile_init()       - enable the DWT cycle counter and clear the profiling counters
+ * mp_profile_plan_block() - accumulate the cycles used by one _plan_block() call
+ * mp_profile_backplan()   - accumulate the blocks visited by one back-planning pass
+ *
+ *  These are called from the planner, which can run from the main loop or from the
+ *  forward planning interrupt, so keep them short.
+ */
+
+void mp_profile_init()
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     // enable the trace unit (DWT)
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;                // start the free-running cycle counter
+
+    memset(&mpf, 0, sizeof(mpPlannerProfile_t));
+    mpf.start_tick = SysTickTimer.getValue();
+}
+
+void mp_profile_plan_block(const uint32_t cycles)
+{
+    mpf.plan_block_calls++;
+    mpf.plan_block_cycles += cycles;
+    if (cycles > mpf.plan_block_max) {
+        mpf.plan_block_max = cycles;
+    }
+}
+
+void mp_profile_backplan(const uint16_t visits)
+{
+    mpf.backplan_passes++;
+    mpf.backplan_visits += visits;
+    if (visits > mpf.backplan_visits_max) {
+        mpf.backplan_visits_max = visits;
+    }
+}
+
+/*
+ * mp_get_pfb() - get blocks per second since the counters were cleared
+ * mp_get_pfs() - get segments per second since the counters were cleared
+ * mp_get_pfm() - get worst-case _plan_block() time in microseconds
+ * mp_get_pfa() - get mean _plan_block() time in microseconds
+ * mp_get_pfl() - get mean block setup time in mp_aline() and mp_arc() in microseconds
+ * mp_get_pfv() - get mean blocks visited per back-planning pass
+ * mp_get_pfw() - get most blocks visited by a single back-planning pass
+ * mp_get_pfe() - get mean exec interrupt load in percent of the CPU
+ * mp_set_pfc() - clear the profiling counters
+ */
+
+static float _profile_elapsed_seconds()
+{
+    uint32_t elapsed_ms = SysTickTimer.getValue() - mpf.start_tick;
+    return ((elapsed_ms == 0) ? 0.001 : (float)elapsed_ms / 1000);
+}
+
+static float _profile_cycles_to_usec(const float cycles)
+{
+    return (cycles / ((float)SystemCoreClock / 1000000));
+}
+
+stat_t mp_get_pfb(nvObj_t *nv)
+{
+    nv->value_flt = mpf.blocks / _profile_elapsed_seconds();
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t mp_get_pfs(nvObj_t *nv)
+{
+    nv->value_flt = mpf.segments / _profile_elapsed_seconds();
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t mp_get_pfm(nvObj_t *nv)
+{
+    nv->value_flt = _profile_cycles_to_usec(mpf.plan_block_max);
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t mp_get_pfa(nvObj_t *nv)
+{
+    if (mpf.plan_block_calls == 0) {
+        nv->value_flt = 0;
+    } else {
+        nv->value_flt = _profile_cycles_to_usec((float)mpf.plan_block_cycles / mpf.plan_block_calls);
+    }
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t mp_get_pfl(nvObj_t *nv)
+{
+    if (mpf.aline_calls == 0) {
+        nv->value_flt = 0;
+    } else {
+        nv->value_flt = _profile_cycles_to_usec((float)mpf.aline_cycles / mpf.aline_calls);
+    }
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t mp_get_pfv(nvObj_t *nv)
+{
+    if (mpf.backplan_passes == 0) {
+        nv->value_flt = 0;
+    } else {
+        nv->value_flt = (float)mpf.backplan_visits / mpf.backplan_passes;
+    }
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t mp_get_pfw(nvObj_t *nv)
+{
+    nv->value_int = mpf.backplan_visits_max;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t mp_get_pfe(nvObj_t *nv)
+{
+    nv->value_flt = (float)mpf.exec_cycles * 100 / (_profile_elapsed_seconds() * SystemCoreClock);
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t mp_set_pfc(nvObj_t *nv)
+{
+    mp_profile_init();
+    nv->valuetype = TYPE_NULL;
+    return (STAT_OK);
+}
+#endif // __PLANNER_PROFILING
+
 /***********************************************************************************
  * TEXT MODE SUPPORT
  * Functions to print variables from the cfgArray table
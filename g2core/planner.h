@@ -82,8 +82,9 @@
  *  - mp_json_command()  - queue a JSON command for run-time interpretation and execution (M100)
  *  - mp_json_wait()     - queue a JSON wait for run-time interpretation and execution (M101)
  *  -
- * In addition, cm_arc_feed() valaidates and sets up a arc paramewters and calls mp_aline()
- * repeatedly to spool out the arc segments into the planner queue.
+ * In addition, cm_arc_feed() valaidates and sets up a arc paramewters and either calls mp_arc()
+ * to queue the arc as one block, or calls mp_aline() repeatedly to spool out the arc segments
+ * into the planner queue.
  *
  * All the above queueing commands other than mp_aline() are relatively trivial; they just
  * post callbacks into the next available planner buffer. Command functions are in 2 parts:
@@ -149,8 +150,11 @@
 #ifndef PLANNER_H_ONCE
 #define PLANNER_H_ONCE
 
+#include <atomic>
+
 #include "canonical_machine.h"    // used for GCodeState_t
 #include "hardware.h"             // for MIN_SEGMENT_MS
+#include "util.h"                 // for AXIS_VECTOR_ALIGNED
 
 using Motate::Timeout;
 
@@ -230,15 +234,30 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 #ifdef PLANNER_BUFFER_POOL_SIZE
 #error Please change PLANNER_BUFFER_POOL_SIZE define to PLANNER_QUEUE_SIZE (found elsewhere, unfortunately)
 #endif
+#ifndef PLANNER_GM_SHARING
+#define PLANNER_GM_SHARING          ((uint16_t)4)       // planner buffers per gm record in the primary queue (see mp_attach_gm())
+#endif
 #ifndef PLANNER_QUEUE_SIZE
-#define PLANNER_QUEUE_SIZE          ((uint8_t)48)       // Suggest 12 min. Limit is 255
+#ifdef PLANNER_QUEUE_MEMORY                             // boards may give a RAM budget in bytes instead of a count
+#define PLANNER_QUEUE_SIZE          ((uint16_t)(PLANNER_QUEUE_MEMORY / (sizeof(mpBuf_t) + sizeof(mpArc_t) + sizeof(mpGmRecord_t) / PLANNER_GM_SHARING)))
+#else
+#define PLANNER_QUEUE_SIZE          ((uint16_t)48)      // Suggest 12 min. Limit is 65535
+#endif
+#endif
+#ifndef PLANNER_GM_POOL_SIZE
+#define PLANNER_GM_POOL_SIZE        ((uint16_t)(PLANNER_QUEUE_SIZE / PLANNER_GM_SHARING))
 #endif
 #ifndef SECONDARY_QUEUE_SIZE
-#define SECONDARY_QUEUE_SIZE        ((uint8_t)12)       // Secondary planner queue for feedhold operations
+#define SECONDARY_QUEUE_SIZE        ((uint16_t)12)      // Secondary planner queue for feedhold operations
 #endif
-#define PLANNER_BUFFER_HEADROOM     ((uint8_t)4)        // Buffers to reserve in planner before processing new input line
+#define SECONDARY_GM_POOL_SIZE      SECONDARY_QUEUE_SIZE  // the feedhold queue is short - one gm record per buffer
+#define PLANNER_BUFFER_HEADROOM     ((uint8_t)4)        // Buffers (and gm records) to reserve in planner before processing new input line
+#define RUNTIME_RESERVED_BUFFERS    ((uint8_t)3)        // Buffers from the run buffer on that the interrupts may change
+#define HORIZON_AVERAGE_WEIGHT      ((float)0.125)      // weight of each new block in the running average block length
 #define JERK_MULTIPLIER             ((float)1000000)    // DO NOT CHANGE - must always be 1 million
 
+#define MERGE_MAX_VERTICES          ((uint8_t)16)       // most G1 endpoints merged into one line (see _plan_merge())
+
 #define JUNCTION_INTEGRATION_MIN    (0.05)              // JT minimum allowable setting
 #define JUNCTION_INTEGRATION_MAX    (5.00)              // JT maximum allowable setting
 
@@ -246,6 +265,8 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 #define MIN_SEGMENT_MS              ((float)0.75)       // minimum segment milliseconds
 #endif
 #define NOM_SEGMENT_MS              ((float)MIN_SEGMENT_MS*2.0)        // nominal segment ms (at LEAST MIN_SEGMENT_MS * 2)
+#define MAX_SEGMENT_MS              ((float)5.0)        // longest segment ms - also bounds feedhold latency in bodies
+#define SEGMENT_VELOCITY_ERROR      ((float)1.0)        // mm/min a segment's linear velocity ramp may depart from the S-curve
 #define MIN_BLOCK_MS                ((float)MIN_SEGMENT_MS*2.0)        // minimum block (whole move) milliseconds
 #define BLOCK_TIMEOUT_MS            ((float)30.0)       // MS before deciding there are no new blocks arriving
 #define PHAT_CITY_MS                ((float)100.0)      // if you have at least this much time in the planner
@@ -253,14 +274,18 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 #define NOM_SEGMENT_TIME            ((float)(NOM_SEGMENT_MS / 60000))       // DO NOT CHANGE - time in minutes
 #define NOM_SEGMENT_USEC            ((float)(NOM_SEGMENT_MS * 1000))        // DO NOT CHANGE - time in microseconds
 #define MIN_SEGMENT_TIME            ((float)(MIN_SEGMENT_MS / 60000))       // DO NOT CHANGE - time in minutes
+#define MAX_SEGMENT_TIME            ((float)(MAX_SEGMENT_MS / 60000))       // DO NOT CHANGE - time in minutes
 #define MIN_BLOCK_TIME              ((float)(MIN_BLOCK_MS / 60000))         // DO NOT CHANGE - time in minutes
 #define PHAT_CITY_TIME              ((float)(PHAT_CITY_MS / 60000))         // DO NOT CHANGE - time in minutes
 
+#define POSITION_FIXED_ONE          ((float)4294967296.0)   // one mm as a runtime fixed point position (32.32)
+
 #define FEED_OVERRIDE_ENABLE        false               // initial value
 #define FEED_OVERRIDE_MIN           (0.05)              // 5% minimum
 #define FEED_OVERRIDE_MAX           (2.00)              // 200% maximum
 #define FEED_OVERRIDE_FACTOR        (1.00)              // initial value
-#define FEED_OVERRIDE_RAMP_TIME     (1.00)              ////##fro ////## just mad this up??; will probably need for traverse too
+#define FEED_OVERRIDE_RAMP_TIME     (0.25)              // seconds for the runtime override to change by 1.00 at full rate
+#define FEED_OVERRIDE_JERK_TIME     (0.05)              // seconds for the runtime override to reach full rate (S-curve)
 
 #define TRAVERSE_OVERRIDE_ENABLE    false               // initial value
 #define TRAVERSE_OVERRIDE_MIN       (0.05)              // 5% minimum
@@ -287,8 +312,7 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 #ifdef __PLANNER_DIAGNOSTICS
 #define ASCII_ART(s) xio_writeline(s)
 
-#define UPDATE_BF_DIAGNOSTICS(bf)   { bf->linenum = bf->gm.linenum; \
-                                      bf->block_time_ms = bf->block_time*60000; \
+#define UPDATE_BF_DIAGNOSTICS(bf)   { bf->block_time_ms = bf->block_time*60000; \
                                       bf->plannable_time_ms = bf->plannable_time*60000; }
 
 #define UPDATE_MP_DIAGNOSTICS       { mp->plannable_time_ms = mp->plannable_time*60000; }
@@ -307,6 +331,57 @@ typedef enum {                      // code blocks for planning and trapezoid ge
 #define INC_MEET_ITERATIONS
 #endif
 
+/* Planner Profiling
+ *
+ *  Cheap throughput counters for the planner stack, readable as the {_pf:n} group.
+ *  Blocks and segments are counted as they pass through the queue and the exec runtime,
+ *  and _plan_block() is timed with the Cortex-M DWT cycle counter. Stream a job, then
+ *  read _pfb (blocks/sec), _pfs (segments/sec), _pfm (worst-case _plan_block() in uSec)
+ *  and _pfa (mean _plan_block() in uSec). Set _pfc to clear the counters between runs.
+ *  _pfv and _pfw are the mean and worst-case number of blocks visited per back-planning pass.
+ *  _pfe is the mean load of the exec interrupt in percent of the CPU, and _pft is the worst
+ *  velocity error of a segment's linear ramp against the S-curve (see _exec_segments()).
+ *  _pf0 through _pf4 are a histogram of Newton refinements used by _get_meet_velocity() -
+ *  bin 0 counts the cases solved without refining, bin 4 counts 4 or more. _pfr counts the
+ *  blocks whose ramps were taken from a stored plan instead (see mp_calculate_ramps()).
+ */
+
+//#define __PLANNER_PROFILING   // uncomment for planner profiling (_pf diagnostics) - adds ISR and main loop overhead
+
+#ifdef __PLANNER_PROFILING
+#define MEET_HISTOGRAM_BINS 5       // 0, 1, 2, 3, and 4 or more refinements
+#define PROFILE_CYCLES              (DWT->CYCCNT)
+#define PROFILE_INC_BLOCKS          { mpf.blocks++; }
+#define PROFILE_INC_SEGMENTS        { mpf.segments++; }
+#define PROFILE_PLAN_BLOCK_START    uint32_t _pf_start = PROFILE_CYCLES;
+#define PROFILE_PLAN_BLOCK_END      { mp_profile_plan_block(PROFILE_CYCLES - _pf_start); }
+#define PROFILE_ALINE_START         uint32_t _pf_aline_start = PROFILE_CYCLES;
+#define PROFILE_ALINE_END           { mpf.aline_calls++; mpf.aline_cycles += PROFILE_CYCLES - _pf_aline_start; }
+#define PROFILE_BACKPLAN_START      uint16_t _pf_visits = 0;
+#define PROFILE_INC_BACKPLAN        { _pf_visits++; }
+#define PROFILE_BACKPLAN_END        { mp_profile_backplan(_pf_visits); }
+#define PROFILE_MEET_ITERATIONS(i)  { mpf.meet_iterations[((i) < MEET_HISTOGRAM_BINS) ? (i) : MEET_HISTOGRAM_BINS-1]++; }
+#define PROFILE_INC_STORED_FITS     { mpf.stored_fits++; }
+#define PROFILE_EXEC_START          uint32_t _pf_exec_start = PROFILE_CYCLES;
+#define PROFILE_EXEC_END            { mpf.exec_cycles += PROFILE_CYCLES - _pf_exec_start; }
+#define PROFILE_SEGMENT_ERROR(e)    { if ((e) > mpf.velocity_error_max) { mpf.velocity_error_max = (e); } }
+#else
+#define PROFILE_INC_BLOCKS
+#define PROFILE_INC_SEGMENTS
+#define PROFILE_PLAN_BLOCK_START
+#define PROFILE_PLAN_BLOCK_END
+#define PROFILE_ALINE_START
+#define PROFILE_ALINE_END
+#define PROFILE_BACKPLAN_START
+#define PROFILE_INC_BACKPLAN
+#define PROFILE_BACKPLAN_END
+#define PROFILE_MEET_ITERATIONS(i)
+#define PROFILE_INC_STORED_FITS
+#define PROFILE_EXEC_START
+#define PROFILE_EXEC_END
+#define PROFILE_SEGMENT_ERROR(e)
+#endif
+
 /*
  *  Planner structures
  *
@@ -314,22 +389,66 @@ typedef enum {                      // code blocks for planning and trapezoid ge
  *  Please refer to header comments in for important details on buffers and blocks
  *    - plan_zoid.cpp / mp_calculate_ramps()
  *    - plan_exec.cpp / mp_exec_aline()
+ *
+ *  Each buffer is split into a hot planning record (mpBuf_t) and a cold Gcode model
+ *  state (GCodeState_t). Back-planning and forward planning walk the hot records only;
+ *  the gm is read when a block is queued, when its velocity limits are computed, and
+ *  when the runtime loads it. The fields that can change from line to line - target, line
+ *  number, F, S, the motion mode (G0/G1 alternate), P (G4 dwells), G53 and the display
+ *  offset - are kept in the hot record. The rest is modal state, which nearly always
+ *  stays the same from block to block, so it is kept in gm records shared by
+ *  the blocks that have the same state (see mp_attach_gm()). The gm pool is smaller than
+ *  the queue by PLANNER_GM_SHARING, so the queue is sized by the hot record and a RAM
+ *  budget (PLANNER_QUEUE_MEMORY) buys that many more blocks of look-ahead.
+ *
+ *  Native arcs (see mp_arc()) are ALINE blocks that also carry their arc geometry
+ *  in a third pool (mpArc_t). The planner plans them like any other line, using the
+ *  arc length, and the runtime interpolates them along the arc one segment at a time.
  */
 
+typedef int64_t mpFixed_t;              // 32.32 fixed point runtime position in mm (see _exec_aline_segment())
+
+typedef struct mpArc {                  // native arc geometry - cold, one per buffer
+    float center_0;                     // center of circle at plane axis 0 (e.g. X for G17)
+    float center_1;                     // center of circle at plane axis 1 (e.g. Y for G17)
+    float radius;                       // radius in mm
+    float theta;                        // starting angle of arc (see _compute_arc() in plan_arc.cpp)
+    float angular_travel;               // travel along the arc in radians, signed
+    float length;                       // arc or helix length in mm
+    float exit_unit_0;                  // unit tangent at the end of the arc, plane axis 0
+    float exit_unit_1;                  // unit tangent at the end of the arc, plane axis 1
+    uint8_t plane_axis_0;               // arc plane axis 0 - e.g. X for G17
+    uint8_t plane_axis_1;               // arc plane axis 1 - e.g. Y for G17
+} mpArc_t;
+
+typedef struct mpStoredPlan {           // a line's plan from a compiled SD job (see sd_job.h)
+    float entry_velocity;               // velocities of the whole-file plan at 100% override
+    float exit_velocity;                //   - upper bounds for the live planner
+    float cruise_velocity;
+    float head_length;                  // ramps fitted to those velocities (see mp_fit_ramps())
+    float tail_length;
+} mpStoredPlan_t;
+
+typedef struct mpGmRecord {             // gm record shared by queued blocks with the same modal state
+    GCodeState_t gm;                    // modal state. The per-move fields kept in mpBuf_t are unused
+    std::atomic<uint16_t> refs;         // queued buffers using this record, 0 if free
+} mpGmRecord_t;
+
 //**** Planner Queue Structures ****
 
 struct mpBuf_t { // mpBuf_t
 
-    // *** CAUTION *** These two pointers are not reset by _clear_buffer()
+    // *** CAUTION *** These pointers are not reset by _clear_buffer()
     struct mpBuf_t *pv;                // static pointer to previous buffer
     struct mpBuf_t *nx;                // static pointer to next buffer
-    uint8_t buffer_number;              // DIAGNOSTIC for easier debugging
+    mpArc_t *arc_data;                  // static pointer to this buffer's arc geometry in the arc pool
+    GCodeState_t *gm;                   // shared modal state in the gm pool - set by mp_attach_gm(), released by _clear_buffer()
+    uint16_t buffer_number;             // DIAGNOSTIC for easier debugging
 
     stat_t (*bf_func)(struct mpBuf_t *bf); // callback to buffer exec function
     cm_exec_t cm_func;                  // callback to canonical machine execution function
 
 #ifdef __PLANNER_DIAGNOSTICS
-    uint32_t linenum;                   // mirror of bf->gm.linenum
     int iterations;
     float block_time_ms;
     float plannable_time_ms;            // time in planner
@@ -341,15 +460,31 @@ struct mpBuf_t { // mpBuf_t
     blockType block_type;               // used to dispatch to run routine
     blockState block_state;             // move state machine sequence
     blockHint hint;                     // hint the block for zoid and other planning operations. Must be accurate or NO_HINT
+    mpArc_t *arc;                       // arc geometry if this ALINE is a native arc, otherwise nullptr
+    bool has_plan;                      // set true if plan holds the stored plan for this line
+    mpStoredPlan_t plan;                // stored plan from a compiled SD job (see mp_set_stored_plan())
+
+    // per-move Gcode state - the rest is in the shared gm record
+    float target[AXES] AXIS_VECTOR_ALIGNED; // XYZABC target where the move should go
+    int32_t linenum;                    // Gcode block line number - the first line if lines were merged
+    int32_t last_linenum;               // line number of the newest line merged into this one (see _plan_merge())
+    float last_line_length;             // length of the newest merged line, or 0 if nothing was merged
+    float feed_rate;                    // F - normalized to millimeters/minute or in inverse time mode
+    float spindle_speed;                // S - spindle "speed" in arbitrary units, often RPM
+    float P_word;                       // P - dwell time and other parameters
+    cmMotionMode motion_mode;           // G0, G1, G2, G3...
+    cmAbsoluteOverride absolute_override; // G53 - this block only
+    float display_offset[AXES];         // work offsets, for reporting only
 
     // block parameters
-    float unit[AXES];               // unit vector for axis scaling & planning
+    float unit[AXES] AXIS_VECTOR_ALIGNED;   // unit vector for axis scaling & planning
     bool axis_flags[AXES];          // set true for axes participating in the move & for command parameters
 
-    float junction_unit[AXES];      // unit vector delta at the junction for cornering. Needed for groups of small moves.
+    float junction_unit[AXES] AXIS_VECTOR_ALIGNED;  // unit vector delta at the junction for cornering. Needed for groups of small moves.
     float junction_length_since;    // length total of the moves since the junction_unit was captured. See _calculate_junction_vmax() comments.
 
     bool plannable;                 // set true when this block can be used for planning
+    bool hold_jerk;                 // set true when a feedhold switched a PROFILE_FAST_STOP block to high jerk
 
     float length;                   // total length of line or helix in mm
     float block_time;               // computed move time for entire block (move)
@@ -377,15 +512,24 @@ struct mpBuf_t { // mpBuf_t
     float sqrt_j;                       // sqrt(jM) used for planning (computed and cached)
     float q_recip_2_sqrt_j;             // (q/(2 sqrt(jM))) where q = (sqrt(10)/(3^(1/4))), used in length computations (computed and cached)
 
-    GCodeState_t gm;                    // Gcode model state - passed from model, used by planner and runtime
-
     // clears the above structure
     void reset() {
         bf_func = nullptr;
         cm_func = nullptr;
 
-#ifdef __PLANNER_DIAGNOSTICS
         linenum = 0;
+        last_linenum = 0;
+        last_line_length = 0.0;
+        feed_rate = 0.0;
+        spindle_speed = 0.0;
+        P_word = 0.0;
+        motion_mode = MOTION_MODE_STRAIGHT_TRAVERSE;
+        absolute_override = ABSOLUTE_OVERRIDE_OFF;
+        for (uint8_t axis = 0; axis < AXES; axis++) {
+            display_offset[axis] = 0.0;
+        }
+
+#ifdef __PLANNER_DIAGNOSTICS
         iterations = 0;
         block_time_ms = 0;
         plannable_time_ms = 0;
@@ -396,14 +540,18 @@ struct mpBuf_t { // mpBuf_t
         block_type = BLOCK_TYPE_NULL;
         block_state = BLOCK_INACTIVE;
         hint = NO_HINT;
+        arc = nullptr;
+        has_plan = false;
 
         for (uint8_t i = 0; i< AXES; i++) {
+            target[i] = 0;
             unit[i] = 0;
             junction_unit[i] = 0;
             junction_length_since = 0;
             axis_flags[i] = 0;
         }
         plannable = false;
+        hold_jerk = false;
         length = 0.0;
         block_time = 0.0;
         override_factor = 0.0;
@@ -419,17 +567,40 @@ struct mpBuf_t { // mpBuf_t
         recip_jerk = 0.0;
         sqrt_j = 0.0;
         q_recip_2_sqrt_j = 0.0;
-        gm.reset();
     }
 };
 
+/*
+ * The queue is a single-producer/single-consumer ring. The producer is the main loop
+ * (mp_get_write_buffer(), mp_commit_write_buffer()), the consumer is the runtime in
+ * the exec and forward planning interrupts (mp_get_run_buffer(), mp_free_run_buffer()).
+ *
+ * Each side owns its own pointer and its own running count, and is the only writer of
+ * them. A count is stored with release semantics after the buffers it covers have been
+ * written, and loaded with acquire semantics by the other side before it reads them.
+ * The number of buffers in use is (committed - freed) plus any claimed write buffer,
+ * so no count is ever read-modify-written from both sides.
+ *
+ * Committed buffers between r and w are shared with the main loop planners. The run
+ * buffer and the RUNTIME_RESERVED_BUFFERS-1 buffers after it may be changed by the
+ * interrupts at any time, so the main loop may only edit committed buffers beyond them.
+ */
+
 typedef struct mpPlannerQueue {         // control structure for queue
     magic_t magic_start;                // magic number to test memory integrity
-    mpBuf_t *r;                         // run buffer pointer
-    mpBuf_t *w;                         // write buffer pointer
-    uint8_t queue_size;                 // total number of buffers, one-based (e.g. 48 not 47)
-    uint8_t buffers_available;          // running count of available buffers in queue
+    mpBuf_t *r;                         // run buffer pointer - written by the consumer only
+    mpBuf_t *w;                         // write buffer pointer - written by the producer only
+    uint16_t queue_size;                // total number of buffers, one-based (e.g. 48 not 47)
+    std::atomic<uint16_t> committed;    // running count of committed buffers - producer stores
+    std::atomic<uint16_t> freed;        // running count of freed buffers - consumer stores
+    uint16_t claimed;                   // 1 if the producer holds an uncommitted write buffer
     mpBuf_t *bf;                        // pointer to buffer pool (storage array)
+    mpArc_t *arc;                       // pointer to arc pool (storage array, one per buffer)
+    mpGmRecord_t *gm;                   // pointer to gm pool (storage array, shared by buffers)
+    mpGmRecord_t *gm_last;              // last gm record written - the first candidate for sharing
+    uint16_t gm_size;                   // total number of gm records
+    uint16_t gm_next;                   // where the producer starts looking for a free gm record
+    std::atomic<uint16_t> gm_free;      // number of free gm records - producer takes, consumer returns
     magic_t magic_end;
 } mpPlannerQueue_t;
 
@@ -460,11 +631,18 @@ typedef struct mpPlannerRuntime {       // persistent runtime variables
     bool out_of_band_dwell_flag;        // set true to conditionally execute out-of-band dwell
     float out_of_band_dwell_seconds;    // time for out-of-band dwell
 
-    float unit[AXES];                   // unit vector for axis scaling & planning
+    float unit[AXES] AXIS_VECTOR_ALIGNED;       // unit vector for axis scaling & planning
     bool axis_flags[AXES];              // set true for axes participating in the move
-    float target[AXES];                 // final target for bf (used to correct rounding errors)
-    float position[AXES];               // current move position
-    float waypoint[SECTIONS][AXES];     // head/body/tail endpoints for correction
+    float target[AXES] AXIS_VECTOR_ALIGNED;     // final target for bf (used to correct rounding errors)
+    float position[AXES] AXIS_VECTOR_ALIGNED;   // current move position - float copy of position_fixed
+    mpFixed_t position_fixed[AXES];     // master position for the running block
+    mpFixed_t waypoint[SECTIONS][AXES]; // head/body/tail endpoints for correction
+
+    bool arc_active;                    // true if the running block is a native arc
+    mpArc_t arc;                        // geometry of the running arc (copied from the bf)
+    float arc_start[AXES];              // position at the start of the running arc
+    float arc_distance;                 // distance travelled along the running arc
+    float arc_waypoint[SECTIONS];       // arc distance at head/body/tail endpoints
 
     float target_steps[MOTORS];         // current MR target (absolute target as steps)
     float position_steps[MOTORS];       // current MR position (target from previous segment)
@@ -487,6 +665,12 @@ typedef struct mpPlannerRuntime {       // persistent runtime variables
     float target_velocity;              // computed end velocity for aline segment
     float segment_time;                 // actual time increment per aline segment
 
+    float override_planned;             // override factor the running block was planned with
+    float override_scale;               // runtime override applied on top of the plan (see _exec_override())
+    float override_rate;                // rate of change of override_scale, per second
+    float override_rate_max;            // maximum rate of change of override_scale, per second
+    float override_headroom;            // most override_scale may rise in the running block's body
+
     float forward_diff_1;               // forward difference level 1
     float forward_diff_2;               // forward difference level 2
     float forward_diff_3;               // forward difference level 3
@@ -505,6 +689,7 @@ typedef struct mpPlannerRuntime {       // persistent runtime variables
         entry_velocity = 0;             // needed to ensure next block in forward planning starts from 0 velocity
         r->exit_velocity = 0;           // ditto
         segment_velocity = 0;
+        override_rate = 0;
     }
 
 } mpPlannerRuntime_t;
@@ -519,25 +704,23 @@ typedef struct mpPlanner {              // common variables for a planner contex
     float plannable_time_ms;
 
     // planner position
-    float position[AXES];               // final move position for planning purposes
+    float position[AXES] AXIS_VECTOR_ALIGNED;   // final move position for planning purposes
 
     // timing variables
     float run_time_remaining;           // time left in runtime (including running block)
     float plannable_time;               // time in planner that can actually be planned
 
+    // look-ahead horizon - see mp_planner_time_accounting()
+    float horizon_length;               // path length queued ahead of the running block (mm)
+    float horizon_time;                 // estimated time queued ahead of the running block (minutes)
+    float horizon_block_length;         // running average of queued block lengths (mm)
+
     // planner state variables
     plannerState planner_state;         // current state of planner
     bool request_planning;              // set true to request backplanning
     bool backplanning;                  // true if planner is in a back-planning pass
-    bool mfo_active;                    // true if mfo override is in effect
-    bool ramp_active;                   // true when a ramp is occurring
     bool entry_changed;                 // mark if exit_velocity changed to invalidate next block's hint
 
-    // feed overrides and ramp variables (these extend the variables in cm->gmx)
-    float mfo_factor;                   // runtime override factor
-    float ramp_target;
-    float ramp_dvdt;
-
     // objects
     Timeout block_timeout;              // Timeout object for block planning
 
@@ -554,11 +737,12 @@ typedef struct mpPlanner {              // common variables for a planner contex
     void reset() {
         run_time_remaining = 0;
         plannable_time = 0;
+        horizon_length = 0;
+        horizon_time = 0;
+        horizon_block_length = 0;
         planner_state = PLANNER_IDLE;
         request_planning = false;
         backplanning = false;
-        mfo_active = false;
-        ramp_active = false;
         entry_changed = false;
         block_timeout.clear();
     }
@@ -576,6 +760,32 @@ extern mpPlannerRuntime_t mr2 HOT_DATA;          // secondary planner runtime co
 
 extern mpBuf_t mp1_queue[PLANNER_QUEUE_SIZE] HOT_DATA;   // storage allocation for primary planner queue buffers
 extern mpBuf_t mp2_queue[SECONDARY_QUEUE_SIZE]; // storage allocation for secondary planner queue buffers
+extern mpGmRecord_t mp1_gm_pool[PLANNER_GM_POOL_SIZE];  // gm storage shared by primary planner queue buffers
+extern mpGmRecord_t mp2_gm_pool[SECONDARY_GM_POOL_SIZE]; // gm storage shared by secondary planner queue buffers
+extern mpArc_t mp1_arc_pool[PLANNER_QUEUE_SIZE];        // arc storage for primary planner queue buffers
+extern mpArc_t mp2_arc_pool[SECONDARY_QUEUE_SIZE];      // arc storage for secondary planner queue buffers
+
+#ifdef __PLANNER_PROFILING
+typedef struct mpPlannerProfile {       // planner throughput counters
+    uint32_t start_tick;                // SysTick (ms) when the counters were last cleared
+    uint32_t blocks;                    // motion blocks committed to the planner queues
+    uint32_t segments;                  // segments prepped by the exec runtime
+    uint32_t plan_block_calls;          // number of _plan_block() calls
+    uint64_t plan_block_cycles;         // total CPU cycles spent in _plan_block()
+    uint32_t plan_block_max;            // worst-case CPU cycles in a single _plan_block()
+    uint32_t aline_calls;               // number of blocks set up by mp_aline() and mp_arc()
+    uint64_t aline_cycles;              // total CPU cycles spent setting them up (vectors, jerk, vmaxes)
+    uint32_t backplan_passes;           // number of back-planning passes
+    uint32_t backplan_visits;           // total blocks visited by back-planning passes
+    uint16_t backplan_visits_max;       // most blocks visited by a single back-planning pass
+    uint32_t meet_iterations[MEET_HISTOGRAM_BINS];  // histogram of _get_meet_velocity() refinements
+    uint32_t stored_fits;               // blocks whose ramps came from a stored plan
+    uint64_t exec_cycles;               // total CPU cycles spent in mp_exec_move() from the exec interrupt
+    float velocity_error_max;           // worst segment velocity error against the S-curve, mm/min
+} mpPlannerProfile_t;
+
+extern mpPlannerProfile_t mpf;                   // planner profiling counters
+#endif
 
 /*
  * Global Scope Functions
@@ -583,7 +793,7 @@ extern mpBuf_t mp2_queue[SECONDARY_QUEUE_SIZE]; // storage allocation for second
 
 //**** planner.cpp functions
 
-void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, uint8_t queue_size);
+void planner_init(mpPlanner_t *_mp, mpPlannerRuntime_t *_mr, mpBuf_t *queue, mpArc_t *arc_pool, uint16_t queue_size, mpGmRecord_t *gm_pool, uint16_t gm_pool_size);
 void planner_reset(mpPlanner_t *_mp);
 stat_t planner_assert(const mpPlanner_t *_mp);
 
@@ -607,7 +817,8 @@ void mp_end_dwell(void);
 void mp_request_out_of_band_dwell(float seconds);
 
 //**** planner functions and helpers
-uint8_t mp_get_planner_buffers(const mpPlanner_t *_mp);
+uint16_t mp_get_planner_buffers(const mpPlanner_t *_mp);
+uint16_t mp_get_queued_buffers(const mpPlanner_t *_mp);
 bool mp_planner_is_full(const mpPlanner_t *_mp);
 bool mp_has_runnable_buffer(const mpPlanner_t *_mp);
 bool mp_is_phat_city_time(void);
@@ -615,7 +826,8 @@ bool mp_is_phat_city_time(void);
 stat_t mp_planner_callback();
 void mp_replan_queue(mpBuf_t *bf, bool back_too=false);
 ////##fro
-void mp_start_feed_override(const float ramp_time, const float override);
+float mp_get_override_factor(const cmMotionMode motion_mode);
+void mp_start_feed_override(const float ramp_time);
 void mp_end_feed_override(const float ramp_time);
 // void mp_start_traverse_override(const float ramp_time, const float override);
 // void mp_end_traverse_override(const float ramp_time);
@@ -637,6 +849,8 @@ mpBuf_t * mp_get_write_buffer(void)  HOT_FUNC;
 void mp_commit_write_buffer(const blockType block_type)  HOT_FUNC;
 mpBuf_t * mp_get_run_buffer(void)  HOT_FUNC;
 bool mp_free_run_buffer(void)  HOT_FUNC;
+bool mp_attach_gm(mpBuf_t *bf, const GCodeState_t *_gm);
+void mp_get_block_gm(const mpBuf_t *bf, GCodeState_t *gm);
 
 //**** plan_line.c functions
 void mp_zero_segment_velocity(void);                    // getters and setters...
@@ -648,13 +862,22 @@ bool mp_get_runtime_busy(void);
 bool mp_runtime_is_idle(void);
 
 stat_t mp_aline(GCodeState_t *_gm);                   // line planning...
+stat_t mp_arc(cmArc_t *arc);                          // native arc planning
+bool mp_arc_is_native(void);
 void mp_plan_block_list(void);
 void mp_plan_block_forward(mpBuf_t *bf);
+void mp_clear_merge(void);
+void mp_set_stored_plan(const mpStoredPlan_t *plan);
+bool mp_calculate_line(mpBuf_t *bf, const float start[], const float target[]);
+void mp_calculate_junction(mpBuf_t *bf);
+void mp_set_jerk(mpBuf_t *bf, const float jerk);
+float mp_get_horizon_vmax(const mpBuf_t *bf, const float vmax);
 void mp_recalculate_jerk_for_feedhold(mpBuf_t *bf);
 bool mp_should_recalculate_jerk_for_feedhold(mpBuf_t *bf);
 
 //**** plan_zoid.c functions
 stat_t mp_calculate_ramps(mpBlockRuntimeBuf_t *block, mpBuf_t *bf, const float entry_velocity);
+stat_t mp_fit_ramps(mpBlockRuntimeBuf_t *block, mpBuf_t *bf, const float entry_velocity);
 float mp_get_target_length(const float v_0, const float v_1, const mpBuf_t *bf);
 float mp_get_target_velocity(const float v_0, const float L, const mpBuf_t *bf); // acceleration ONLY
 float mp_get_decel_velocity(const float v_0, const float L, const mpBuf_t *bf);  // deceleration ONLY
@@ -673,4 +896,22 @@ void mp_exit_hold_state(void);
 
 void mp_dump_planner(mpBuf_t *bf_start);
 
+//**** planner profiling functions
+
+#ifdef __PLANNER_PROFILING
+void mp_profile_init(void);
+void mp_profile_plan_block(const uint32_t cycles);
+void mp_profile_backplan(const uint16_t visits);
+
+stat_t mp_get_pfb(nvObj_t *nv);
+stat_t mp_get_pfs(nvObj_t *nv);
+stat_t mp_get_pfm(nvObj_t *nv);
+stat_t mp_get_pfa(nvObj_t *nv);
+stat_t mp_get_pfl(nvObj_t *nv);
+stat_t mp_get_pfv(nvObj_t *nv);
+stat_t mp_get_pfw(nvObj_t *nv);
+stat_t mp_get_pfe(nvObj_t *nv);
+stat_t mp_set_pfc(nvObj_t *nv);
+#endif
+
 #endif    // End of include Guard: PLANNER_H_ONCE
@@ -164,10 +164,76 @@ void rpt_print_system_ready_message(void)
  *      the system into text mode.
  *
  *    - Automatic status reports in text mode return CSV format according to si setting
+ *
+ *  Change tracking: Filtered reports only fetch items whose change sources (SR_CHANGED_xxx in
+ *  report.h) have been flagged since the last filtered report. Sources are flagged where the
+ *  values change - the canonical machine model setters, the runtime segment and position
+ *  updates, config sets and p1/p2 switches. Items with getters not listed in
+ *  _sr_change_sources[] are polled as before, so new SR items stay correct without a source.
  */
 static stat_t _populate_unfiltered_status_report(void);
 static uint8_t _populate_filtered_status_report(void);
 
+/*
+ * _get_change_sources() - return the change sources for an SR item's get function
+ */
+
+static const struct {
+    fptrCmd get;
+    uint8_t sources;
+} _sr_change_sources[] = {
+    { cm_get_stat,  SR_CHANGED_STATE },
+    { cm_get_macs,  SR_CHANGED_STATE },
+    { cm_get_cycs,  SR_CHANGED_STATE },
+    { cm_get_mots,  SR_CHANGED_STATE },
+    { cm_get_hold,  SR_CHANGED_STATE },
+    { cm_get_home,  SR_CHANGED_STATE },
+    { cm_get_prob,  SR_CHANGED_STATE },
+    { cm_get_unit,  SR_CHANGED_MODEL },
+    { cm_get_coor,  SR_CHANGED_MODEL },
+    { cm_get_momo,  SR_CHANGED_MODEL },
+    { cm_get_plan,  SR_CHANGED_MODEL },
+    { cm_get_path,  SR_CHANGED_MODEL },
+    { cm_get_dist,  SR_CHANGED_MODEL },
+    { cm_get_admo,  SR_CHANGED_MODEL },
+    { cm_get_frmo,  SR_CHANGED_MODEL },
+    { cm_get_toolv, SR_CHANGED_MODEL },
+    { cm_get_feed,  SR_CHANGED_MODEL },
+    { cm_get_mline, SR_CHANGED_MODEL },
+    { cm_get_line,  SR_CHANGED_MODEL },
+    { cm_get_g92e,  SR_CHANGED_MODEL },
+    { cm_get_g92,   SR_CHANGED_MODEL },
+    { cm_get_ofs,   SR_CHANGED_MODEL | SR_CHANGED_RUNTIME },
+    { cm_get_pos,   SR_CHANGED_MODEL | SR_CHANGED_RUNTIME },
+    { cm_get_mpo,   SR_CHANGED_MODEL | SR_CHANGED_RUNTIME },
+    { cm_get_vel,   SR_CHANGED_STATE | SR_CHANGED_RUNTIME }     // vel is zero when motion is stopped
+};
+
+static uint8_t _get_change_sources(fptrCmd get)
+{
+    for (uint8_t i=0; i < (sizeof(_sr_change_sources) / sizeof(_sr_change_sources[0])); i++) {
+        if (_sr_change_sources[i].get == get) {
+            return (_sr_change_sources[i].sources);
+        }
+    }
+    return (SR_POLLED);
+}
+
+/*
+ * _state_signature() - pack the reported machine states into one word
+ */
+
+static uint32_t _state_signature()
+{
+    return (((uint32_t)cm_get_combined_state(&cm1) << 24) |
+            ((uint32_t)cm->machine_state << 20) |
+            ((uint32_t)cm->cycle_type << 16) |
+            ((uint32_t)cm->motion_state << 12) |
+            ((uint32_t)cm->hold_state << 8) |
+            ((uint32_t)cm->homing_state << 4) |
+            ((uint32_t)cm->probe_state[0]));
+}
+
 /*
  * sr_init_status_report()
  *
@@ -201,6 +267,7 @@ void sr_init_status_report()
         sr.status_report_list[i].get = cfgTmp.get;
         // sr.status_report_list[i].flags = cfgTmp.flags;
         sr.status_report_list[i].precision = cfgTmp.precision;
+        sr.status_report_list[i].sources = _get_change_sources(cfgTmp.get);
         strcpy(sr.status_report_list[i].group, cfgTmp.group);
         strcpy(sr.status_report_list[i].token, cfgTmp.token);
 
@@ -219,6 +286,7 @@ void sr_init_status_report()
         // nv_persist(nv);                                         // conditionally persist - automatic by nv_persist()
         nv->index++;                                            // increment SR NVM index
     }
+    sr_flag_change(SR_CHANGED_ALL);                             // compare everything on the next filtered SR
 }
 
 /*
@@ -248,6 +316,7 @@ stat_t sr_set_status_report(nvObj_t *nv)
             status_report_list[i].get = cfgTmp.get;
             // status_report_list[i].flags = cfgTmp.flags;
             status_report_list[i].precision = cfgTmp.precision;
+            status_report_list[i].sources = _get_change_sources(cfgTmp.get);
             strcpy(status_report_list[i].group, cfgTmp.group);
             strcpy(status_report_list[i].token, cfgTmp.token);
 
@@ -273,6 +342,7 @@ stat_t sr_set_status_report(nvObj_t *nv)
         return (STAT_INPUT_LESS_THAN_MIN_VALUE);
     }
     memcpy(sr.status_report_list, status_report_list, sizeof(status_report_list));
+    sr_flag_change(SR_CHANGED_ALL);
     return(_populate_unfiltered_status_report());            // return current values
 }
 
@@ -332,6 +402,7 @@ stat_t sr_status_report_callback()         // called by controller dispatcher
     if ((sr.status_report_request == SR_OFF) ||
         (sr.status_report_verbosity == SR_OFF) ||
         (!sr.status_report_systick.isPast()) ||
+        (js.stream_active) ||                   // wait for the TX device to take the last response
         (cs.controller_state != CONTROLLER_READY) ) {
         return (STAT_NOOP);
     }
@@ -417,6 +488,9 @@ static stat_t _populate_unfiltered_status_report()
  *
  *  NOTE: Room for improvement - look up the SR index initially and cache it, use the
  *        cached value for all remaining reports.
+ *
+ *  Items whose change sources have not been flagged since the last filtered report are
+ *  skipped without calling their get functions.
  */
 static uint8_t _populate_filtered_status_report()
 {
@@ -434,10 +508,21 @@ static uint8_t _populate_filtered_status_report()
 //    nv->index = nv_get_index((const char *)"", sr_str);// OMITTED - set the index - may be needed by calling function
     nv = nv->nx;                                // no need to check for NULL as list has just been reset
 
+    uint32_t state_signature = _state_signature();
+    if (state_signature != sr.state_signature) {
+        sr.state_signature = state_signature;
+        sr_flag_change(SR_CHANGED_STATE);
+    }
+    uint8_t changed = sr.changed.exchange(0) | SR_POLLED;
+
     for (uint8_t i=0; i<NV_STATUS_REPORT_LEN; i++) {
         if (sr.status_report_list[i].index == 0) {  // end of list
             break;
         }
+        if (((sr.status_report_list[i].sources & changed) == 0) &&
+            (sr.status_report_list[i].index != sr.stat_index)) {  // stops and ends are always reported
+            continue;                           // nothing this value depends on has changed
+        }
         // nv_get_nvObj(nv);
         nv_reset_nv(nv);
         nv->index = sr.status_report_list[i].index;
@@ -472,6 +557,7 @@ static uint8_t _populate_filtered_status_report()
             sr.status_report_list[i].value = current_value;
 
             if ((nv = nv->nx) == NULL) {        // should never be NULL unless SR length exceeds available buffer array
+                sr_flag_change(changed & SR_CHANGED_ALL);   // check the remaining items next time
                 return (false);
             }
             has_data = true;
@@ -599,6 +685,7 @@ stat_t qr_queue_report_callback()         // called by controller dispatcher
     if ((qr.queue_report_verbosity == QR_OFF) ||
         (js.json_verbosity == JV_SILENT) ||
         (qr.queue_report_requested == false) ||
+        (js.stream_active) ||
         (!mp_is_phat_city_time())) {
         return (STAT_NOOP);
     }
@@ -625,6 +712,43 @@ stat_t qr_queue_report_callback()         // called by controller dispatcher
     return (STAT_OK);
 }
 
+/*
+ * qs_init_starvation_report() - clear the planner starvation counters
+ * qs_sample_plannable_time()  - record the least time in the planner (minutes)
+ *
+ *  The starvation counters show whether a job is feeding the planner fast enough.
+ *  They are cleared at cycle start and accumulate for the whole cycle, so they can
+ *  be read once a job is complete. They are not cleared by queue reports.
+ *
+ *    qss - times the runtime was in motion but the next block was queued and not yet
+ *          planned, so it had to load a null segment. Each stall counts once
+ *    qsv - moves that exited below their junction velocity because the planner was
+ *          short of time and had to plan to stop at the end of the queue. Only counted
+ *          while blocks are still arriving - the stop at the end of a job doesn't count
+ *    qsm - least time in the planner (ms) while new blocks were still arriving
+ *    qsh - blocks that started with less path queued than it takes to brake from their
+ *          cruise velocity (see mp_planner_time_accounting())
+ *
+ *  The current horizon - hzl (mm) and hzt (ms) - is not a counter and may be put in
+ *  status reports.
+ */
+
+void qs_init_starvation_report()
+{
+    qr.starvations = 0;
+    qr.starved = false;
+    qr.queue_limited = 0;
+    qr.horizon_short = 0;
+    qr.plannable_time_min = 0;
+}
+
+void qs_sample_plannable_time(float plannable_time)
+{
+    if ((plannable_time > 0) && ((qr.plannable_time_min == 0) || (plannable_time < qr.plannable_time_min))) {
+        qr.plannable_time_min = plannable_time;
+    }
+}
+
 /* Alternate Formulation for a Single report - using nvObj list
 
     // get a clean nv object
@@ -674,6 +798,59 @@ stat_t qo_get(nvObj_t *nv)
 stat_t qr_get_qv(nvObj_t *nv) { return(get_integer(nv, (uint8_t &)qr.queue_report_verbosity)); }
 stat_t qr_set_qv(nvObj_t *nv) { return(set_integer(nv, (uint8_t &)qr.queue_report_verbosity, QR_OFF, QR_TRIPLE)); }
 
+/*
+ * qs_get_qss() - get planner starvations this cycle
+ * qs_get_qsv() - get moves velocity limited by queue depth this cycle
+ * qs_get_qsm() - get minimum time in planner this cycle, in ms
+ * qs_get_qsh() - get blocks started with a horizon shorter than their braking distance
+ * qs_get_hzl() - get current look-ahead horizon, in mm
+ * qs_get_hzt() - get current look-ahead horizon, in ms
+ */
+stat_t qs_get_qss(nvObj_t *nv)
+{
+    nv->value_int = qr.starvations;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t qs_get_qsv(nvObj_t *nv)
+{
+    nv->value_int = qr.queue_limited;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t qs_get_qsm(nvObj_t *nv)
+{
+    nv->value_flt = qr.plannable_time_min * 60000;     // minutes to ms
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t qs_get_qsh(nvObj_t *nv)
+{
+    nv->value_int = qr.horizon_short;
+    nv->valuetype = TYPE_INTEGER;
+    return (STAT_OK);
+}
+
+stat_t qs_get_hzl(nvObj_t *nv)
+{
+    nv->value_flt = mp->horizon_length;                 // always mm
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
+stat_t qs_get_hzt(nvObj_t *nv)
+{
+    nv->value_flt = mp->horizon_time * 60000;           // minutes to ms
+    nv->precision = GET_TABLE_WORD(precision);
+    nv->valuetype = TYPE_FLOAT;
+    return (STAT_OK);
+}
+
 /*****************************************************************************
  * JOB ID REPORTS
  *
@@ -754,10 +931,22 @@ static const char fmt_qr[] = "qr:%d\n";
 static const char fmt_qi[] = "qi:%d\n";
 static const char fmt_qo[] = "qo:%d\n";
 static const char fmt_qv[] = "[qv]  queue report verbosity%7d [0=off,1=single,2=triple]\n";
+static const char fmt_qss[] = "Planner starvations:%8d\n";
+static const char fmt_qsv[] = "Queue limited moves:%8d\n";
+static const char fmt_qsm[] = "Min planner time:%11.1f ms\n";
+static const char fmt_qsh[] = "Short horizon moves:%8d\n";
+static const char fmt_hzl[] = "Planner horizon:%12.3f mm\n";
+static const char fmt_hzt[] = "Planner horizon:%12.1f ms\n";
 
 void qr_print_qr(nvObj_t *nv) { text_print(nv, fmt_qr);}    // TYPE_INT
 void qr_print_qi(nvObj_t *nv) { text_print(nv, fmt_qi);}    // TYPE_INT
 void qr_print_qo(nvObj_t *nv) { text_print(nv, fmt_qo);}    // TYPE_INT
 void qr_print_qv(nvObj_t *nv) { text_print(nv, fmt_qv);}    // TYPE_INT
+void qs_print_qss(nvObj_t *nv) { text_print(nv, fmt_qss);}  // TYPE_INT
+void qs_print_qsv(nvObj_t *nv) { text_print(nv, fmt_qsv);}  // TYPE_INT
+void qs_print_qsm(nvObj_t *nv) { text_print(nv, fmt_qsm);}  // TYPE_FLOAT
+void qs_print_qsh(nvObj_t *nv) { text_print(nv, fmt_qsh);}  // TYPE_INT
+void qs_print_hzl(nvObj_t *nv) { text_print(nv, fmt_hzl);}  // TYPE_FLOAT
+void qs_print_hzt(nvObj_t *nv) { text_print(nv, fmt_hzt);}  // TYPE_FLOAT
 
 #endif // __TEXT_MODE
@@ -28,6 +28,8 @@
 #ifndef REPORT_H_ONCE
 #define REPORT_H_ONCE
 
+#include <atomic>
+
 /**** Configs, Definitions and Structures ****/
 // Note: If you are looking for the defaults for the status report see settings.h
 
@@ -58,12 +60,23 @@ typedef enum {                      // planner queue enable and verbosity
 } qrVerbosity;
 
 
+// Change sources for filtered status reports. Code that changes a reported value flags its
+// source with sr_flag_change(); filtered reports only fetch items whose sources have changed.
+// Items that depend on nothing listed here are SR_POLLED and fetched on every report.
+// (*) States are written in too many places to flag. Reports compare a packed copy instead.
+#define SR_CHANGED_STATE    0x01    // machine, cycle, motion, hold, homing and probe states (*)
+#define SR_CHANGED_MODEL    0x02    // Gcode model - modes, offsets, feed rate, tool, line number
+#define SR_CHANGED_RUNTIME  0x04    // runtime position and velocity
+#define SR_CHANGED_ALL      (SR_CHANGED_STATE | SR_CHANGED_MODEL | SR_CHANGED_RUNTIME)
+#define SR_POLLED           0x80    // no change source - always fetched and compared
+
 struct status_report_item { // structure to hold the cached status report items, saving time for lookup
     char group[GROUP_LEN + 1];
     char token[TOKEN_LEN + 1];
     index_t index;
     // uint8_t flags;                      // operations flags - see defines below
     int8_t precision;                   // decimal precision for display (JSON)
+    uint8_t sources;                    // SR_CHANGED_xxx sources the value depends on, or SR_POLLED
     double value;
     fptrCmd get;                        // GET binding aka uint8_t (*get)(nvObj_t *nv)
 };
@@ -78,6 +91,8 @@ typedef struct srSingleton {
     Motate::Timeout status_report_systick;                     // SysTick value for next status report
     index_t stat_index;                                 // table index value for stat - determined during initialization
     uint8_t throttle_counter;                           // slow down SRs when in a constrained time (not phat_city)
+    std::atomic<uint8_t> changed;                       // SR_CHANGED_xxx sources flagged since the last filtered SR
+    uint32_t state_signature;                           // machine states at the last filtered SR
     status_report_item status_report_list[NV_STATUS_REPORT_LEN];   // status report elements to report
 } srSingleton_t;
 
@@ -88,13 +103,20 @@ typedef struct qrSingleton {        // data for queue reports
 
     /*** runtime values (PRIVATE) ***/
     uint8_t queue_report_requested;         // set to true to request a report
-    uint8_t buffers_available;              // stored buffer depth passed to by callback
-    uint8_t prev_available;                 // buffers available at last count
+    uint16_t buffers_available;             // stored buffer depth passed to by callback
+    uint16_t prev_available;                // buffers available at last count
     uint16_t buffers_added;                 // buffers added since last count
     uint16_t buffers_removed;               // buffers removed since last report
     uint8_t motion_mode;                    // used to detect arc movement
     uint32_t init_tick;                     // time when values were last initialized or cleared
 
+    // planner starvation counters - cleared at cycle start, not by queue reports
+    uint32_t starvations;                   // times the runtime ran out of planned blocks while in motion
+    bool starved;                           // true while the runtime is waiting on the planner
+    uint32_t queue_limited;                 // moves slowed because too little time was queued behind them
+    uint32_t horizon_short;                 // blocks started with less path queued than it takes to brake
+    float plannable_time_min;               // least time in planner while blocks were arriving (min) - 0 = none
+
 } qrSingleton_t;
 
 /**** Externs - See report.c for allocation ****/
@@ -102,6 +124,9 @@ typedef struct qrSingleton {        // data for queue reports
 extern srSingleton_t sr;
 extern qrSingleton_t qr;
 
+// flag a change for filtered status reports - safe to call from interrupts
+inline void sr_flag_change(const uint8_t sources) { sr.changed.fetch_or(sources, std::memory_order_relaxed); }
+
 /**** Function Prototypes ****/
 
 void rpt_print_message(char *msg);
@@ -130,6 +155,9 @@ void qr_init_queue_report(void);
 void qr_request_queue_report(int8_t buffers);
 stat_t qr_queue_report_callback(void);
 
+void qs_init_starvation_report(void);
+void qs_sample_plannable_time(float plannable_time);
+
 void rx_request_rx_report(void);
 stat_t rx_report_callback(void);
 
@@ -140,6 +168,13 @@ stat_t qo_get(nvObj_t *nv);
 stat_t qr_get_qv(nvObj_t *nv);
 stat_t qr_set_qv(nvObj_t *nv);
 
+stat_t qs_get_qss(nvObj_t *nv);
+stat_t qs_get_qsv(nvObj_t *nv);
+stat_t qs_get_qsm(nvObj_t *nv);
+stat_t qs_get_qsh(nvObj_t *nv);
+stat_t qs_get_hzl(nvObj_t *nv);
+stat_t qs_get_hzt(nvObj_t *nv);
+
 #ifdef __TEXT_MODE
 
     void sr_print_sr(nvObj_t *nv);
@@ -149,6 +184,12 @@ stat_t qr_set_qv(nvObj_t *nv);
     void qr_print_qr(nvObj_t *nv);
     void qr_print_qi(nvObj_t *nv);
     void qr_print_qo(nvObj_t *nv);
+    void qs_print_qss(nvObj_t *nv);
+    void qs_print_qsv(nvObj_t *nv);
+    void qs_print_qsm(nvObj_t *nv);
+    void qs_print_qsh(nvObj_t *nv);
+    void qs_print_hzl(nvObj_t *nv);
+    void qs_print_hzt(nvObj_t *nv);
 
 #else
 
@@ -159,6 +200,12 @@ stat_t qr_set_qv(nvObj_t *nv);
     #define qr_print_qr tx_print_stub
     #define qr_print_qi tx_print_stub
     #define qr_print_qo tx_print_stub
+    #define qs_print_qss tx_print_stub
+    #define qs_print_qsv tx_print_stub
+    #define qs_print_qsm tx_print_stub
+    #define qs_print_qsh tx_print_stub
+    #define qs_print_hzl tx_print_stub
+    #define qs_print_hzt tx_print_stub
 
 #endif // __TEXT_MODE
 
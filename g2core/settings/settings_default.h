@@ -66,6 +66,10 @@
 #define CHORDAL_TOLERANCE           0.01    // {ct: chordal tolerance for arcs (in mm)
 #endif
 
+#ifndef LINE_MERGE_TOLERANCE
+#define LINE_MERGE_TOLERANCE        0.0     // {lmt: max deviation when merging G1 lines (in mm), 0 = off
+#endif
+
 #ifndef MOTOR_POWER_TIMEOUT
 #define MOTOR_POWER_TIMEOUT         2.00    // {mt:  motor power timeout in seconds
 #endif
@@ -205,13 +209,17 @@
 #endif
 
 #ifndef STATUS_REPORT_MIN_MS
-#define STATUS_REPORT_MIN_MS        100                     // (no JSON) milliseconds - enforces a viable minimum
+#define STATUS_REPORT_MIN_MS        50                      // (no JSON) milliseconds - enforces a viable minimum
 #endif
 
 #ifndef STATUS_REPORT_INTERVAL_MS
 #define STATUS_REPORT_INTERVAL_MS   250                     // {si: milliseconds - set $SV=0 to disable
 #endif
 
+#ifndef TELEMETRY_RATE
+#define TELEMETRY_RATE              0                       // {tmr: Hz, up to 1000 - 0 is off. See telemetry.h
+#endif
+
 #ifndef STATUS_REPORT_DEFAULTS                              // {sr: See Status Reports wiki page
 #define STATUS_REPORT_DEFAULTS "line","posx","posy","posz","posa","feed","vel","unit","coor","dist","admo","frmo","momo","stat"
 // Alternate SRs that report in drawable units
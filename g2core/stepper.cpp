@@ -404,7 +404,10 @@ namespace Motate {    // Define timer inside Motate namespace
     {
         exec_timer.getInterruptCause();                    // clears the interrupt condition
         if (st_pre.buffer_state == PREP_BUFFER_OWNED_BY_EXEC) {
-            if (mp_exec_move() != STAT_NOOP) {
+            PROFILE_EXEC_START
+            stat_t status = mp_exec_move();
+            PROFILE_EXEC_END
+            if (status != STAT_NOOP) {
                 st_pre.buffer_state = PREP_BUFFER_OWNED_BY_LOADER; // flip it back
                 st_request_load_move();
                 return;
@@ -510,7 +513,9 @@ static void _load_move()
 
     // give the toolhead a chance to react to the upcoming move
     if (st_pre.bf) {
-        spindle_engage(st_pre.bf->gm);
+        static GCodeState_t gm;                 // static to keep it off the interrupt stack
+        mp_get_block_gm(st_pre.bf, &gm);
+        spindle_engage(gm);
     }
 
     // handle aline loads first (most common case)
@@ -771,6 +776,11 @@ stat_t st_prep_line(const float start_velocity, const float end_velocity, const
             st_pre.mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
             st_pre.mot[motor].step_sign = -1;
         }
+        // The direction is only loaded at a block start. A native arc reverses its plane axes
+        // inside the block, so treat a reversal as a block start for that motor.
+        if (st_pre.mot[motor].direction != st_pre.mot[motor].prev_direction) {
+            st_pre.mot[motor].start_new_block = true;
+        }
 
         // Compute substep increment. The accumulator must be *exactly* the incoming
         // fractional steps times the substep multiplier or positional drift will occur.
@@ -869,6 +879,11 @@ stat_t st_prep_line(const float start_velocities[], const float end_velocities[]
             st_pre.mot[motor].direction = DIRECTION_CCW ^ st_cfg.mot[motor].polarity;
             st_pre.mot[motor].step_sign = -1;
         }
+        // The direction is only loaded at a block start. A native arc reverses its plane axes
+        // inside the block, so treat a reversal as a block start for that motor.
+        if (st_pre.mot[motor].direction != st_pre.mot[motor].prev_direction) {
+            st_pre.mot[motor].start_new_block = true;
+        }
 
         // All math is explained in the previous function
         float s_double = std::abs(steps * 2.0);
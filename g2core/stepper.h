@@ -299,7 +299,7 @@ enum stPowerMode {
  *
  *    MAX_LONG == 2^31, maximum signed long (depth of accumulator. NB: accumulator values are negative)
  *    FREQUENCY_DDA == DDA clock rate in Hz.
- *    NOM_SEGMENT_TIME == upper bound of segment time in minutes
+ *    MAX_SEGMENT_TIME == upper bound of segment time in minutes
  *    0.90 == a safety factor used to reduce the result from theoretical maximum ////##th I can't find where this is used ???
  *
  */
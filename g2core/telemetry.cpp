@@ -0,0 +1,191 @@
+/*
+ * telemetry.cpp - binary position telemetry on the secondary xio channel
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2011 - 2019 Alden S. Hart, Jr.
+ * Copyright (c) 2016 - 2019 Rob Giseburt
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "g2core.h"
+#include "config.h"
+#include "telemetry.h"
+#include "text_parser.h"
+#include "planner.h"
+#include "encoder.h"
+#include "util.h"
+#include "xio.h"
+
+#include <atomic>
+#include <stddef.h>   // offsetof
+
+#ifdef __TELEMETRY
+
+/**** Allocation ****/
+
+static struct tmSingleton {         // telemetry state - see telemetry.h for the record format
+    int32_t rate;                   // sample rate in Hz - 0 is off {tmr:}
+    uint16_t ticks;                 // SysTick ticks between samples
+    uint16_t tick_downcount;        // ticks until the next sample
+    uint16_t sequence;              // sequence number for the next sample
+    bool tick_registered;           // the SysTick event is registered
+
+    std::atomic<uint8_t> head;      // next record to fill (written by the SysTick interrupt)
+    std::atomic<uint8_t> tail;      // next record to send (written by the main loop)
+    uint8_t sent;                   // bytes of the tail record sent so far
+    tmRecord_t buffer[TELEMETRY_BUFFER_RECORDS];
+} tlm;
+
+static_assert(((TELEMETRY_BUFFER_RECORDS-1) & TELEMETRY_BUFFER_RECORDS) == 0, "TELEMETRY_BUFFER_RECORDS must be 2^N");
+
+/*
+ * _take_sample() - fill the next record from the runtime. Called from the SysTick interrupt
+ *
+ *  Head and tail are free running, so head - tail is the number of records waiting.
+ *  A sample is dropped if the buffer is full, but still takes a sequence number.
+ *
+ *  The exec and DDA interrupts preempt SysTick and update the runtime position, line,
+ *  velocity and step counts as they go, so interrupts are masked while they are copied.
+ *  Otherwise a record could mix axes from two segments. The copy is a few dozen words.
+ */
+
+static void _take_sample()
+{
+    if (--tlm.tick_downcount != 0) {
+        return;
+    }
+    tlm.tick_downcount = tlm.ticks;
+    uint16_t sequence = tlm.sequence++;
+
+    uint8_t head = tlm.head.load(std::memory_order_relaxed);
+    if ((uint8_t)(head - tlm.tail.load(std::memory_order_acquire)) == TELEMETRY_BUFFER_RECORDS) {
+        return;
+    }
+    tmRecord_t &r = tlm.buffer[head & (TELEMETRY_BUFFER_RECORDS-1)];
+    r.sync = TELEMETRY_SYNC;
+    r.layout = (AXES << 4) | MOTORS;
+    r.sequence = sequence;
+    r.time_ms = SysTickTimer.getValue();
+
+    __disable_irq();
+    r.linenum = mr->gm.linenum;
+    r.velocity = mp_get_runtime_velocity();
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        r.position[axis] = mp_get_runtime_absolute_position(mr, axis);
+    }
+    en_take_encoder_snapshot(r.steps);
+    __enable_irq();
+
+    tlm.head.store(head + 1, std::memory_order_release);
+}
+
+static Motate::SysTickEvent _telemetry_tick_event {[] { _take_sample(); }, nullptr};
+
+/*
+ * telemetry_init() - initialize telemetry. Sampling starts when the rate is set
+ */
+
+void telemetry_init()
+{
+    tlm.rate = 0;
+    tlm.sequence = 0;
+    tlm.sent = 0;
+    tlm.head.store(0, std::memory_order_relaxed);
+    tlm.tail.store(0, std::memory_order_relaxed);
+}
+
+/*
+ * telemetry_callback() - main loop callback to send waiting records
+ *
+ *  Sends as much as the secondary channel will take without waiting. The CRC is
+ *  computed here rather than in the interrupt, just before a record starts out.
+ */
+
+stat_t telemetry_callback()
+{
+    uint8_t tail = tlm.tail.load(std::memory_order_relaxed);
+    if (tail == tlm.head.load(std::memory_order_acquire)) {
+        return (STAT_NOOP);
+    }
+    do {
+        tmRecord_t &r = tlm.buffer[tail & (TELEMETRY_BUFFER_RECORDS-1)];
+        if (tlm.sent == 0) {
+            r.crc = crc32(0, &r, offsetof(tmRecord_t, crc));
+        }
+        tlm.sent += xio_write_secondary((const char *)&r + tlm.sent, sizeof(tmRecord_t) - tlm.sent);
+        if (tlm.sent < sizeof(tmRecord_t)) {
+            break;                          // channel is full - the rest goes next time
+        }
+        tlm.sent = 0;
+        tlm.tail.store(++tail, std::memory_order_release);
+    } while (tail != tlm.head.load(std::memory_order_acquire));
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * CONFIGURATION AND INTERFACE FUNCTIONS
+ * Functions to get and set variables from the cfgArray table
+ ***********************************************************************************/
+
+/*
+ * tm_get_tmr() - get telemetry rate in Hz
+ * tm_set_tmr() - set telemetry rate in Hz, 0 to turn telemetry off
+ *
+ *  Samples are taken every 1000/rate SysTick ticks, rounded to a whole number.
+ */
+
+stat_t tm_get_tmr(nvObj_t *nv) { return (get_integer(nv, tlm.rate)); }
+stat_t tm_set_tmr(nvObj_t *nv)
+{
+    ritorno(set_int32(nv, tlm.rate, 0, TELEMETRY_RATE_MAX));
+
+    if (tlm.rate == 0) {
+        if (tlm.tick_registered) {
+            SysTickTimer.unregisterEvent(&_telemetry_tick_event);
+            tlm.tick_registered = false;
+        }
+        return (STAT_OK);
+    }
+    uint16_t ticks = (TELEMETRY_RATE_MAX + tlm.rate/2) / tlm.rate;
+    tlm.ticks = ticks;
+    tlm.tick_downcount = ticks;
+    if (!tlm.tick_registered) {
+        SysTickTimer.registerEvent(&_telemetry_tick_event);
+        tlm.tick_registered = true;
+    }
+    return (STAT_OK);
+}
+
+/***********************************************************************************
+ * TEXT MODE SUPPORT
+ * Functions to print variables from the cfgArray table
+ ***********************************************************************************/
+
+#ifdef __TEXT_MODE
+
+static const char fmt_tmr[] = "[tmr] telemetry rate%15d Hz [0=off]\n";
+
+void tm_print_tmr(nvObj_t *nv) { text_print(nv, fmt_tmr);}
+
+#endif // __TEXT_MODE
+
+#endif // __TELEMETRY
@@ -0,0 +1,97 @@
+/*
+ * telemetry.h - binary position telemetry on the secondary xio channel
+ * This file is part of the g2core project
+ *
+ * Copyright (c) 2011 - 2019 Alden S. Hart, Jr.
+ * Copyright (c) 2016 - 2019 Rob Giseburt
+ *
+ * This file ("the software") is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2 as published by the
+ * Free Software Foundation. You should have received a copy of the GNU General Public
+ * License, version 2 along with the software.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, you may use this file as part of a software library without
+ * restriction. Specifically, if other files instantiate templates or use macros or
+ * inline functions from this file, or you compile this file and link it with  other
+ * files to produce an executable, this file does not by itself cause the resulting
+ * executable to be covered by the GNU General Public License. This exception does not
+ * however invalidate any other reasons why the executable file might be covered by the
+ * GNU General Public License.
+ *
+ * THE SOFTWARE IS DISTRIBUTED IN THE HOPE THAT IT WILL BE USEFUL, BUT WITHOUT ANY
+ * WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT
+ * SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+ * OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * Telemetry samples the runtime at a fixed rate - up to 1 kHz - for capturing the
+ * tool path actually run. It is much denser and more regular than status reports.
+ *
+ * Records are written to the secondary channel: the data-only xio device, e.g.
+ * SerialUSB1 once it has connected alongside SerialUSB. Nothing else is written to
+ * that channel, so a host can read records from it while it sends Gcode to it.
+ * With no secondary channel connected the records are discarded.
+ *
+ * Sampling runs from the SysTick interrupt (1 ms), so the rate is 1000/N Hz for a
+ * whole number N. {tmr:n} sets the rate in Hz, 0 turns telemetry off. The main loop
+ * sends the records. If the host falls behind, new records are dropped. Sequence
+ * numbers keep counting, so a gap in the sequence shows how many were lost.
+ *
+ * Records are a fixed size for a given build. All values are little-endian and floats
+ * are IEEE-754 float32. There is no padding.
+ *
+ *    uint8_t   sync            TELEMETRY_SYNC - resync by finding a record with a good CRC
+ *    uint8_t   layout          (AXES << 4) | MOTORS - gives the record size for decoding
+ *    uint16_t  sequence        increments with every sample taken, wraps
+ *    uint32_t  time_ms         SysTick time of the sample
+ *    uint32_t  linenum         runtime line number
+ *    float     velocity        segment velocity, mm/min
+ *    float     position[AXES]  runtime absolute position, mm (degrees for rotary axes)
+ *    int32_t   steps[MOTORS]   encoder step counts (see encoder.h)
+ *    uint32_t  crc             crc32() of all the preceding bytes of the record (util.cpp)
+ */
+
+#ifndef _TELEMETRY_H_ONCE
+#define _TELEMETRY_H_ONCE
+
+#ifdef __TELEMETRY
+
+/**** Configs, Definitions and Structures ****/
+
+#define TELEMETRY_SYNC 0xA5
+#define TELEMETRY_RATE_MAX 1000             // Hz - the SysTick rate
+#define TELEMETRY_BUFFER_RECORDS 16         // records buffered for sending. Must be a power of 2
+
+typedef struct tmRecord {                   // see the record layout, above
+    uint8_t sync;
+    uint8_t layout;
+    uint16_t sequence;
+    uint32_t time_ms;
+    uint32_t linenum;
+    float velocity;
+    float position[AXES];
+    int32_t steps[MOTORS];
+    uint32_t crc;
+} tmRecord_t;
+
+static_assert(sizeof(tmRecord_t) == (20 + 4*AXES + 4*MOTORS), "telemetry records must not be padded");
+
+/**** Function Prototypes ****/
+
+void telemetry_init(void);
+stat_t telemetry_callback(void);
+
+stat_t tm_get_tmr(nvObj_t *nv);
+stat_t tm_set_tmr(nvObj_t *nv);
+
+#ifdef __TEXT_MODE
+    void tm_print_tmr(nvObj_t *nv);
+#else
+    #define tm_print_tmr tx_print_stub
+#endif // __TEXT_MODE
+
+#endif // __TELEMETRY
+
+#endif // _TELEMETRY_H_ONCE
@@ -121,8 +121,8 @@ static stat_t _text_parser_kernal(char *str, nvObj_t *nv)
         *rd = NUL;                              // terminate at end of name
         strncpy(nv->token, str, TOKEN_LEN);
         str = ++rd;
-        nv->value_int = atol(str);              // collect the number as an integer
-        nv->value_flt = strtof(str, &rd);       // collect the number as a float - rd used as end pointer
+        rd = str;
+        nv->value_flt = atonum(rd, nv->value_int, true); // collect the number as a float and integer - rd used as end pointer
         if (rd != str) {
             nv->valuetype = TYPE_FLOAT;         // provisionally set it as a float
         }
@@ -240,7 +240,7 @@ void text_print_nul(nvObj_t *nv, const char *string)
 
 void text_print_str(nvObj_t *nv, const char *format)
 {
-    sprintf(cs.out_buf, format, *nv->stringp);
+    snprintf(cs.out_buf, sizeof(cs.out_buf), format, *nv->stringp);   // strings may be longer than the line
     xio_writeline(cs.out_buf);
 }
 
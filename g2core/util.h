@@ -61,13 +61,21 @@ static void _hold_everything (uint32_t n1, uint32_t n2) // example of function
 
 //*** vector utilities ***
 
+/* Axis vectors are plain float[AXES] so they can be handed to the kinematics, copied with
+ *  copy_vector() and indexed by cmAxes. The ones the planner uses for every block are
+ *  declared AXIS_VECTOR_ALIGNED so the FPU can move them in doubleword pairs (VLDM/VSTM,
+ *  LDRD/STRD). The axis vector math is inline with a constant trip count (see below) so it
+ *  unrolls at each call site into straight-line code for 6 or 9 axes. Per-axis loops on
+ *  the planner hot path follow the same rule: they compute every axis and use the axis
+ *  flags to select the result (a conditional move) rather than branching around the math.
+ */
+#define AXIS_VECTOR_ALIGNED __attribute__ ((aligned (8)))
+
 extern float vector[AXES]; // vector of axes for passing to subroutines
 
 #define clear_vector(a) (memset(a,0,sizeof(a)))
 #define copy_vector(d,s) (memcpy(d,s,sizeof(d)))
 
-float get_axis_vector_length(const float a[], const float b[]);
-uint8_t vector_equal(const float a[], const float b[]);
 float *set_vector(float x, float y, float z, float a, float b, float c);
 float *set_vector_by_axis(float value, uint8_t axis);
 
@@ -98,9 +106,10 @@ float *set_vector_by_axis(float value, uint8_t axis);
 //*** string utilities ***
 
 uint8_t isnumber(char c);
-char *escape_string(char *dst, char *src);
+char *escape_string(char *dst, char *src, uint16_t size);
 uint16_t compute_checksum(char const *string, const uint16_t length);
 uint32_t crc32(uint32_t crc, const void *buf, size_t size);
+float atonum(char *&p, int32_t &int_part, const bool exponent = false);
 char floattoa(char *buffer, float in, int precision, int maxlen = 16);
 char inttoa(char *str, int n);
 
@@ -153,6 +162,32 @@ inline T avg(const T a,const T b) {return (a+b)/2; }
 #define fp_TRUE(a) (a > EPSILON)
 #endif
 
+//**** Axis vector math *****
+// All AXES axes, including UVW on 9 axis builds
+
+inline float get_axis_vector_length_sq(const float a[], const float b[])
+{
+    float length_sq = 0;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        length_sq += square(a[axis] - b[axis]);
+    }
+    return (length_sq);
+}
+
+inline float get_axis_vector_length(const float a[], const float b[])
+{
+    return (std::sqrt(get_axis_vector_length_sq(a, b)));
+}
+
+inline uint8_t vector_equal(const float a[], const float b[])
+{
+    bool equal = true;
+    for (uint8_t axis = 0; axis < AXES; axis++) {
+        equal &= fp_EQ(a[axis], b[axis]);               // no early exit - keeps the loop unrollable
+    }
+    return (equal);
+}
+
 // Constants
 #define MAX_LONG (2147483647)
 #define MAX_ULONG (4294967295)
@@ -177,27 +212,6 @@ inline T avg(const T a,const T b) {return (a+b)/2; }
 #define M_SQRT3 (1.73205080756888)
 #endif
 
-// Fraction part
-constexpr float c_atof_frac_(char *&p_, float v_, float m_) {
-    return ((*p_ >= '0') && (*p_ <= '9')) ? (v_ = ((v_) + ((*p_) - '0') * m_), c_atof_frac_(++p_, v_, m_ / 10.0)) : v_;
-}
-
-// Integer part
-template <typename int_type>
-constexpr float c_atof_int_(char *&p_, int_type v_) {
-    return (*p_ == '.')
-    ? (float)(v_) + c_atof_frac_(++p_, 0, 1.0 / 10.0)
-    : (((*p_ >= '0') && (*p_ <= '9')) ? ((v_ = ((*p_) - '0') + (v_ * 10)), c_atof_int_(++p_, v_)) : v_);
-}
-
-// Start portion
-constexpr float c_atof(char *&p_) { return (*p_ == '-') ? (c_atof_int_(++p_, 0) * -1.0) : ( (*p_ == '+') ? c_atof_int_(++p_, 0) : (c_atof_int_(p_, 0))); }
-
-// It's assumed that the string buffer contains at lest count_ non-\0 chars
-//constexpr int c_strreverse(char * const t, const int count_, char hold = 0) {
-//    return count_>1 ? (hold=*t, *t=*(t+(count_-1)), *(t+(count_-1))=hold), c_strreverse(t+1, count_-2), count_ : count_;
-//}
-
 /*** Debug and DIAGNOSTICS  ***
  *
  *  This section collects debug and DIAGNOSTIC functions used by the project.
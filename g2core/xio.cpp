@@ -51,6 +51,10 @@ using Motate::TXBuffer;
 #include "text_parser.h"
 #endif
 
+#ifdef __BINARY_MOTION
+#include "binary_parser.h"
+#endif
+
 // defines for assertions
 
 /**** HIGH LEVEL EXPLANATION OF XIO ****
@@ -167,7 +171,10 @@ struct xioDeviceWrapperBase {                // C++ base class for device primit
     virtual bool flushToCommand() { return false; };
     virtual int16_t write(const char *buffer, int16_t len) { return -1; };
 
-    virtual char *readline(devflags_t limit_flags, uint16_t &size) { return nullptr; };
+    // readline_view() returns the size of the next line and sets line to it in place, or 0
+    // line_string() copies the line last returned by readline_view() to a NUL-terminated string
+    virtual uint16_t readline_view(devflags_t limit_flags, xioLineView &line) { return 0; };
+    virtual char *line_string(const xioLineView &line) { return nullptr; };
     virtual void flushDevice() {};
 
 #if MARLIN_COMPAT_ENABLED == true
@@ -181,6 +188,7 @@ struct xio_t {
 
     xioDeviceWrapperBase* DeviceWrappers[DEV_MAX];
     const uint8_t _dev_count;
+    void (*_partial_line_finish)(void) = nullptr;   // completes a line left part-written by write_some()
 
     template<typename... ds>
     xio_t(ds... args) : magic_start(MAGICNUM), DeviceWrappers {args...}, _dev_count(sizeof...(args)), magic_end(MAGICNUM) {
@@ -282,6 +290,63 @@ struct xio_t {
         return total_written;
     }
 
+    /*
+     * write_some() - write as much of a block as the device will take without waiting
+     *
+     * Returns the number of bytes taken, which may be zero if the TX buffer is full.
+     * Only a lone target device can take part of a block - with several the block is
+     * written in full (blocking) by write(). With no target, or a disconnected one,
+     * the data is dropped and reported as taken, same as write() would.
+     */
+    size_t write_some(const char *buffer, size_t size, bool only_to_muted)
+    {
+        int8_t target = -1;
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            if (only_to_muted ? DeviceWrappers[i]->isMuted() : DeviceWrappers[i]->isCtrlAndActive()) {
+                if (target >= 0) {
+                    write(buffer, size, only_to_muted);
+                    return size;
+                }
+                target = i;
+            }
+        }
+        if (target < 0) {
+            return size;
+        }
+        int16_t written = DeviceWrappers[target]->write(buffer, size);
+        return (written < 0) ? size : written;
+    }
+
+    /*
+     * write_secondary() - write to the secondary channel without waiting
+     *
+     * The secondary channel is a data-only device - e.g. SerialUSB1 while SerialUSB is the
+     * control channel. Nothing else writes to it. Returns the number of bytes taken, or the
+     * full size if there is no secondary channel (the data is dropped).
+     */
+    size_t write_secondary(const char *buffer, size_t size)
+    {
+        for (int8_t i = 0; i < _dev_count; ++i) {
+            if (DeviceWrappers[i]->isDataAndActive() && !DeviceWrappers[i]->isCtrl()) {
+                int16_t written = DeviceWrappers[i]->write(buffer, size);
+                return (written < 0) ? size : written;
+            }
+        }
+        return size;
+    }
+
+    /*
+     * finish_partial_line() - complete any line left part-written so other output can't split it
+     */
+    void finish_partial_line()
+    {
+        if (_partial_line_finish != nullptr) {
+            void (*finish)(void) = _partial_line_finish;
+            _partial_line_finish = nullptr;     // clear first - finish() writes through write_some()
+            finish();
+        }
+    }
+
     /*
      * writeline() - write a complete line to the controldevice
      *
@@ -328,10 +393,14 @@ struct xio_t {
     }
 
     /*
-     * readline() - read a complete line from a device
+     * readline_view() - read a complete line from a device, in place
+     * line_string()   - get the line last read by readline_view() as a string
+     * readline()      - read a complete line from a device as a string
      *
      *    Reads a line of text from the next active device that has one ready. With some exceptions.
-     *    Accepts CR or LF as line terminator. Replaces CR or LF with NUL in the returned string.
+     *    Accepts CR or LF as line terminator. readline_view() hands back the line where the device
+     *    holds it, without the terminator, and valid until the next read. line_string() copies it
+     *    to the device's line buffer with the CR or LF replaced by NUL. readline() does both.
      *
      *    This function iterates over all active control and data devices, including reading from
      *    multiple control devices. It will also manage multiple data devices, but only one data
@@ -343,16 +412,16 @@ struct xio_t {
      *             DEV_IS_DATA bits in the device flag field. 'Flags' is loaded with the flags of
      *             the channel that was read on return, or 0 (DEV_FLAGS_CLEAR) if no line was returned.
      *
-     *     size -  Returns the size of the completed buffer, including the NUL termination character.
+     *     size -  Returns the size of the line, not including the NUL termination character.
      *             Lines may be returned truncated to the length of the serial input buffer if the text
      *             from the physical device is longer than the read buffer for the device. The size value
      *             provided as a calling argument is ignored (size doesn't matter).
      *
      *     char * Returns a pointer to the buffer containing the line, or NULL (*0) if no text
      */
-    char *readline(devflags_t &flags, uint16_t &size)
+    uint16_t readline_view(devflags_t &flags, xioLineView &line)
     {
-        char *ret_buffer;
+        uint16_t size;
         devflags_t limit_flags = flags; // Store it so it can't get mangled
 
         // Always check control-capable devices FIRST
@@ -365,11 +434,12 @@ struct xio_t {
             if (!DeviceWrappers[dev]->isCtrl()) {
                 continue;
             }
-            ret_buffer = DeviceWrappers[dev]->readline(DEV_IS_CTRL, size);
+            size = DeviceWrappers[dev]->readline_view(DEV_IS_CTRL, line);
 
             if (size > 0) {
                 flags = DeviceWrappers[dev]->flags;
-                return ret_buffer;
+                _line_dev = dev;
+                return size;
             }
         }
 
@@ -379,18 +449,32 @@ struct xio_t {
                 if (!DeviceWrappers[dev]->isActive())
                     continue;
 
-                ret_buffer = DeviceWrappers[dev]->readline(limit_flags, size);
+                size = DeviceWrappers[dev]->readline_view(limit_flags, line);
 
                 if (size > 0) {
                     flags = DeviceWrappers[dev]->flags;
-                    return ret_buffer;
+                    _line_dev = dev;
+                    return size;
                 }
             }
         }
-        size = 0;
         flags = 0;
 
-        return (NULL);
+        return (0);
+    };
+
+    char *line_string(const xioLineView &line)
+    {
+        return (DeviceWrappers[_line_dev]->line_string(line));
+    };
+
+    char *readline(devflags_t &flags, uint16_t &size)
+    {
+        xioLineView line;
+        if ((size = readline_view(flags, line)) == 0) {
+            return (NULL);
+        }
+        return (line_string(line));
     };
 
     void flushDevice(devflags_t &flags)
@@ -412,6 +496,8 @@ struct xio_t {
     };
 #endif
 
+    uint8_t _line_dev = 0;              // device that returned the last line from readline_view()
+
     uint16_t magic_end;
 };
 
@@ -465,6 +551,14 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
 
     bool _last_returned_a_control = false;
 
+    bool _line_held = false;            // true while the last data line returned is still in use in _data
+    uint16_t _held_end_offset;          // offset of the first character after the held line
+
+#ifdef __BINARY_MOTION
+    uint16_t _frame_bytes_remaining;    // bytes left to scan in a binary motion frame, 0 if not in a frame
+    bool _frame_length_pending;         // true if the next byte scanned is a binary frame's length
+#endif
+
 #if MARLIN_COMPAT_ENABLED == true
     enum class STK500V2_State {
         Done,      // not in the faked stk500v2 bootloader
@@ -496,6 +590,11 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     void init() {
         parent_type::init();
         _at_start_of_line = true;
+        _line_held = false;
+#ifdef __BINARY_MOTION
+        _frame_bytes_remaining = 0;
+        _frame_length_pending = false;
+#endif
     };
 
 
@@ -617,7 +716,7 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
      *
      * For _scanBuffer() == false, IGNORE _line_start_offset and _scan_offset!!!
      * Only use _read_offset, and use _lines_found>0 to determine if _data contains a line to return.
-     * Also note that _read_offset needs to be moved once the data is copied to _line_buffer!
+     * Also note that _read_offset needs to be moved once the line has been used (see _releaseLine())!
      */
     /* Explanation of cases and how we handle it.
      *
@@ -647,6 +746,31 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
             bool is_control = false;
             char c = _data[_scan_offset];
 
+#ifdef __BINARY_MOTION
+            // Binary motion frames are opaque to the scanner - they may contain any byte,
+            // including NUL, CR, LF and the single-character controls. A complete frame
+            // is counted as one line. See binary_parser.h for the frame format.
+            if (_frame_length_pending || (_frame_bytes_remaining > 0)) {
+                if (_frame_length_pending) {
+                    _frame_length_pending = false;
+                    _frame_bytes_remaining = (uint8_t)c + BINARY_FRAME_CRC_LEN;
+                } else if (--_frame_bytes_remaining == 0) {
+                    _at_start_of_line = true;
+                    _lines_found++;
+                }
+                _scan_offset = _getNextScanOffset();
+                continue;
+            }
+            if (_at_start_of_line && (c == STX) && !_ignore_until_next_line) {
+                _line_start_offset = _scan_offset;
+                _at_start_of_line = false;
+                _last_control_was_feedhold = false;
+                _frame_length_pending = true;
+                _scan_offset = _getNextScanOffset();
+                continue;
+            }
+#endif
+
 #if MARLIN_COMPAT_ENABLED == true
             // it's possible something will try to talk stk500v2 to us.
             // See https://github.com/synthetos/g2/wiki/Marlin-Compatibility#stk500v2
@@ -827,14 +951,50 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
     };
 
     /*
-     * readline()
+     * _releaseLine() - give the space of the held data line back to the RX transfer
+     * _setView()     - point a line view at size chars of _data starting at offset
+     */
+    void _releaseLine() {
+        if (_line_held) {
+            _read_offset = _held_end_offset;
+            _line_held = false;
+        }
+    };
+
+    void _setView(xioLineView &line, const uint16_t offset, const uint16_t size) {
+        uint16_t to_end = _size - offset;
+        line.head = (const char *)&_data[offset];
+        if (size <= to_end) {
+            line.head_len = size;
+            line.tail = nullptr;
+            line.tail_len = 0;
+        } else {
+            line.head_len = to_end;
+            line.tail = (const char *)&_data[0];
+            line.tail_len = size - to_end;
+        }
+    };
+
+    /*
+     * readline_view()
+     * line_string()
+     *
+     * These are the ONLY external interfaces in this class
      *
-     * This is the ONLY external interface in this class
+     * readline_view() returns the size of the next line and sets line to it, or returns 0.
+     * Controls are copied to _line_buffer, as they are cut out from between data lines.
+     * Data lines and binary frames are returned in place in _data, and may wrap around its
+     * end. A data line is held - its space is not given back to the RX transfer - until the
+     * next call, so it can be parsed from _data without copying it first.
+     *
+     * line_string() copies a line returned in place to _line_buffer and NUL terminates it.
      *
      * Exit condition when a control is found: _line_start_offset and _scan_offset should be the same.
      * If the control was the first char of the buffer it also moves the _data_offset, marking it as read
      */
-    char *readline(bool control_only, uint16_t &line_size) {
+    uint16_t readline_view(bool control_only, xioLineView &line) {
+        _releaseLine();         // the caller is done with the last line
+
         // This is tricky: if we don't have room for more skip_sections, then we
         // can't scan any more for controls. So we don't scan, amd hope some lines are read.
         bool found_control = _skip_sections.isFull() ? false : _scanBuffer();
@@ -843,10 +1003,15 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
 
         _last_returned_a_control = found_control;
 
-        char *dst_ptr = _line_buffer;
-        line_size = 0;
+        uint16_t line_size = 0;
+        line.head = _line_buffer;
+        line.head_len = 0;
+        line.tail = nullptr;
+        line.tail_len = 0;
 
         if (found_control) {
+            char *dst_ptr = _line_buffer;
+
             // Optimization: if the control was found at the beginning of _data, we note that now
             // and update the _read_offset when we update _line_start_offset
             bool ctrl_is_at_beginning_of_data = (_line_start_offset == _read_offset);
@@ -893,12 +1058,12 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
                 _read_offset = _scan_offset;
             }
 
-            return _line_buffer;
+            line.head_len = line_size;
+            return line_size;
         } // end if (found_control)
 
         if (control_only) {
-            line_size = 0;
-            return nullptr;
+            return 0;
         }
 
         // skip sections will always start at the beginning of a line
@@ -907,8 +1072,7 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
 
         if (_lines_found == 0) {
             // nothing to return
-            line_size = 0;
-            return nullptr;
+            return 0;
         }
 
         // By the time we get here, we know we have at least one line in _data.
@@ -930,41 +1094,46 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
             c = _data[_read_offset];
         }
 
-        while (line_size < (_line_buffer_size - 1)) {
-            _read_offset = (_read_offset+1)&(_size-1);
-
-            if ( c == '\r' ||
-                 c == '\n'
-                ) {
+        uint16_t end_offset = _read_offset;
 
-                break;
+#ifdef __BINARY_MOTION
+        if (c == STX) {     // a binary motion frame is returned verbatim - it's not NUL or line terminated
+            line_size = (uint8_t)_data[(_read_offset+1)&(_size-1)] + BINARY_FRAME_OVERHEAD;
+            end_offset = (_read_offset + line_size)&(_size-1);
+        } else
+#endif
+        {
+            // find the end of the line - the scanner already split lines too long for _line_buffer
+            while ((line_size < (_line_buffer_size - 1)) && (c != '\r') && (c != '\n')) {
+                line_size++;
+                end_offset = (end_offset+1)&(_size-1);
+                c = _data[end_offset];
+            }
+            if (line_size < (_line_buffer_size - 1)) {
+                end_offset = (end_offset+1)&(_size-1);    // the line ending is read with the line
             }
-
-            line_size++;
-            *dst_ptr = c;
-
-            // update read/write positions
-            dst_ptr++;
-
-            c = _data[_read_offset];
-        }
-        if (line_size == (_line_buffer_size - 1)) {
-            // add a line-ending
-            *dst_ptr++ = '\n';
         }
 
+        _setView(line, _read_offset, line_size);
+        _held_end_offset = end_offset;
+        _line_held = true;
+
         --_lines_found;
 
-        _restartTransfer();
+        return line_size;
+    }; // readline_view
 
-        // null-terminate the string
-        *dst_ptr = 0;
+    char *line_string(const xioLineView &line) {
+        if (line.head != _line_buffer) {                // controls are already in _line_buffer
+            line.copy(_line_buffer, _line_buffer_size+1);
+        }
         return _line_buffer;
-    }; // readline
+    };
 
 
     // this is called from flushRead()
     void flush() {
+        _line_held = false;             // the held line goes with the rest of the data
         parent_type::flush();
         _scan_offset = _read_offset;
 
@@ -975,6 +1144,12 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
         // record that we have 0 lines (of data) in the buffer
         _lines_found = 0;
 
+#ifdef __BINARY_MOTION
+        // and drop any partially scanned binary frame
+        _frame_bytes_remaining = 0;
+        _frame_length_pending = false;
+#endif
+
         // and clear out any skip sections we have
         while (!_skip_sections.isEmpty()) {
             _skip_sections.popSkip();
@@ -1001,6 +1176,7 @@ struct LineRXBuffer : RXBuffer<_size, owner_type, char> {
         // flush to.
 
         // move the read buffer up to where we ended scanning
+        _line_held = false;
         _read_offset = _scan_offset;
 
         // record that we have 0 lines (of data) in the buffer
@@ -1083,13 +1259,15 @@ struct xioDeviceWrapper : xioDeviceWrapperBase {    // describes a device for re
         return _tx_buffer.write(buffer, len);
     }
 
-    virtual char *readline(devflags_t limit_flags, uint16_t &size) final {
+    virtual uint16_t readline_view(devflags_t limit_flags, xioLineView &line) final {
         if ((limit_flags & flags) && isConnected()) {
-            return _rx_buffer.readline(!(limit_flags & DEV_IS_DATA), size);
+            return _rx_buffer.readline_view(!(limit_flags & DEV_IS_DATA), line);
         }
+        return 0;
+    };
 
-        size = 0;
-        return NULL;
+    virtual char *line_string(const xioLineView &line) final {
+        return _rx_buffer.line_string(line);
     };
 
     void connectedStateChanged(bool connected) {
@@ -1256,37 +1434,119 @@ struct xioFlashFileDeviceWrapper : xioDeviceWrapperBase {    // describes a devi
         return -1;
     }
 
-    char *readline(devflags_t limit_flags, uint16_t &line_size) final {
+    uint16_t readline_view(devflags_t limit_flags, xioLineView &line) final {
         if (nullptr == _current_file) {
-            line_size = 0;
-            return nullptr;
+            return 0;
         }
 
+        uint16_t line_size;
         const char *from = _current_file->readline(!(limit_flags & DEV_IS_DATA), line_size);
-        if ((nullptr == from) && (_current_file->isDone())) {
-            // all done sending this file, "close" it
-            _current_file = nullptr;
-            cs.responses_suppressed = false;
-            clearActive();
-            return nullptr;
+        if (nullptr == from) {
+            if (_current_file->isDone()) {
+                // all done sending this file, "close" it
+                _current_file = nullptr;
+                cs.responses_suppressed = false;
+                clearActive();
+            }
+            return 0;
         }
-        char *dst_ptr = _line_buffer;
 
-        uint16_t count = std::min(line_size, uint16_t(_line_buffer_size - 2));
+        // the line is read in place from the file in flash
+        line.head = from;
+        line.head_len = std::min(line_size, uint16_t(_line_buffer_size - 2));
+        line.tail = nullptr;
+        line.tail_len = 0;
+
+        cs.responses_suppressed = true;
+        return line.head_len;
+    };
+
+    char *line_string(const xioLineView &line) final {
+        line.copy(_line_buffer, _line_buffer_size);
+        return _line_buffer;
+    };
+};
+
+xioFlashFileDeviceWrapper<> flashFileWrapper {};
+
+// Wrapper for a xio_line_source - like the flash file wrapper, but lines may be binary
+// motion frames, so they are copied by size and never scanned for terminators here
+template<uint16_t _line_buffer_size = RX_BUFFER_SIZE>
+struct xioLineSourceDeviceWrapper : xioDeviceWrapperBase {
+    xio_line_source *_current_source = nullptr;
+
+    char _line_buffer[_line_buffer_size];
+
+    xioLineSourceDeviceWrapper() : xioDeviceWrapperBase(DEV_CAN_READ | DEV_IS_ALWAYS_BOTH)
+    {
+    };
+
+    bool sendSource(xio_line_source &new_source) {
+        if (nullptr != _current_source) {
+            return false; // we're still sending a source
+        }
+        _current_source = &new_source;
+        setActive();
+        return true;
+    }
+
+    void _endSource() {
+        if (nullptr != _current_source) {
+            _current_source->close();
+            _current_source = nullptr;
+        }
+        cs.responses_suppressed = false;
+        clearActive();
+    }
+
+    void flush() final {
+        // nothing to do
+    }
+
+    void flushRead() final {
+        _endSource();
+    }
+
+    bool flushToCommand() final {
+        _endSource();
+        return false;
+    }
+
+    int16_t write(const char *buffer, int16_t len) final {
+        return -1;
+    }
+
+    uint16_t readline_view(devflags_t limit_flags, xioLineView &line) final {
+        if (nullptr == _current_source) {
+            return 0;
+        }
 
-        while (count--) {
-            *dst_ptr++ = *from++;
+        uint16_t line_size;
+        const char *from = _current_source->readline(!(limit_flags & DEV_IS_DATA), line_size);
+        if (nullptr == from) {
+            if (_current_source->isDone()) {
+                _endSource();
+            }
+            return 0;
         }
 
-        // null-terminate the string
-        *dst_ptr = 0;
+        // the line is read in place from the source, which keeps it until the next call
+        line.head = from;
+        line.head_len = std::min(line_size, uint16_t(_line_buffer_size - 1));
+        line.tail = nullptr;
+        line.tail_len = 0;
 
         cs.responses_suppressed = true;
+        return line.head_len;
+    };
+
+    char *line_string(const xioLineView &line) final {
+        line.copy(_line_buffer, _line_buffer_size);   // null-terminate text lines
         return _line_buffer;
     };
 };
 
-xioFlashFileDeviceWrapper<> flashFileWrapper {};
+xioLineSourceDeviceWrapper<> lineSourceWrapper {};
 
 // ALLOCATIONS
 // Declare a device wrapper class for SerialUSB and SerialUSB1
@@ -1318,6 +1578,7 @@ xioDeviceWrapper<decltype(&Serial)> serial0Wrapper HOT_DATA {
 //xio_t xio = { &serialUSB0Wrapper, &serialUSB1Wrapper };
 xio_t xio = {
     &flashFileWrapper,
+    &lineSourceWrapper,
 #if XIO_HAS_USB == 1
     &serialUSB0Wrapper,
 #if USB_SERIAL_PORTS_EXPOSED == 2
@@ -1373,12 +1634,43 @@ stat_t xio_test_assertions()
 
 size_t xio_write(const char *buffer, size_t size, bool only_to_muted /*= false*/)
 {
+    xio.finish_partial_line();
     return xio.write(buffer, size, only_to_muted);
 }
 
 /*
- * xio_readline() - read a complete line from a device
- * xio_writeline() - write a complete line to control device
+ * xio_write_some()       - write what the TX buffer will take now. Returns the count taken
+ * xio_set_partial_line() - register a function that completes a part-written line
+ *
+ *  A writer that streams a line with xio_write_some() registers a finish function while
+ *  the line is incomplete. Any other write first calls it (once) so lines never interleave.
+ *  Pass nullptr to clear it when the line is complete.
+ */
+
+size_t xio_write_some(const char *buffer, size_t size, bool only_to_muted /*= false*/)
+{
+    return xio.write_some(buffer, size, only_to_muted);
+}
+
+void xio_set_partial_line(void (*finish)(void))
+{
+    xio._partial_line_finish = finish;
+}
+
+/*
+ * xio_write_secondary() - write what the secondary (data-only) channel will take now
+ */
+
+size_t xio_write_secondary(const char *buffer, size_t size)
+{
+    return xio.write_secondary(buffer, size);
+}
+
+/*
+ * xio_readline()      - read a complete line from a device
+ * xio_readline_view() - read a complete line from a device in place (see xioLineView)
+ * xio_line_string()   - get the line from xio_readline_view() as a NUL-terminated string
+ * xio_writeline()     - write a complete line to control device
  *
  *  Defers to xio.readline(), etc.
  */
@@ -1388,8 +1680,19 @@ char *xio_readline(devflags_t &flags, uint16_t &size)
     return xio.readline(flags, size);
 }
 
+uint16_t xio_readline_view(devflags_t &flags, xioLineView &line)
+{
+    return xio.readline_view(flags, line);
+}
+
+char *xio_line_string(const xioLineView &line)
+{
+    return xio.line_string(line);
+}
+
 int16_t xio_writeline(const char *buffer, bool only_to_muted /*= false*/)
 {
+    xio.finish_partial_line();
     return xio.writeline(buffer, only_to_muted);
 }
 
@@ -1410,6 +1713,14 @@ bool xio_send_file(xio_flash_file &file) {
     return flashFileWrapper.sendFile(file);
 }
 
+/*
+ * xio_send_source() - send the lines of a xio_line_source - returns false if there's already one sending
+ */
+
+bool xio_send_source(xio_line_source &source) {
+    return lineSourceWrapper.sendSource(source);
+}
+
 /*
  * xio_flush_to_command() - clear the last read channel up until the command that was read
  */
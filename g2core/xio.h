@@ -98,6 +98,7 @@ enum xioDeviceEnum {                        // reconfigure this enum as you add
     DEV_UART1,                              // must be 2
 //  DEV_SPI0,                               // We can't have it here until we actually define it
     DEV_FLASH_FILE,                         // must be 0
+    DEV_LINE_SOURCE,                        // a xio_line_source, e.g. an SD card job file
     DEV_MAX
 };
 
@@ -111,13 +112,45 @@ enum xioSPIMode {
 
 #define RX_BUFFER_SIZE       512            // maximum length of recieved lines from xio_readline
 
+/**** xioLineView - a line read in place from a device buffer ****/
+//
+// A line returned by xio_readline_view() is not copied or NUL terminated. It stays where
+// the device received it - usually the RX DMA ring - so it may wrap around the end of the
+// ring, in which case the rest of it is in tail. It is valid until the next readline call.
+
+struct xioLineView {
+    const char *head;                       // the line, or its first part if it wraps
+    uint16_t head_len;
+    const char *tail;                       // the part of a wrapped line at the start of the ring
+    uint16_t tail_len;                      // 0 if the line does not wrap
+
+    uint16_t size() const { return (head_len + tail_len); };
+
+    char operator[](const uint16_t i) const { return ((i < head_len) ? head[i] : tail[i - head_len]); };
+
+    // copy at most dst_size-1 chars of the line to dst and NUL terminate it. Returns the count.
+    uint16_t copy(char *dst, const uint16_t dst_size) const {
+        uint16_t count = (size() < dst_size) ? size() : (dst_size - 1);
+        uint16_t from_head = (count < head_len) ? count : head_len;
+        memcpy(dst, head, from_head);
+        memcpy(dst + from_head, tail, count - from_head);
+        dst[count] = 0;
+        return (count);
+    };
+};
+
 /**** function prototypes ****/
 
 void xio_init(void);
 stat_t xio_test_assertions(void);
 
 size_t xio_write(const char *buffer, size_t size, bool only_to_muted = false);
+size_t xio_write_some(const char *buffer, size_t size, bool only_to_muted = false);
+void xio_set_partial_line(void (*finish)(void));
+size_t xio_write_secondary(const char *buffer, size_t size);
 char *xio_readline(devflags_t &flags, uint16_t &size);
+uint16_t xio_readline_view(devflags_t &flags, xioLineView &line);
+char *xio_line_string(const xioLineView &line);
 int16_t xio_writeline(const char *buffer, bool only_to_muted = false);
 bool xio_connected();
 void xio_flush_to_command();
@@ -225,9 +258,22 @@ constexpr xio_flash_file make_xio_flash_file(const char (&data)[length]) {
     return {data, length};
 }
 
+/**** xio_line_source - a file read a line at a time, e.g. from an SD card ****/
+//
+// readline() returns the next line (or binary motion frame) and its size, or nullptr
+// if nothing is ready yet. The line must stay valid until the next call. isDone() is
+// true once the source has nothing more to send. Read errors end the source.
+
+struct xio_line_source {
+    virtual const char *readline(bool control_only, uint16_t &line_size) { line_size = 0; return nullptr; };
+    virtual bool isDone() { return true; };
+    virtual void close() {};                // stop sending - called on flush or when done
+};
+
 /**** function prototype for file-sending ****/
 
 bool xio_send_file(xio_flash_file &file);
+bool xio_send_source(xio_line_source &source);
 
 #ifdef __TEXT_MODE
 